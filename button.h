@@ -18,27 +18,19 @@ public:
 		m_width {width},
 		m_height {height}
 	{}
-	virtual ~Button() {}
 
-	virtual float getHeight() const { return m_height; }
-	virtual float getWidth() const { return m_width; }
+	float getHeight() const { return m_height; }
+	float getWidth() const { return m_width; }
 
 
-	virtual bool contains(float x, float y) const override { return rectangularContains(m_pos_x, m_pos_y, m_width, m_height, x, y); }
+	bool contains(float x, float y) const { return rectangularContains(m_pos_x, m_pos_y, m_width, m_height, x, y); }
 
 	// Same case for all the buttons:
-	// Update plays the sound of the click of a button; if we click on a button, we make m_clicked the opposite of what it used to be.
-	virtual void update() override {
-		graphics::MouseState mouse;
-		graphics::getMouseState(mouse);
-		float mouse_x{ graphics::windowToCanvasX(static_cast<float>(mouse.cur_pos_x)) };
-		float mouse_y{ graphics::windowToCanvasY(static_cast<float>(mouse.cur_pos_y)) };
-
-		m_highlighted = contains(mouse_x, mouse_y);
-
-		if (m_highlighted && mouse.button_left_pressed) {
+	// Clicking plays the sound of the click of a button, and makes m_clicked the opposite of what it used to be.
+	void onEvent(const InputEvent& event) {
+		if (event.type == InputEventType::CLICK) {
 			graphics::playSound(static_cast<std::string>(ASSET_PATH) + "button.wav", 1.0f);
 			m_clicked = !m_clicked;
 		}
 	}
-};
\ No newline at end of file
+};
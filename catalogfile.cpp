@@ -0,0 +1,152 @@
+#include "catalogfile.h"
+#include "film.h"
+#include "profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+	bool toYear(const std::string& token, unsigned int& year)
+	{
+		char* end{ nullptr };
+		year = static_cast<unsigned int>(std::strtoul(token.c_str(), &end, 10));
+		return !token.empty() && *end == '\0';
+	}
+
+	bool toGenre(const std::string& token, Genre& genre)
+	{
+		for (const Genre candidate : genresToArray()) {
+			std::string name{ genreName(candidate) };
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+			if (name == token) {
+				genre = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool toRole(const std::string& token, Role& role)
+	{
+		if (token == "lead")				role = Role::lead;
+		else if (token == "supporting")		role = Role::supporting;
+		else if (token == "extra")			role = Role::extra;
+		else return false;
+		return true;
+	}
+}
+
+bool loadCatalogFile(const std::string& path, std::vector<FilmRecord>& records)
+{
+	PROFILE_SCOPE("loadCatalogFile");
+	records.clear();
+	std::ifstream file{ path };
+	if (!file) {
+		std::cerr << "loadCatalogFile: could not open the catalog file " << path << '\n';
+		return false;
+	}
+
+	std::unordered_set<std::string> titles;
+	bool skipping{ false };				// while going through the details of a film that was left out
+	std::string line;
+	for (unsigned int lineNumber{ 1 }; std::getline(file, line); ++lineNumber) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		std::vector<std::string> tokens{ tokenize(line) };
+		if (tokens.empty()) {
+			continue;
+		}
+
+		const std::string& key{ tokens[0] };
+		bool valid{ true };
+		if (key == "film") {
+			// a film we can't make out (an unquoted title, say) is left out along with its details, which would otherwise
+			// end up on the film before it
+			if (tokens.size() != 2) {
+				std::cerr << "loadCatalogFile: " << path << ':' << lineNumber << ": could not make sense of \"" << line << "\"\n";
+				skipping = true;
+				continue;
+			}
+			skipping = !titles.insert(tokens[1]).second;
+			if (skipping) {
+				std::cerr << "loadCatalogFile: " << path << ':' << lineNumber << ": there is already a film called \"" << tokens[1] << "\"\n";
+			}
+			else {
+				records.emplace_back();
+				records.back().title = tokens[1];
+			}
+			continue;
+		}
+		else if (skipping) {
+			continue;
+		}
+		else if (records.empty()) {
+			valid = false;
+		}
+		else if (key == "year" && tokens.size() == 2) {
+			valid = toYear(tokens[1], records.back().releaseYear);
+		}
+		else if (key == "director" && tokens.size() == 2) {
+			records.back().director = tokens[1];
+		}
+		else if (key == "genres") {
+			for (size_t token{ 1 }; valid && token < tokens.size(); ++token) {
+				Genre genre;
+				if ((valid = toGenre(tokens[token], genre))) {
+					records.back().genres.insert(genre);
+				}
+			}
+		}
+		else if (key == "cast" && (tokens.size() == 2 || tokens.size() == 3)) {
+			Role role{ Role::supporting };
+			if ((valid = tokens.size() == 2 || toRole(tokens[2], role))) {
+				records.back().details.cast.push_back({ tokens[1], role });
+			}
+		}
+		else if (key == "poster" && tokens.size() == 2) {
+			records.back().details.poster = tokens[1];
+		}
+		else if (key == "description") {
+			// the rest of the line, as it is (quotes, #s and all)
+			const size_t start{ line.find_first_not_of(" \t", line.find("description") + 11) };
+			records.back().details.description = start == std::string::npos ? std::string{} : line.substr(start);
+		}
+		else {
+			valid = false;
+		}
+
+		if (!valid) {
+			std::cerr << "loadCatalogFile: " << path << ':' << lineNumber << ": could not make sense of \"" << line << "\"\n";
+		}
+	}
+	return true;
+}
+
+bool sameFilm(const Film& film, const FilmRecord& record)
+{
+	// the details are compared by their hashes, so that the film's don't have to be read for it
+	return film.getTitle() == record.title && film.getReleaseYear() == record.releaseYear && film.getDirector() == record.director &&
+		film.getGenres() == record.genres && film.getDetailsHash() == ColdSegment::hash(record.details);
+}
+
+std::vector<std::shared_ptr<Film>> makeFilms(std::span<const FilmRecord> records)
+{
+	PROFILE_SCOPE("makeFilms");
+	std::vector<FilmDetails> details;
+	details.reserve(records.size());
+	for (const FilmRecord& record : records) {
+		details.push_back(record.details);
+	}
+	std::vector<ColdRecord> cold{ ColdSegment::write(details) };
+
+	std::vector<std::shared_ptr<Film>> films;
+	films.reserve(records.size());
+	for (size_t i{ 0 }; i < records.size(); ++i) {
+		films.push_back(std::make_shared<Film>(records[i].title, records[i].releaseYear, records[i].director, records[i].genres,
+			std::move(cold[i])));
+	}
+	return films;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "filmutil.h"
+#include "coldsegment.h"
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <memory>
+#include <span>
+
+/* The catalog file (CATALOG_FILE in the assets): every film of the browser, as text, so that changing the films doesn't
+ * mean changing the code. See the top of the file for its format. FilmUI reads it on startup, and again whenever the
+ * CatalogWatcher sees it change, to work out which films were added, changed or removed. */
+
+// FilmRecord: One film of the catalog file, before there is a Film made from it
+struct FilmRecord {
+	std::string title;
+	unsigned int releaseYear{ 0 };
+	std::string director;
+	std::unordered_set<Genre> genres;
+	FilmDetails details;
+};
+
+/* Reads the films of a catalog file into records, in the order they are in the file. A second film with the title of
+ * an earlier one is left out, since films are told apart by their titles. Lines it can't make sense of are reported on
+ * std::cerr and skipped; returns false (leaving records empty) only if the file can't be read at all. */
+bool loadCatalogFile(const std::string& path, std::vector<FilmRecord>& records);
+
+// Whether a film is exactly what a record says it is, down to its description and poster
+bool sameFilm(const class Film& film, const FilmRecord& record);
+
+// New films made from records (in the same order), their details written to a ColdSegment of their own
+std::vector<std::shared_ptr<class Film>> makeFilms(std::span<const FilmRecord> records);
@@ -0,0 +1,116 @@
+#include "catalogstore.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+CatalogPin::~CatalogPin()
+{
+	m_slot->store(0);
+}
+
+CatalogRef::CatalogRef(CatalogVersion* version) :
+	m_version{ version }
+{
+	if (m_version) {
+		++m_version->references;
+	}
+}
+
+CatalogRef::~CatalogRef()
+{
+	if (m_version) {
+		--m_version->references;
+	}
+}
+
+CatalogRef::CatalogRef(const CatalogRef& other) :
+	CatalogRef{ other.m_version }
+{
+}
+
+CatalogRef::CatalogRef(CatalogRef&& other) noexcept :
+	m_version{ std::exchange(other.m_version, nullptr) }
+{
+}
+
+CatalogRef& CatalogRef::operator=(CatalogRef other) noexcept
+{
+	std::swap(m_version, other.m_version);
+	return *this;
+}
+
+CatalogStore::~CatalogStore()
+{
+	// every reader is gone by now: whatever is left goes, retired or not
+	delete m_current.exchange(nullptr);
+	m_retired.clear();
+}
+
+CatalogPin CatalogStore::pin() const
+{
+	/* announcing the epoch before looking at m_current: a version retired at this epoch or later can't be freed until
+	 * the pin goes, and one retired before it had already been swapped out, so m_current can't be it */
+	while (true) {
+		for (std::atomic<unsigned long long>& slot : m_readers) {
+			unsigned long long free{ 0 };
+			if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(free, m_epoch.load())) {
+				return { &slot, m_current.load() };
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+CatalogRef CatalogStore::acquire() const
+{
+	const CatalogPin pinned{ pin() };
+	return CatalogRef{ pinned.m_version };
+}
+
+void CatalogStore::publish(FilmCatalog&& catalog)
+{
+	PROFILE_SCOPE("CatalogStore::publish");
+	std::unique_ptr<CatalogVersion> version{ std::make_unique<CatalogVersion>() };
+	version->catalog = std::move(catalog);
+	const unsigned long long number{ version->catalog.getVersion() };
+
+	std::lock_guard<std::mutex> lock{ m_writer };
+	CatalogVersion* previous{ m_current.exchange(version.release()) };
+	m_version = number;
+	if (previous) {
+		// readers pinned from now on can only find the new version
+		previous->retiredAt = m_epoch++;
+		m_retired.emplace_back(previous);
+	}
+	reclaimRetired();
+}
+
+void CatalogStore::reclaim()
+{
+	std::unique_lock<std::mutex> lock{ m_writer, std::try_to_lock };
+	if (lock.owns_lock() && !m_retired.empty()) {
+		reclaimRetired();
+	}
+}
+
+void CatalogStore::reclaimRetired()
+{
+	unsigned long long oldest{ ~0ull };
+	for (const std::atomic<unsigned long long>& slot : m_readers) {
+		const unsigned long long epoch{ slot.load() };
+		if (epoch != 0) {
+			oldest = std::min(oldest, epoch);
+		}
+	}
+	std::erase_if(m_retired, [oldest](const std::unique_ptr<CatalogVersion>& version) {
+		return version->retiredAt < oldest && version->references.load() == 0;
+	});
+}
+
+size_t CatalogStore::retiredCount()
+{
+	std::lock_guard<std::mutex> lock{ m_writer };
+	return m_retired.size();
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "filmcatalog.h"
+#include "global.h"
+
+#include <atomic>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* CatalogStore: Where the current version of the catalog is published, for every thread that reads it (the UI thread,
+ * the search worker, the reloads building the next version). A published FilmCatalog never changes again: a reload builds
+ * a whole new one from it (see FilmCatalog::update()) and publishes that with one atomic swap, so a reader sees either the
+ * old version or the new one, and never waits for the other.
+ *
+ * Reading takes no locks. A reader pins the store (CatalogPin) for as long as it reads a version, which announces the
+ * store's current epoch in one of CATALOG_READER_SLOTS slots; whoever needs a version for longer than that (the films on
+ * screen, a search that runs for a while) takes a reference to it (CatalogRef), which is counted. Publishing retires the
+ * old version at the current epoch and moves the epoch on. A retired version is only freed (by reclaim()) once nobody is
+ * pinned at its epoch or before, who might still be about to take a reference to it, and nobody holds one any more. The
+ * films themselves are shared between the versions that have them, and go with the last of those.
+ *
+ * Only publishing and reclaiming take a lock, which only writers and reclaim() contend for; reclaim() skips a round rather
+ * than waiting for it. */
+
+class CatalogStore;
+
+// CatalogVersion: A published catalog, along with how many references it has and when it was retired
+struct CatalogVersion {
+	FilmCatalog catalog;
+	std::atomic<unsigned int> references{ 0 };
+	unsigned long long retiredAt{ 0 };
+};
+
+// CatalogPin: Keeps the version it was pinned at, and every version retired after it, from being freed while it lasts
+class CatalogPin {
+private:
+	std::atomic<unsigned long long>* m_slot{ nullptr };
+	CatalogVersion* m_version{ nullptr };
+
+	friend class CatalogStore;
+	CatalogPin(std::atomic<unsigned long long>* slot, CatalogVersion* version) : m_slot{ slot }, m_version{ version } {}
+
+public:
+	~CatalogPin();
+
+	CatalogPin(const CatalogPin&) = delete;
+	CatalogPin& operator=(const CatalogPin&) = delete;
+
+	const FilmCatalog* operator->() const					{ return &m_version->catalog; }
+	const FilmCatalog& operator*() const					{ return m_version->catalog; }
+	explicit operator bool() const							{ return m_version != nullptr; }
+};
+
+// CatalogRef: A counted reference to one version of the catalog, which keeps it (and its films) alive however long it is held
+class CatalogRef {
+private:
+	CatalogVersion* m_version{ nullptr };
+
+	friend class CatalogStore;
+	explicit CatalogRef(CatalogVersion* version);
+
+public:
+	CatalogRef() = default;
+	~CatalogRef();
+
+	CatalogRef(const CatalogRef& other);
+	CatalogRef(CatalogRef&& other) noexcept;
+	CatalogRef& operator=(CatalogRef other) noexcept;
+
+	const FilmCatalog* operator->() const					{ return &m_version->catalog; }
+	const FilmCatalog& operator*() const					{ return m_version->catalog; }
+	explicit operator bool() const							{ return m_version != nullptr; }
+};
+
+class CatalogStore {
+private:
+	std::atomic<CatalogVersion*> m_current{ nullptr };
+	std::atomic<unsigned long long> m_version{ 0 };			// the current version's FilmCatalog::getVersion()
+
+	// m_epoch: Moves on with every version published. m_readers: the epoch each pinned reader pinned at, 0 for free slots.
+	std::atomic<unsigned long long> m_epoch{ 1 };
+	mutable std::array<std::atomic<unsigned long long>, CATALOG_READER_SLOTS> m_readers{};
+
+	// m_writer: Guards m_retired, and makes publishing one writer at a time
+	std::mutex m_writer;
+	std::vector<std::unique_ptr<CatalogVersion>> m_retired;
+
+	// frees the retired versions nobody can see any more (m_writer held)
+	void reclaimRetired();
+
+public:
+	CatalogStore() = default;
+	~CatalogStore();
+
+	CatalogStore(const CatalogStore&) = delete;
+	CatalogStore& operator=(const CatalogStore&) = delete;
+
+	// The current version, for as long as the pin lasts. Lock-free; spins only if every reader slot is taken.
+	CatalogPin pin() const;
+
+	// A reference to the current version (empty if nothing has been published yet)
+	CatalogRef acquire() const;
+
+	// Makes the catalog the current version, retiring the one before it
+	void publish(FilmCatalog&& catalog);
+
+	// Frees whatever retired versions can be freed. Cheap when there are none; skipped if a writer is publishing.
+	void reclaim();
+
+	// The version of the current catalog, without pinning it
+	unsigned long long getVersion() const					{ return m_version.load(); }
+
+	// How many retired versions are still waiting to be freed
+	size_t retiredCount();
+};
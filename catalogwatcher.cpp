@@ -0,0 +1,109 @@
+#include "catalogwatcher.h"
+#include "profiler.h"
+
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+CatalogWatcher::~CatalogWatcher()
+{
+	stop();
+}
+
+bool CatalogWatcher::start(const std::string& path)
+{
+	stop();
+	m_path = path;
+	const std::filesystem::path file{ path };
+	m_fileName = file.filename().string();
+	m_modified = modificationTime();
+#ifdef __linux__
+	m_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_descriptor < 0) {
+		std::cerr << "CatalogWatcher: could not start inotify, " << path << " will not be reloaded\n";
+		return false;
+	}
+	const std::string folder{ file.has_parent_path() ? file.parent_path().string() : "." };
+	if (inotify_add_watch(m_descriptor, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		std::cerr << "CatalogWatcher: could not watch " << folder << ", " << path << " will not be reloaded\n";
+		stop();
+		return false;
+	}
+#endif
+	return true;
+}
+
+void CatalogWatcher::stop()
+{
+#ifdef __linux__
+	if (m_descriptor >= 0) {
+		close(m_descriptor);
+	}
+#endif
+	m_descriptor = -1;
+	m_pending = -1.0f;
+}
+
+long long CatalogWatcher::modificationTime() const
+{
+	std::error_code error;
+	const std::filesystem::file_time_type time{ std::filesystem::last_write_time(m_path, error) };
+	return error ? 0 : static_cast<long long>(time.time_since_epoch().count());
+}
+
+bool CatalogWatcher::changedOnDisk()
+{
+#ifdef __linux__
+	if (m_descriptor < 0) {
+		return false;
+	}
+	// every event of the folder since the last frame, of which only the ones naming our file count
+	bool changed{ false };
+	alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+	ssize_t length;
+	while ((length = read(m_descriptor, buffer, sizeof(buffer))) > 0) {
+		for (ssize_t offset{ 0 }; offset < length;) {
+			const inotify_event* event{ reinterpret_cast<const inotify_event*>(buffer + offset) };
+			if (event->len && m_fileName == event->name) {
+				changed = true;
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+	return changed;
+#else
+	if (m_sincePoll < CATALOG_POLL_INTERVAL) {
+		return false;
+	}
+	m_sincePoll = 0.0f;
+	const long long modified{ modificationTime() };
+	if (modified == m_modified) {
+		return false;
+	}
+	m_modified = modified;
+	return true;
+#endif
+}
+
+bool CatalogWatcher::poll(float elapsed)
+{
+	PROFILE_SCOPE("CatalogWatcher::poll");
+	m_sincePoll += elapsed;
+	if (changedOnDisk()) {
+		m_pending = 0.0f;
+	}
+	else if (m_pending >= 0.0f) {
+		m_pending += elapsed;
+	}
+	if (m_pending < CATALOG_RELOAD_DELAY) {
+		return false;
+	}
+	m_pending = -1.0f;
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "global.h"
+
+#include <string>
+
+/* CatalogWatcher: Tells FilmUI when the catalog file has been changed on disk, so that the films can be reloaded while
+ * the browser runs. It is polled once per frame on the UI thread, and never blocks it.
+ *
+ * On Linux it asks inotify about the assets folder (the file itself is usually replaced rather than written over by
+ * editors, which would drop a watch on the file), so a poll is one non-blocking read. Elsewhere it falls back to
+ * comparing the file's modification time every CATALOG_POLL_INTERVAL ms.
+ *
+ * Editors tend to save in several steps, so a change is only reported once the file has been quiet for
+ * CATALOG_RELOAD_DELAY ms; a save that comes in the middle of that starts the wait over. */
+
+class CatalogWatcher {
+private:
+	std::string m_path;
+	std::string m_fileName;
+	int m_descriptor{ -1 };						// the inotify instance (Linux only)
+	long long m_modified{ 0 };					// the file's modification time, when it was last looked at (elsewhere)
+	float m_sincePoll{ 0.0f };
+	float m_pending{ -1.0f };					// ms since the last change that hasn't been reported yet, or -1 if there is none
+
+	bool changedOnDisk();
+	long long modificationTime() const;
+
+public:
+	CatalogWatcher() = default;
+	~CatalogWatcher();
+
+	CatalogWatcher(const CatalogWatcher&) = delete;
+	CatalogWatcher& operator=(const CatalogWatcher&) = delete;
+
+	// Starts watching the file. Returns false (and the watcher stays quiet) if it can't be watched.
+	bool start(const std::string& path);
+
+	void stop();
+
+	// Whether the file has changed, and settled, since the last time this returned true. elapsed is the frame's time in ms.
+	bool poll(float elapsed);
+};
@@ -0,0 +1,61 @@
+#include "clipboard.h"
+
+#include <string>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+std::string getClipboardText()
+{
+	std::string text;
+	if (!OpenClipboard(nullptr)) {
+		return text;
+	}
+	if (HANDLE data{ GetClipboardData(CF_TEXT) }) {
+		if (const char* contents{ static_cast<const char*>(GlobalLock(data)) }) {
+			text = contents;
+			GlobalUnlock(data);
+		}
+	}
+	CloseClipboard();
+	return text;
+}
+
+void setClipboardText(const std::string& text)
+{
+	if (!OpenClipboard(nullptr)) {
+		return;
+	}
+	EmptyClipboard();
+
+	// the clipboard takes ownership of the memory once SetClipboardData succeeds
+	if (HGLOBAL memory{ GlobalAlloc(GMEM_MOVEABLE, text.size() + 1) }) {
+		std::memcpy(GlobalLock(memory), text.c_str(), text.size() + 1);
+		GlobalUnlock(memory);
+		if (!SetClipboardData(CF_TEXT, memory)) {
+			GlobalFree(memory);
+		}
+	}
+	CloseClipboard();
+}
+
+#else
+
+namespace {
+	std::string s_clipboard;
+}
+
+std::string getClipboardText()
+{
+	return s_clipboard;
+}
+
+void setClipboardText(const std::string& text)
+{
+	s_clipboard = text;
+}
+
+#endif
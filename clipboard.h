@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+/* clipboard.h: Copy and paste for our textfields. On Windows, these go through the system clipboard, so that text can be
+ * pasted in from (and copied out to) other applications. Everywhere else there is no clipboard SGG could give us, so the
+ * textfields share a clipboard of their own instead. */
+
+// Returns the text currently on the clipboard, or an empty string if there is none
+std::string getClipboardText();
+
+// Puts the text on the clipboard
+void setClipboardText(const std::string& text);
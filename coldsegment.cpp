@@ -0,0 +1,321 @@
+#include "coldsegment.h"
+#include "profiler.h"
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdlib>
+#define COLD_SEGMENT_MMAP
+#endif
+
+namespace {
+	// FNV-1a, like the thumbnail cache's content hash
+	std::uint64_t fnv1a(std::span<const unsigned char> bytes)
+	{
+		std::uint64_t hash{ 14695981039346656037ull };
+		for (const unsigned char byte : bytes) {
+			hash ^= byte;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void putVarint(std::vector<unsigned char>& out, size_t value)
+	{
+		while (value >= 0x80) {
+			out.push_back(static_cast<unsigned char>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	bool getVarint(const unsigned char*& in, const unsigned char* end, size_t& value)
+	{
+		value = 0;
+		for (unsigned int shift{ 0 }; in < end && shift < 64; shift += 7) {
+			const unsigned char byte{ *in++ };
+			value |= static_cast<size_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void putString(std::vector<unsigned char>& out, const std::string& text)
+	{
+		putVarint(out, text.size());
+		out.insert(out.end(), text.begin(), text.end());
+	}
+
+	bool getString(const unsigned char*& in, const unsigned char* end, std::string& text)
+	{
+		size_t length;
+		if (!getVarint(in, end, length) || length > static_cast<size_t>(end - in)) {
+			return false;
+		}
+		text.assign(reinterpret_cast<const char*>(in), length);
+		in += length;
+		return true;
+	}
+
+	// the details as the bytes of a record, before any compression
+	void encode(const FilmDetails& details, std::vector<unsigned char>& out)
+	{
+		putString(out, details.poster);
+		putString(out, details.description);
+		putVarint(out, details.cast.size());
+		for (const CastMember& member : details.cast) {
+			out.push_back(static_cast<unsigned char>(member.role));
+			putString(out, member.name);
+		}
+	}
+
+	bool decode(const unsigned char* in, const unsigned char* end, FilmDetails& details)
+	{
+		size_t members;
+		if (!getString(in, end, details.poster) || !getString(in, end, details.description) || !getVarint(in, end, members)) {
+			return false;
+		}
+		details.cast.resize(std::min(members, static_cast<size_t>(end - in)));
+		for (CastMember& member : details.cast) {
+			if (in == end) {
+				return false;
+			}
+			member.role = static_cast<Role>(*in++);
+			if (!getString(in, end, member.name)) {
+				return false;
+			}
+		}
+		return details.cast.size() == members;
+	}
+
+	/* LZ77, in the format of an LZ4 block: a run of sequences, each a token (the number of literals in its high four bits,
+	 * the length of the match less 4 in its low four, 15 meaning more follow in bytes of up to 255), the literals, and
+	 * the match as a two byte offset back into what has been written. The last sequence is only literals. Matches are
+	 * found through a table of where the last 4 bytes with each hash were seen, which is all it takes for text. */
+	constexpr size_t c_minMatch{ 4 };
+
+	void putLength(std::vector<unsigned char>& out, size_t length)
+	{
+		for (; length >= 255; length -= 255) {
+			out.push_back(255);
+		}
+		out.push_back(static_cast<unsigned char>(length));
+	}
+
+	void putSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		const size_t extra{ matchLength ? matchLength - c_minMatch : 0 };
+		out.push_back(static_cast<unsigned char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(extra, 15)));
+		if (literalCount >= 15) {
+			putLength(out, literalCount - 15);
+		}
+		out.insert(out.end(), literals, literals + literalCount);
+		if (matchLength) {
+			out.push_back(static_cast<unsigned char>(offset));
+			out.push_back(static_cast<unsigned char>(offset >> 8));
+			if (extra >= 15) {
+				putLength(out, extra - 15);
+			}
+		}
+	}
+
+	void compress(std::span<const unsigned char> in, std::vector<unsigned char>& out)
+	{
+		std::array<std::uint32_t, 4096> seen;
+		seen.fill(~0u);
+		auto read32{ [&in](size_t at) { std::uint32_t value; std::memcpy(&value, in.data() + at, 4); return value; } };
+
+		size_t anchor{ 0 };
+		for (size_t position{ 0 }; position + c_minMatch <= in.size();) {
+			const std::uint32_t sequence{ read32(position) };
+			std::uint32_t& slot{ seen[(sequence * 2654435761u) >> 20] };
+			const size_t candidate{ slot };
+			slot = static_cast<std::uint32_t>(position);
+			if (candidate == ~0u || position - candidate > 0xffff || read32(candidate) != sequence) {
+				++position;
+				continue;
+			}
+			size_t length{ c_minMatch };
+			while (position + length < in.size() && in[candidate + length] == in[position + length]) {
+				++length;
+			}
+			putSequence(out, in.data() + anchor, position - anchor, position - candidate, length);
+			position += length;
+			anchor = position;
+		}
+		putSequence(out, in.data() + anchor, in.size() - anchor, 0, 0);
+	}
+
+	bool getLength(const unsigned char*& in, const unsigned char* end, size_t& length)
+	{
+		unsigned char byte{ 255 };
+		while (byte == 255) {
+			if (in == end) {
+				return false;
+			}
+			byte = *in++;
+			length += byte;
+		}
+		return true;
+	}
+
+	bool decompress(const unsigned char* in, const unsigned char* end, std::vector<unsigned char>& out)
+	{
+		while (in < end) {
+			const unsigned char token{ *in++ };
+			size_t literals{ static_cast<size_t>(token >> 4) };
+			if (literals == 15 && !getLength(in, end, literals)) {
+				return false;
+			}
+			if (literals > static_cast<size_t>(end - in)) {
+				return false;
+			}
+			out.insert(out.end(), in, in + literals);
+			in += literals;
+			if (in == end) {
+				return true;
+			}
+
+			if (end - in < 2) {
+				return false;
+			}
+			const size_t offset{ static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8) };
+			in += 2;
+			size_t length{ static_cast<size_t>(token & 15) };
+			if (length == 15 && !getLength(in, end, length)) {
+				return false;
+			}
+			length += c_minMatch;
+			if (offset == 0 || offset > out.size()) {
+				return false;
+			}
+			// byte by byte, since a match may run on into the bytes it is copying
+			for (size_t from{ out.size() - offset }; length > 0; --length) {
+				out.push_back(out[from++]);
+			}
+		}
+		return true;
+	}
+}
+
+ColdSegment::~ColdSegment()
+{
+#ifdef COLD_SEGMENT_MMAP
+	if (m_mapped) {
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	}
+#endif
+}
+
+std::uint64_t ColdSegment::hash(const FilmDetails& details)
+{
+	std::vector<unsigned char> raw;
+	encode(details, raw);
+	return fnv1a(raw);
+}
+
+std::vector<ColdRecord> ColdSegment::write(std::span<const FilmDetails> details)
+{
+	PROFILE_SCOPE("ColdSegment::write");
+	std::shared_ptr<ColdSegment> segment{ std::make_shared<ColdSegment>() };
+	std::vector<ColdRecord> records(details.size());
+
+	// a record is a byte saying whether it is compressed, then (if it is) how long it was before, then the bytes
+	std::vector<unsigned char> bytes;
+	std::vector<unsigned char> raw;
+	std::vector<unsigned char> compressed;
+	for (size_t index{ 0 }; index < details.size(); ++index) {
+		raw.clear();
+		encode(details[index], raw);
+		records[index].offset = static_cast<std::uint32_t>(bytes.size());
+		records[index].hash = fnv1a(raw);
+
+		compressed.clear();
+		if (COLD_COMPRESS && raw.size() >= COLD_COMPRESS_MIN) {
+			compress(raw, compressed);
+		}
+		if (!compressed.empty() && compressed.size() < raw.size()) {
+			bytes.push_back(1);
+			putVarint(bytes, raw.size());
+			bytes.insert(bytes.end(), compressed.begin(), compressed.end());
+		}
+		else {
+			bytes.push_back(0);
+			bytes.insert(bytes.end(), raw.begin(), raw.end());
+		}
+		records[index].size = static_cast<std::uint32_t>(bytes.size() - records[index].offset);
+	}
+
+#ifdef COLD_SEGMENT_MMAP
+	/* into a file of its own, which is unlinked as soon as it is mapped: it goes away with the mapping, even if we
+	 * don't get to clean up after ourselves */
+	std::string path{ (std::filesystem::temp_directory_path() / "filmgui-cold-XXXXXX").string() };
+	const int file{ bytes.empty() ? -1 : mkstemp(path.data()) };
+	if (file >= 0) {
+		bool written{ true };
+		for (size_t done{ 0 }; written && done < bytes.size();) {
+			const ssize_t count{ ::write(file, bytes.data() + done, bytes.size() - done) };
+			written = count > 0;
+			done += written ? static_cast<size_t>(count) : 0;
+		}
+		void* data{ written ? mmap(nullptr, bytes.size(), PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED };
+		unlink(path.c_str());
+		close(file);
+		if (data != MAP_FAILED) {
+			// details are read a film at a time, wherever the film is: reading ahead would only page in films nobody looks at
+			madvise(data, bytes.size(), MADV_RANDOM);
+			segment->m_data = static_cast<const unsigned char*>(data);
+			segment->m_size = bytes.size();
+			segment->m_mapped = true;
+		}
+		else {
+			std::cerr << "ColdSegment: could not map " << path << ", keeping the film details in memory\n";
+		}
+	}
+#endif
+	if (!segment->m_mapped) {
+		segment->m_memory = std::move(bytes);
+		segment->m_data = segment->m_memory.data();
+		segment->m_size = segment->m_memory.size();
+	}
+
+	for (ColdRecord& record : records) {
+		record.segment = segment;
+	}
+	return records;
+}
+
+FilmDetails ColdSegment::read(const ColdRecord& record) const
+{
+	PROFILE_SCOPE("ColdSegment::read");
+	FilmDetails details;
+	if (record.size == 0 || static_cast<size_t>(record.offset) + record.size > m_size) {
+		return details;
+	}
+	const unsigned char* in{ m_data + record.offset };
+	const unsigned char* end{ in + record.size };
+	bool valid;
+	if (*in++ == 1) {
+		size_t rawSize;
+		std::vector<unsigned char> raw;
+		valid = getVarint(in, end, rawSize);
+		raw.reserve(valid ? rawSize : 0);
+		valid = valid && decompress(in, end, raw) && raw.size() == rawSize && decode(raw.data(), raw.data() + raw.size(), details);
+	}
+	else {
+		valid = decode(in, end, details);
+	}
+	if (!valid) {
+		std::cerr << "ColdSegment: the record at " << record.offset << " is damaged\n";
+		return {};
+	}
+	return details;
+}
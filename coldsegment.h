@@ -0,0 +1,66 @@
+#pragma once
+#include "filmutil.h"
+#include "global.h"
+
+#include <string>
+#include <vector>
+#include <span>
+#include <memory>
+#include <cstdint>
+
+/* The hot/cold split of the films: what searching and sorting need (title, year, director, genres) stays in every Film,
+ * and what only the info panel and the poster need (FilmDetails) is written to a ColdSegment as the films are created,
+ * and read back from it only when a film is drawn.
+ *
+ * A ColdSegment is a temporary file of encoded details, memory-mapped read-only (on POSIX systems; elsewhere it is read
+ * into memory instead). The pages of the details of films that aren't drawn are never touched, and being backed by the
+ * file they can always be dropped again by the OS, so the details of a large catalog cost next to no resident memory.
+ * Records of at least COLD_COMPRESS_MIN bytes are LZ77-compressed (an LZ4-style block, see coldsegment.cpp) if
+ * COLD_COMPRESS is set and it makes them smaller.
+ *
+ * Segments are written once and never change, so they can be read from any thread. A segment lives for as long as the
+ * films with records in it; a reload writes a segment of its own for the films it adds. */
+
+// FilmDetails: The cold part of a film
+struct FilmDetails {
+	std::string poster;						// the png of the film poster
+	std::string description;
+	std::vector<CastMember> cast;			// in billing order, as long as the film's cast is
+};
+
+class ColdSegment;
+
+// ColdRecord: Where a film's details are, along with a hash of them (so that changes can be told without reading them)
+struct ColdRecord {
+	std::shared_ptr<const ColdSegment> segment;
+	std::uint32_t offset{ 0 };
+	std::uint32_t size{ 0 };
+	std::uint64_t hash{ 0 };
+};
+
+class ColdSegment {
+private:
+	const unsigned char* m_data{ nullptr };
+	size_t m_size{ 0 };
+	std::vector<unsigned char> m_memory;			// the records, where they couldn't be mapped
+	bool m_mapped{ false };
+
+public:
+	ColdSegment() = default;
+	~ColdSegment();
+
+	ColdSegment(const ColdSegment&) = delete;
+	ColdSegment& operator=(const ColdSegment&) = delete;
+
+	// Writes the details into a new segment, and returns where each of them went (in the same order)
+	static std::vector<ColdRecord> write(std::span<const FilmDetails> details);
+
+	// The hash the record of the details has (or would have)
+	static std::uint64_t hash(const FilmDetails& details);
+
+	// Decodes a record of this segment
+	FilmDetails read(const ColdRecord& record) const;
+
+	size_t size() const							{ return m_size; }
+	bool isMapped() const						{ return m_mapped; }
+};
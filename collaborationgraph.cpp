@@ -0,0 +1,313 @@
+#include "collaborationgraph.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+	// whether a appears before b in a list of top collaborators
+	bool moreFrequent(const Collaborator& a, const Collaborator& b)
+	{
+		return a.films != b.films ? a.films > b.films : a.person < b.person;
+	}
+}
+
+/* a person's list comes from going through their films and everyone credited on them: the ids collected, sorted, and
+ * counted in runs. A film lists its people once each, even if someone is credited twice on it. */
+void CollaborationGraph::collect(const PersonIndex& people, PersonId person, std::vector<PersonId>& film,
+	std::vector<PersonId>& credited, Lists& lists)
+{
+	credited.clear();
+	for (const FilmId id : people.filmography(person)) {
+		film.clear();
+		if (people.director(id) != c_noPerson) {
+			film.push_back(people.director(id));
+		}
+		for (const Credit& credit : people.cast(id)) {
+			film.push_back(credit.person);
+		}
+		std::sort(film.begin(), film.end());
+		film.erase(std::unique(film.begin(), film.end()), film.end());
+		for (const PersonId other : film) {
+			if (other != person) {
+				credited.push_back(other);
+			}
+		}
+	}
+
+	std::sort(credited.begin(), credited.end());
+	const size_t before{ lists.collaborators.size() };
+	for (size_t i{ 0 }; i < credited.size();) {
+		size_t run{ i + 1 };
+		while (run < credited.size() && credited[run] == credited[i]) {
+			++run;
+		}
+		lists.collaborators.push_back(credited[i]);
+		lists.sharedFilms.push_back(static_cast<unsigned int>(run - i));
+		i = run;
+	}
+	lists.sizes.push_back(static_cast<unsigned int>(lists.collaborators.size() - before));
+}
+
+void CollaborationGraph::build(const PersonIndex& people)
+{
+	PROFILE_SCOPE("CollaborationGraph::build");
+	const size_t count{ people.size() };
+	const size_t grain{ COLLABORATION_BUILD_GRAIN };
+	std::vector<Lists> ranges((count + grain - 1) / grain);
+	TaskScheduler::getInstance()->parallelFor(0, count, grain, [&](size_t first, size_t last) {
+		Lists& lists{ ranges[first / grain] };
+		std::vector<PersonId> film;
+		std::vector<PersonId> credited;
+		for (PersonId person{ static_cast<PersonId>(first) }; person < last; ++person) {
+			collect(people, person, film, credited, lists);
+		}
+	});
+	join(ranges);
+}
+
+void CollaborationGraph::update(const CollaborationGraph& previous, const PersonIndex& previousPeople, const PersonIndex& people,
+	const FilmRemap& remap)
+{
+	PROFILE_SCOPE("CollaborationGraph::update");
+
+	// every pair of people credited on a film that went loses a shared film, every pair on one that came gains one
+	std::vector<PairDelta> deltas;
+	std::vector<PersonId> film;
+	auto pairUp{ [&deltas, &film](const PersonIndex& index, FilmId id, int change) {
+		film.clear();
+		if (index.director(id) != c_noPerson) {
+			film.push_back(index.director(id));
+		}
+		for (const Credit& credit : index.cast(id)) {
+			film.push_back(credit.person);
+		}
+		std::sort(film.begin(), film.end());
+		film.erase(std::unique(film.begin(), film.end()), film.end());
+		for (const PersonId person : film) {
+			for (const PersonId other : film) {
+				if (other != person) {
+					deltas.push_back({ person, other, change });
+				}
+			}
+		}
+	} };
+	for (FilmId old{ 0 }; old < remap.oldToNew.size(); ++old) {
+		if (remap.oldToNew[old] == c_noFilm) {
+			pairUp(previousPeople, old, -1);
+		}
+	}
+	for (const FilmId id : remap.added) {
+		pairUp(people, id, 1);
+	}
+
+	// in the order of the lists, with the changes to the same pair added up
+	std::sort(deltas.begin(), deltas.end(), [](const PairDelta& a, const PairDelta& b) {
+		return a.person != b.person ? a.person < b.person : a.other < b.other;
+	});
+	size_t summed{ 0 };
+	for (size_t i{ 0 }; i < deltas.size(); ++i) {
+		if (summed > 0 && deltas[summed - 1].person == deltas[i].person && deltas[summed - 1].other == deltas[i].other) {
+			deltas[summed - 1].films += deltas[i].films;
+		}
+		else {
+			deltas[summed++] = deltas[i];
+		}
+	}
+	deltas.resize(summed);
+
+	/* everyone without a change keeps their list, copied over a run of people at a time; everyone with one has the changes
+	 * merged into theirs. New people start out with none, and people who share no films anymore drop out of the list. */
+	const size_t count{ people.size() };
+	const PersonId previousCount{ static_cast<PersonId>(previous.m_offsets.empty() ? 0 : previous.m_offsets.size() - 1) };
+	m_offsets.assign(count + 1, 0);
+	m_collaborators.clear();
+	m_sharedFilms.clear();
+	m_collaborators.reserve(previous.m_collaborators.size() + deltas.size());
+	m_sharedFilms.reserve(previous.m_sharedFilms.size() + deltas.size());
+
+	PersonId next{ 0 };				// the first person whose list hasn't been written yet
+	auto carryOver{ [&](PersonId until) {
+		const PersonId last{ std::min(until, previousCount) };
+		if (next < last) {
+			const unsigned int from{ previous.m_offsets[next] };
+			const unsigned int to{ previous.m_offsets[last] };
+			const unsigned int base{ static_cast<unsigned int>(m_collaborators.size()) };
+			m_collaborators.insert(m_collaborators.end(), previous.m_collaborators.begin() + from, previous.m_collaborators.begin() + to);
+			m_sharedFilms.insert(m_sharedFilms.end(), previous.m_sharedFilms.begin() + from, previous.m_sharedFilms.begin() + to);
+			for (PersonId person{ next }; person < last; ++person) {
+				m_offsets[person + 1] = previous.m_offsets[person + 1] - from + base;
+			}
+			next = last;
+		}
+		for (; next < until; ++next) {
+			m_offsets[next + 1] = static_cast<unsigned int>(m_collaborators.size());
+		}
+	} };
+
+	for (size_t i{ 0 }; i < deltas.size();) {
+		const PersonId person{ deltas[i].person };
+		carryOver(person);
+
+		size_t at{ person < previousCount ? previous.m_offsets[person] : 0 };
+		const size_t end{ person < previousCount ? previous.m_offsets[person + 1] : 0 };
+		for (; i < deltas.size() && deltas[i].person == person; ++i) {
+			for (; at < end && previous.m_collaborators[at] < deltas[i].other; ++at) {
+				m_collaborators.push_back(previous.m_collaborators[at]);
+				m_sharedFilms.push_back(previous.m_sharedFilms[at]);
+			}
+			int films{ deltas[i].films };
+			if (at < end && previous.m_collaborators[at] == deltas[i].other) {
+				films += static_cast<int>(previous.m_sharedFilms[at++]);
+			}
+			if (films > 0) {
+				m_collaborators.push_back(deltas[i].other);
+				m_sharedFilms.push_back(static_cast<unsigned int>(films));
+			}
+		}
+		m_collaborators.insert(m_collaborators.end(), previous.m_collaborators.begin() + at, previous.m_collaborators.begin() + end);
+		m_sharedFilms.insert(m_sharedFilms.end(), previous.m_sharedFilms.begin() + at, previous.m_sharedFilms.begin() + end);
+		m_offsets[person + 1] = static_cast<unsigned int>(m_collaborators.size());
+		next = person + 1;
+	}
+	carryOver(static_cast<PersonId>(count));
+}
+
+void CollaborationGraph::join(std::span<const Lists> ranges)
+{
+	m_offsets.assign(1, 0);
+	m_collaborators.clear();
+	m_sharedFilms.clear();
+	for (const Lists& lists : ranges) {
+		for (const unsigned int size : lists.sizes) {
+			m_offsets.push_back(m_offsets.back() + size);
+		}
+		m_collaborators.insert(m_collaborators.end(), lists.collaborators.begin(), lists.collaborators.end());
+		m_sharedFilms.insert(m_sharedFilms.end(), lists.sharedFilms.begin(), lists.sharedFilms.end());
+	}
+}
+
+std::span<const PersonId> CollaborationGraph::collaborators(PersonId person) const
+{
+	if (person + 1 >= m_offsets.size()) {
+		return {};
+	}
+	return std::span<const PersonId>{ m_collaborators }.subspan(m_offsets[person], m_offsets[person + 1] - m_offsets[person]);
+}
+
+unsigned int CollaborationGraph::sharedFilms(PersonId a, PersonId b) const
+{
+	// looking through the shorter of the two lists
+	if (collaborators(b).size() < collaborators(a).size()) {
+		std::swap(a, b);
+	}
+	const std::span<const PersonId> list{ collaborators(a) };
+	auto at{ std::lower_bound(list.begin(), list.end(), b) };
+	if (at == list.end() || *at != b) {
+		return 0;
+	}
+	return m_sharedFilms[m_offsets[a] + (at - list.begin())];
+}
+
+void CollaborationGraph::topCollaborators(PersonId person, size_t count, std::vector<Collaborator>& top) const
+{
+	// a heap of the count most frequent so far, with the least frequent of them on top, to be pushed out by anyone more frequent
+	top.clear();
+	if (!count) {
+		return;
+	}
+	const std::span<const PersonId> list{ collaborators(person) };
+	const unsigned int offset{ list.empty() ? 0 : m_offsets[person] };
+	for (size_t i{ 0 }; i < list.size(); ++i) {
+		Collaborator collaborator{ list[i], m_sharedFilms[offset + i] };
+		if (top.size() < count) {
+			top.push_back(collaborator);
+			std::push_heap(top.begin(), top.end(), moreFrequent);
+		}
+		else if (moreFrequent(collaborator, top.front())) {
+			std::pop_heap(top.begin(), top.end(), moreFrequent);
+			top.back() = collaborator;
+			std::push_heap(top.begin(), top.end(), moreFrequent);
+		}
+	}
+	std::sort_heap(top.begin(), top.end(), moreFrequent);
+}
+
+void gallopingIntersect(std::span<const FilmId> sorted, std::span<const FilmId> filmography, std::vector<FilmId>& out)
+{
+	// everything in the filmography before base is smaller than the film being looked for
+	size_t base{ 0 };
+	for (const FilmId id : sorted) {
+		size_t step{ 1 };
+		while (base + step < filmography.size() && filmography[base + step] < id) {
+			step *= 2;
+		}
+		// the film is in (base + step / 2, base + step], if it is there at all
+		auto first{ filmography.begin() + base + step / 2 };
+		auto last{ filmography.begin() + std::min(base + step + 1, filmography.size()) };
+		auto at{ std::lower_bound(first, last, id) };
+		base = static_cast<size_t>(at - filmography.begin());
+		if (base == filmography.size()) {
+			break;
+		}
+		if (*at == id) {
+			out.push_back(id);
+			++base;
+		}
+	}
+}
+
+void runPersonQuery(const PersonIndex& people, const CollaborationGraph& graph, std::span<const PersonTerm> terms,
+	PersonQueryMode mode, FilmBitmap& films)
+{
+	PROFILE_SCOPE("runPersonQuery");
+	films.clear();
+	if (terms.empty()) {
+		return;
+	}
+
+	if (mode == PersonQueryMode::ANY) {
+		for (const PersonTerm& term : terms) {
+			for (const FilmId id : people.filmography(term.person, term.kind)) {
+				films.set(id);
+			}
+		}
+		return;
+	}
+
+	// people who never worked together have no films in common, which the graph knows without going through any
+	for (size_t a{ 0 }; a < terms.size(); ++a) {
+		for (size_t b{ a + 1 }; b < terms.size(); ++b) {
+			if (terms[a].person != terms[b].person && !graph.sharedFilms(terms[a].person, terms[b].person)) {
+				return;
+			}
+		}
+	}
+
+	// the shortest filmography first, which is where the intersecting starts from
+	std::vector<std::span<const FilmId>> filmographies;
+	for (const PersonTerm& term : terms) {
+		filmographies.push_back(people.filmography(term.person, term.kind));
+	}
+	std::sort(filmographies.begin(), filmographies.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+
+	std::vector<FilmId> result(filmographies[0].begin(), filmographies[0].end());
+	std::vector<FilmId> next;
+	for (size_t term{ 1 }; term < filmographies.size() && !result.empty(); ++term) {
+		// galloping only pays off while the films left are far fewer than the filmography; otherwise a merge is quicker
+		next.clear();
+		if (result.size() * PERSON_QUERY_GALLOP_RATIO < filmographies[term].size()) {
+			gallopingIntersect(result, filmographies[term], next);
+		}
+		else {
+			std::set_intersection(result.begin(), result.end(), filmographies[term].begin(), filmographies[term].end(),
+				std::back_inserter(next));
+		}
+		result.swap(next);
+	}
+
+	for (const FilmId id : result) {
+		films.set(id);
+	}
+}
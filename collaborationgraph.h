@@ -0,0 +1,91 @@
+#pragma once
+#include "personindex.h"
+#include "filmbitmap.h"
+
+#include <vector>
+#include <span>
+
+/* CollaborationGraph: Who worked with whom, and on how many films. Two people are collaborators if they are both
+ * credited on a film, as its director or in its cast.
+ *
+ * Stored in CSR form like the PersonIndex it is built from: one array of offsets by PersonId into one array of
+ * collaborators, each person's in PersonId order, with the number of films they share alongside. Looking up whether
+ * two people ever worked together is a binary search through one of their lists, and someone's most frequent
+ * collaborators only need their own list looked at. Built along with the catalog; when the catalog is updated, every
+ * pair of people on a film that came or went gains or loses a shared film, and those changes are merged into the lists
+ * they are in, so an update costs about as much as the credits of the films that changed (and copying the rest over). */
+
+// Collaborator: someone a person worked with, and on how many films
+struct Collaborator {
+	PersonId person;
+	unsigned int films;
+};
+
+class CollaborationGraph {
+private:
+	std::vector<unsigned int> m_offsets;					// one per person, and one more
+	std::vector<PersonId> m_collaborators;
+	std::vector<unsigned int> m_sharedFilms;				// alongside m_collaborators
+
+	// Lists: a range of people's lists, worked out on one of the scheduler's workers, to be put together in order afterwards
+	struct Lists {
+		std::vector<unsigned int> sizes;
+		std::vector<PersonId> collaborators;
+		std::vector<unsigned int> sharedFilms;
+	};
+
+	// PairDelta: how many films a person gains (or, if negative, loses) with someone else through an update
+	struct PairDelta {
+		PersonId person;
+		PersonId other;
+		int films;
+	};
+
+	// appends a person's list to lists, film and credited being scratch space
+	static void collect(const PersonIndex& people, PersonId person, std::vector<PersonId>& film, std::vector<PersonId>& credited,
+		Lists& lists);
+
+	// puts the lists of all the ranges, in order, together into the graph
+	void join(std::span<const Lists> ranges);
+
+public:
+	// (Re)builds the graph from the filmographies and casts of a PersonIndex
+	void build(const PersonIndex& people);
+
+	// Builds the graph of an updated catalog (see PersonIndex::update()) from the one of the catalog it was updated from
+	void update(const CollaborationGraph& previous, const PersonIndex& previousPeople, const PersonIndex& people, const FilmRemap& remap);
+
+	// Everyone a person worked with, in PersonId order
+	std::span<const PersonId> collaborators(PersonId person) const;
+
+	// How many films two people share
+	unsigned int sharedFilms(PersonId a, PersonId b) const;
+
+	// The count collaborators a person shares the most films with, the most frequent first (ties by PersonId)
+	void topCollaborators(PersonId person, size_t count, std::vector<Collaborator>& top) const;
+};
+
+/* Person queries: "films with A and B", "films with A or B", where each person can be required to have directed or
+ * acted (or either) in the films.
+ *
+ * ALL intersects the filmographies, the shortest first, so that every later step only has as many films left to look
+ * for as there are results so far. Each film is looked for with a galloping search: from where the last one was found,
+ * steps of 1, 2, 4... until the step goes past it, then a binary search over the last step. Finding k films in a
+ * filmography of n costs O(k log(n / k)) instead of the O(n) a merge would take, which is what makes asking for a
+ * few films of someone with thousands cheap. When there are about as many films left as in the filmography (within
+ * PERSON_QUERY_GALLOP_RATIO), a plain merge is quicker, so that is what it does then. Before any of that, the
+ * CollaborationGraph is asked whether the people ever worked together at all. ANY unites the filmographies. */
+
+struct PersonTerm {
+	PersonId person;
+	CreditKind kind;
+};
+
+enum class PersonQueryMode { ALL, ANY };
+
+// Appends to out the films of sorted that are also in filmography, in order
+void gallopingIntersect(std::span<const FilmId> sorted, std::span<const FilmId> filmography, std::vector<FilmId>& out);
+
+// Selects in films (which is cleared first) the films that fit the terms
+void runPersonQuery(const PersonIndex& people, const CollaborationGraph& graph, std::span<const PersonTerm> terms,
+	PersonQueryMode mode, FilmBitmap& films);
@@ -1,6 +1,9 @@
 #include "film.h"
+#include "profiler.h"
 #include "filmutil.h"
 #include "util.h"
+#include "postercache.h"
+#include "thumbnailcache.h"
 #include "global.h"
 #include "graphics.h"
 
@@ -10,19 +13,28 @@
 #include <iostream>
 #include <cstdio>
 #include <vector>
+#include <utility>
+
+namespace {
+	unsigned short genreBits(const std::unordered_set<Genre>& genres)
+	{
+		unsigned short bits{ 0 };
+		for (const auto genre : genres) {
+			bits |= genreBit(genre);
+		}
+		return bits;
+	}
+}
 
 //initialising all member variables
 Film::Film(const std::string_view title, unsigned int releaseYear, const std::string_view director,
-	const std::unordered_set<Genre>& genres, const std::array<std::string, 5>& cast,
-	const std::string_view description, const std::string_view poster) :
+	const std::unordered_set<Genre>& genres, ColdRecord cold) :
+	m_filmID{ s_filmID++ },
 	m_title{title},
-	m_releaseYear{releaseYear},
 	m_director {director},
-	m_genres{ genres },
-	m_cast{ cast },
-	m_description{description},
-	m_poster{ poster },
-	m_filmID{ s_filmID++ },
+	m_releaseYear{releaseYear},
+	m_genres{ genreBits(genres) },
+	m_cold{ std::move(cold) },
 
 	// utilising modulo to generate an offset for the starting position based on the id of the film:
 	// modulo 5 to calculate the starting x location (10 films, 2 rows)
@@ -36,22 +48,22 @@ Film::~Film() = default;
 
 void Film::draw()
 {
+	PROFILE_SCOPE("Film::draw");
 	float highlighted = 0.45f * m_highlighted;
 	float active = 1.0f * m_active;
-	m_brush.outline_opacity = 1.0f;
+	s_brush.outline_opacity = 1.0f;
 
 	// if we haven't yet clicked on a film, therefore every film we hover over will have its relevant info shown at the bottom
 	if (s_filmState == FilmState::NO_FILM_CLICKED) {
-		SETCOLOUR(m_brush.outline_color, highlighted, highlighted, highlighted);
-		setTexture(m_brush, m_poster);
-		graphics::drawRect(m_pos_x, m_pos_y, m_posterWidth, m_posterHeight, m_brush);
+		SETCOLOUR(s_brush.outline_color, highlighted, highlighted, highlighted);
+		drawPoster();
 
 		// if highlighted, display the relevant info at the bottom of the page
 		if (m_highlighted) {
 
 			setFont("Montserrat-Medium.ttf");
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
-			graphics::drawText(canvasWidthOffset(0.025f), canvasHeightOffset(0.735f), 40, m_title, m_brush);		// title
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.735f), 40, m_title, s_brush);		// title
 
 			// genres
 
@@ -61,10 +73,10 @@ void Film::draw()
 			float previousOffset{ 0.65f };
 
 			setFont("Montserrat-MediumItalic.ttf");
-			SETCOLOUR(m_brush.fill_color, 0.7f, 0.6f, 0.0f);
+			SETCOLOUR(s_brush.fill_color, 0.7f, 0.6f, 0.0f);
 
-			for (const auto genre : m_genres) {
-				graphics::drawText(canvasWidthOffset(previousOffset), canvasHeightOffset(0.735f), 18, genreName(genre), m_brush);
+			for (const auto genre : getGenres()) {
+				queueText(canvasWidthOffset(previousOffset), canvasHeightOffset(0.735f), 18, genreName(genre), s_brush);
 				if (genreName(genre).size() <= 5) {
 					previousOffset += 0.06f + genreName(genre).size() * 0.0025f;
 				}
@@ -74,20 +86,19 @@ void Film::draw()
 			}
 
 			setFont("Montserrat-Medium.ttf");
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 
-			drawLineOfText(0.025f, 0.78f, 25, "Director:", m_director);												// director
-			drawLineOfText(0.025f, 0.82f, 23, "Cast:", castToString());												// cast
+			drawPeople();																						// director, cast
 			drawLineOfText(0.025f, 0.86f, 23, "Year:", std::to_string(m_releaseYear));								// year
 
 			std::vector<std::string> description{ tokenizeDescription()};
-			SETCOLOUR(m_brush.fill_color, 0.5f, 0.5f, 0.5f);
+			SETCOLOUR(s_brush.fill_color, 0.5f, 0.5f, 0.5f);
 			setFont("Montserrat-MediumItalic.ttf");
-			graphics::drawText(canvasWidthOffset(0.025f), canvasHeightOffset(0.90f), 23, "Summary:", m_brush);
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.90f), 23, "Summary:", s_brush);
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 			setFont("Montserrat-Medium.ttf");
 			for (int i{ 0 }; i < description.size(); ++i) {
-				graphics::drawText(canvasWidthOffset(0.15f), canvasHeightOffset(0.90f + (i * 0.03f)), 21, description[i], m_brush);
+				queueText(canvasWidthOffset(0.15f), canvasHeightOffset(0.90f + (i * 0.03f)), 21, description[i], s_brush);
 			}
 		}
 	}
@@ -95,13 +106,12 @@ void Film::draw()
 	else {
 		highlighted -= 0.15f * m_highlighted;
 		if (m_active) {
-			SETCOLOUR(m_brush.outline_color, active, active, active);
-			setTexture(m_brush, m_poster);
-			graphics::drawRect(m_pos_x, m_pos_y, m_posterWidth, m_posterHeight, m_brush);
+			SETCOLOUR(s_brush.outline_color, active, active, active);
+			drawPoster();
 
 			setFont("Montserrat-Medium.ttf");
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
-			graphics::drawText(canvasWidthOffset(0.025f), canvasHeightOffset(0.735f), 40, m_title, m_brush);		// title
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.735f), 40, m_title, s_brush);		// title
 
 			// genres
 
@@ -111,10 +121,10 @@ void Film::draw()
 			float previousOffset{ 0.65f };
 
 			setFont("Montserrat-MediumItalic.ttf");
-			SETCOLOUR(m_brush.fill_color, 0.7f, 0.6f, 0.0f);
+			SETCOLOUR(s_brush.fill_color, 0.7f, 0.6f, 0.0f);
 
-			for (const auto genre : m_genres) {
-				graphics::drawText(canvasWidthOffset(previousOffset), canvasHeightOffset(0.735f), 18, genreName(genre), m_brush);
+			for (const auto genre : getGenres()) {
+				queueText(canvasWidthOffset(previousOffset), canvasHeightOffset(0.735f), 18, genreName(genre), s_brush);
 				if (genreName(genre).size() <= 5) {
 					previousOffset += 0.06f + genreName(genre).size() * 0.0025f;
 				}
@@ -124,54 +134,134 @@ void Film::draw()
 			}
 
 			setFont("Montserrat-Medium.ttf");
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 
-			drawLineOfText(0.025f, 0.78f, 25, "Director:", m_director);												// director
-			drawLineOfText(0.025f, 0.82f, 23, "Cast:", castToString());												// cast
+			drawPeople();																						// director, cast
 			drawLineOfText(0.025f, 0.86f, 23, "Year:", std::to_string(m_releaseYear));								// year
 
 			std::vector<std::string> description{ tokenizeDescription() };
-			SETCOLOUR(m_brush.fill_color, 0.5f, 0.5f, 0.5f);
+			SETCOLOUR(s_brush.fill_color, 0.5f, 0.5f, 0.5f);
 			setFont("Montserrat-MediumItalic.ttf");
-			graphics::drawText(canvasWidthOffset(0.025f), canvasHeightOffset(0.90f), 23, "Summary:", m_brush);
-			SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.90f), 23, "Summary:", s_brush);
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 			setFont("Montserrat-Medium.ttf");
 			for (int i{ 0 }; i < description.size(); ++i) {
-				graphics::drawText(canvasWidthOffset(0.15f), canvasHeightOffset(0.90f + (i * 0.03f)), 21, description[i], m_brush);
+				queueText(canvasWidthOffset(0.15f), canvasHeightOffset(0.90f + (i * 0.03f)), 21, description[i], s_brush);
 			}
 		}
 		// active films have twice as intense an outline as highlighted films do. Therefore, making this condition an else, so
 		// if we have set a film as active, we do not bother drawing it with the active outline, but with the highlighted outline
 		else {
 			// if a film is highlighted while we do have an active film, give it a slight outline
-			SETCOLOUR(m_brush.outline_color, highlighted, highlighted, highlighted);
-			setTexture(m_brush, m_poster);
-			graphics::drawRect(m_pos_x, m_pos_y, m_posterWidth, m_posterHeight, m_brush);
+			SETCOLOUR(s_brush.outline_color, highlighted, highlighted, highlighted);
+			drawPoster();
 		}
 	}
 
 	//resetting the film brush
-	SETCOLOUR(m_brush.outline_color, 0.0f, 0.0f, 0.0f);
-	setTexture(m_brush, "");
+	SETCOLOUR(s_brush.outline_color, 0.0f, 0.0f, 0.0f);
+	setTexture(s_brush, "");
 
 }
 
 
+// draws the poster (its baked thumbnail, if there is one) with the current outline, or a placeholder if it hasn't been loaded yet
+void Film::drawPoster()
+{
+	drawPoster(m_pos_x, m_pos_y, s_posterWidth, s_posterHeight);
+}
+
+void Film::drawPoster(float x, float y, float width, float height)
+{
+	const std::string& poster{ ThumbnailCache::getInstance()->lookup(details().poster) };
+	if (PosterCache::getInstance()->touch(poster)) {
+		setTexture(s_brush, poster);
+	}
+	else {
+		setTexture(s_brush, "");
+		SETCOLOUR(s_brush.fill_color, 0.2f, 0.2f, 0.2f);
+	}
+	queueRect(x, y, width, height, s_brush);
+	SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
+}
+
 void Film::drawLineOfText(float offsetX, float offsetY, float size, const std::string& attribute, const std::string& text)
 {
 	// printing the attribute towards the left of the screen
-	SETCOLOUR(m_brush.fill_color, 0.5f, 0.5f, 0.5f);
+	SETCOLOUR(s_brush.fill_color, 0.5f, 0.5f, 0.5f);
 	setFont("Montserrat-MediumItalic.ttf");
-	graphics::drawText(canvasWidthOffset(offsetX), canvasHeightOffset(offsetY), size, attribute, m_brush);
+	queueText(canvasWidthOffset(offsetX), canvasHeightOffset(offsetY), size, attribute, s_brush);
 
 	// updating offsets, slightly lowering the size of the text to be printed now
 	offsetX += 0.1275f;
 	size *= 0.9f;
 
 	//printing the text towards the centre of the screen
-	SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+	SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 	setFont("Montserrat-Medium.ttf");
-	graphics::drawText(canvasWidthOffset(offsetX), canvasHeightOffset(offsetY), size , text, m_brush);
+	queueText(canvasWidthOffset(offsetX), canvasHeightOffset(offsetY), size , text, s_brush);
+}
+
+template <typename Function>
+size_t Film::forEachPerson(Function function) const
+{
+	// the same offsets and sizes drawLineOfText() uses. There is no way to measure text, so every character is taken to
+	// be INFO_CHARACTER_WIDTH of the font size wide, which is about what Montserrat's average is.
+	const float left{ canvasWidthOffset(0.025f + 0.1275f) };
+	const std::vector<CastMember>& cast{ details().cast };
+	function(m_director, left, canvasHeightOffset(0.78f), 25 * 0.9f, false);
+
+	// the cast goes on for as long as there is room, leaving some at the end of the line for how many didn't fit
+	const float size{ 23 * 0.9f };
+	const float right{ canvasWidthOffset(0.9f) };
+	size_t shown{ 0 };
+	float x{ left };
+	while (shown < cast.size() && x + cast[shown].name.size() * size * INFO_CHARACTER_WIDTH <= right) {
+		x += (cast[shown].name.size() + 3) * size * INFO_CHARACTER_WIDTH;		// the name and the ",  " after it
+		++shown;
+	}
+	x = left;
+	for (size_t i{ 0 }; i < shown; ++i) {
+		function(cast[i].name, x, canvasHeightOffset(0.82f), size, i + 1 < shown);
+		x += (cast[i].name.size() + 3) * size * INFO_CHARACTER_WIDTH;
+	}
+	return shown;
+}
+
+void Film::drawPeople()
+{
+	SETCOLOUR(s_brush.fill_color, 0.5f, 0.5f, 0.5f);
+	setFont("Montserrat-MediumItalic.ttf");
+	queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.78f), 25, "Director:", s_brush);
+	queueText(canvasWidthOffset(0.025f), canvasHeightOffset(0.82f), 23, "Cast:", s_brush);
+
+	setFont("Montserrat-Medium.ttf");
+	float end{ 0.0f };
+	const size_t shown{ forEachPerson([this, &end](const std::string& name, float x, float y, float size, bool separated) {
+		if (&name == m_hoveredPerson) {
+			SETCOLOUR(s_brush.fill_color, 1.0f, 0.9f, 0.2f);
+		}
+		else {
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
+		}
+		queueText(x, y, size, name, s_brush);
+		end = x + name.size() * size * INFO_CHARACTER_WIDTH;
+
+		// the separators are drawn on their own, so that they never look like part of a name
+		if (separated) {
+			SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
+			queueText(end, y, size, ",", s_brush);
+		}
+	}) };
+
+	const size_t castSize{ details().cast.size() };
+	if (shown < castSize) {
+		SETCOLOUR(s_brush.fill_color, 0.5f, 0.5f, 0.5f);
+		setFont("Montserrat-MediumItalic.ttf");
+		queueText(end + 10.0f, canvasHeightOffset(0.82f), 23 * 0.9f, "and " + std::to_string(castSize - shown) + " more", s_brush);
+		setFont("Montserrat-Medium.ttf");
+	}
+	SETCOLOUR(s_brush.fill_color, 1.0f, 1.0f, 1.0f);
 }
 
 // DEPRECATED: Film's update is not used in this project.
@@ -194,13 +284,25 @@ void Film::setPosY(const float pos_y)
 // to check if our mouse coordinates are inside a film poster
 bool Film::contains(const float x, const float y) const
 {
-	return rectangularContains(m_pos_x, m_pos_y, m_posterWidth, m_posterHeight, x, y);
+	return rectangularContains(m_pos_x, m_pos_y, s_posterWidth, s_posterHeight, x, y);
+}
+
+const std::string* Film::personAt(const float x, const float y) const
+{
+	// text is drawn from its baseline up, so the box of a name goes from a font size above the baseline to a bit below it
+	const std::string* found{ nullptr };
+	forEachPerson([&found, x, y](const std::string& name, float left, float baseline, float size, bool) {
+		float width{ name.size() * size * INFO_CHARACTER_WIDTH };
+		if (!name.empty() && x >= left && x <= left + width && y >= baseline - size && y <= baseline + size * 0.25f) {
+			found = &name;
+		}
+	});
+	return found;
 }
 
-// for when we have to print the cast to screen
-std::string Film::castToString() const
+void Film::setHoveredPerson(const std::string* person)
 {
-	return m_cast[0] + ",  " + m_cast[1] + ",  " + m_cast[2] + ",  " + m_cast[3] + ",  " + m_cast[4];
+	m_hoveredPerson = person;
 }
 
 unsigned int Film::getReleaseYear() const
@@ -219,10 +321,44 @@ const std::string& Film::getTitle() const
 }
 
 std::unordered_set<enum class Genre> Film::getGenres() const
+{
+	std::unordered_set<Genre> genres;
+	for (const auto genre : genresToArray()) {
+		if (m_genres & genreBit(genre)) {
+			genres.insert(genre);
+		}
+	}
+	return genres;
+}
+
+unsigned short Film::getGenreBits() const
 {
 	return m_genres;
 }
 
+const FilmDetails& Film::details() const
+{
+	if (!m_details) {
+		m_details = std::make_unique<FilmDetails>(readDetails());
+	}
+	return *m_details;
+}
+
+FilmDetails Film::readDetails() const
+{
+	return m_cold.segment ? m_cold.segment->read(m_cold) : FilmDetails{};
+}
+
+void Film::releaseDetails()
+{
+	m_details.reset();
+}
+
+std::uint64_t Film::getDetailsHash() const
+{
+	return m_cold.hash;
+}
+
 void Film::setHighlighted(bool highlighted)
 {
 	m_highlighted = highlighted;
@@ -241,6 +377,7 @@ void Film::setActive(bool active)
 	}
 	else {
 		s_filmState = FilmState::NO_FILM_CLICKED;
+		m_hoveredPerson = nullptr;
 	}
 }
 bool Film::isActive() const
@@ -251,7 +388,7 @@ bool Film::isActive() const
 const std::vector<std::string> Film::tokenizeDescription() const
 {
 	std::vector<std::string> words;				// "words" will be the vector that contains all the words from our description, split every ' '
-	std::stringstream tokenizer(m_description);
+	std::stringstream tokenizer(details().description);
 	std::string word;							//  "word" will represent each unique word from our description
 
 	while (std::getline(tokenizer, word, ' ')) {
@@ -3,6 +3,7 @@
 #include "util.h"
 #include "global.h"
 #include "graphics.h"
+#include "coldsegment.h"
 
 #include <unordered_set>
 #include <array>
@@ -10,6 +11,8 @@
 #include <iostream>
 #include <cstdio>
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 /* Using a custom enum to signify 2 states in regards to the films being drawn:
 *  If we haven't yet clicked on any film, any film that we're hovering over will have its relevant info shown at the bottom of the screen.
@@ -29,52 +32,75 @@ private:
 	// making the enum var static so whenever we click on a film, all the other films know
 	static inline FilmState s_filmState{ FilmState::NO_FILM_CLICKED };
 
-	const float m_posterWidth{ 105 };					// the width of a film's poster
+	static constexpr float s_posterWidth{ POSTER_WIDTH };		// the width of a film's poster
 
-	const float m_posterHeight{ 160 };					// the height of a film's poster
-
-	const std::string m_poster;							// the string of the png of the film poster
+	static constexpr float s_posterHeight{ POSTER_HEIGHT };	// the height of a film's poster
 
+	/* The hot part of a film, what searching and sorting look at, is all a film keeps. The rest of it (its poster, description
+	 * and cast) is in a ColdSegment, where m_cold says, and only read into m_details while the film is drawn. */
 	const std::string m_title;
-	const unsigned int m_releaseYear;
 	const std::string m_director;
-	std::unordered_set<enum class Genre> m_genres;
-	std::string m_description;
-	std::array<std::string, 5> m_cast;					// using an array of size 5 to have a common amount of actors per film
+	const unsigned int m_releaseYear;
+	const unsigned short m_genres;						// one bit per genre, see genreBit()
+	const ColdRecord m_cold;
+	mutable std::unique_ptr<FilmDetails> m_details;
 
-	struct graphics::Brush m_brush;						// each film will have its own Brush member variable
+	static inline struct graphics::Brush s_brush;		// the films are drawn one after the other, so they share a Brush
 	float m_pos_x;
 	float m_pos_y;
 
 	// tokenizeDescription: helper function to tokenize a film's description for accurate drawing
 	const std::vector<std::string> tokenizeDescription() const;
 
+	// the name in the info panel the mouse is over, if any, drawn highlighted since clicking it shows that person's films
+	const std::string* m_hoveredPerson{ nullptr };
+
+	/* forEachPerson: Lays out the names of the director and cast lines of the info panel, one after the other, calling
+	 * function(name, left, baseline, size, separated) for each, where separated is whether another name follows on the
+	 * same line. Only as many cast members as fit on the line are laid out; returns how many. Drawing and hit testing
+	 * both go through it, so they always agree. */
+	template <typename Function>
+	size_t forEachPerson(Function function) const;
+
 	bool m_highlighted { false };						// a film is highlighted when our mouse is hovering over it
 	bool m_active { false };							// a film is "active" if we have clicked on it - makes all other films unavailable for highlighting
 
 public:
 	Film(const std::string_view title, unsigned int releaseYear, const std::string_view director,
-		const std::unordered_set<Genre>& genres, const std::array<std::string, 5>& cast,
-		const std::string_view description, const std::string_view poster);
+		const std::unordered_set<Genre>& genres, ColdRecord cold);
 	
 	~Film();
 
 	void draw();
 
 	// drawLineOfText: extra function so that we don't clutter our draw function. 5 parameters, first 2 are the canvas width/height
-	// offset, and the rest of the parameters are the ones graphics::drawText needs (excluding Brush since it will be our member variable)
+	// offset, and the rest of the parameters are the ones queueText needs (excluding Brush since it will be our member variable)
 	void drawLineOfText(float offsetX, float offsetY, float size, const std::string& attribute, const std::string& text);
 
+	// drawPeople: Draws the director and cast lines of the info panel, every name on its own so that it can be clicked
+	void drawPeople();
+
+	// drawPoster: Draws the film's poster, or a placeholder while the PosterCache is still loading it. By default where the
+	// film is on the page; the "More like this" strip draws it smaller, elsewhere.
+	void drawPoster();
+	void drawPoster(float x, float y, float width, float height);
+
 	// DEPRECATED: Film's update is not used in this project.
 	void update();
 
-	// DEPRECATED: setPosX & setPosY are not used in this project.
+	// setPosX & setPosY: FilmUI places the films of the page it shows with these, in the order of the results.
 	void setPosX(const float pos_x);
 	void setPosY(const float pos_y);
 
 	// contains: to check if our mouse coordinates are inside a film poster
 	bool contains(const float x, const float y) const;
 
+	// personAt: The name of the director or cast member drawn in the info panel at the given coordinates, or nullptr
+	const std::string* personAt(const float x, const float y) const;
+
+	// setHoveredPerson: The name to draw highlighted in the info panel (one returned by personAt()), or nullptr for none
+	void setHoveredPerson(const std::string* person);
+
 	// setHighlighted: Setter for film's "m_highlighted" variable.
 	void setHighlighted(bool highlighted);
 
@@ -87,13 +113,20 @@ public:
 	// isActive: Returns true if we've clicked on a film's poster.
 	bool isActive() const;
 
-	/* getReleaseYear/getDirector/getTitle/getGenres: Typical getters. */
+	/* getReleaseYear/getDirector/getTitle/getGenres/getGenreBits: Typical getters. */
 
 	unsigned int getReleaseYear() const;
 	const std::string& getDirector() const;
 	const std::string& getTitle() const;
 	std::unordered_set<enum class Genre> getGenres() const;
+	unsigned short getGenreBits() const;
+
+	/* details: The film's poster, description and cast, paged in from its ColdSegment the first time they are needed and
+	 * kept until releaseDetails(). For the UI thread only; anywhere else, readDetails() decodes a copy of them instead. */
+	const FilmDetails& details() const;
+	FilmDetails readDetails() const;
+	void releaseDetails();
 
-	// castToString: Return a film's cast as a single string. Used when drawing the film cast on the screen.
-	std::string castToString() const;
+	// getDetailsHash: The hash of the details (see ColdSegment::hash()), to tell whether they changed without reading them
+	std::uint64_t getDetailsHash() const;
 };
\ No newline at end of file
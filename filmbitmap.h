@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <utility>
+#include <bit>
+#include <algorithm>
+
+// FilmId: A film's index in the FilmCatalog, and so in every one of its columns
+using FilmId = unsigned int;
+
+/* FilmBitmap: A selection of films, one bit per FilmId. This is what searches pass around instead of sets of Film*:
+ * narrowing a selection down means writing a second bitmap, so once both have been sized to the catalog nothing is
+ * allocated or freed, however many filters run. */
+
+class FilmBitmap {
+private:
+	std::vector<std::uint64_t> m_words;
+	size_t m_size{ 0 };
+
+	// the bits of the last word past m_size have to stay 0, or count()/forEach() would see films that don't exist
+	void trimLastWord() {
+		if (m_size % 64) {
+			m_words.back() &= (std::uint64_t{ 1 } << (m_size % 64)) - 1;
+		}
+	}
+
+public:
+	// Sizes the bitmap for a catalog of the given size, with nothing selected
+	void resize(size_t size) {
+		m_size = size;
+		m_words.assign((size + 63) / 64, 0);
+	}
+
+	size_t size() const										{ return m_size; }
+	size_t wordCount() const								{ return m_words.size(); }
+	std::uint64_t word(size_t index) const					{ return m_words[index]; }
+	std::uint64_t* words()									{ return m_words.data(); }
+	const std::uint64_t* words() const						{ return m_words.data(); }
+
+	void setAll() {
+		std::fill(m_words.begin(), m_words.end(), ~std::uint64_t{ 0 });
+		trimLastWord();
+	}
+	void clear()											{ std::fill(m_words.begin(), m_words.end(), 0); }
+
+	bool test(FilmId id) const								{ return (m_words[id / 64] >> (id % 64)) & 1; }
+	void set(FilmId id)										{ m_words[id / 64] |= std::uint64_t{ 1 } << (id % 64); }
+	void reset(FilmId id)									{ m_words[id / 64] &= ~(std::uint64_t{ 1 } << (id % 64)); }
+
+	size_t count() const {
+		size_t total{ 0 };
+		for (const auto word : m_words) {
+			total += std::popcount(word);
+		}
+		return total;
+	}
+	bool none() const {
+		for (const auto word : m_words) {
+			if (word) return false;
+		}
+		return true;
+	}
+
+	// calls the function with the id of every selected film, in increasing order
+	template <typename Function>
+	void forEach(Function function) const {
+		for (size_t index{ 0 }; index < m_words.size(); ++index) {
+			for (std::uint64_t word{ m_words[index] }; word; word &= word - 1) {
+				function(static_cast<FilmId>(index * 64 + std::countr_zero(word)));
+			}
+		}
+	}
+
+	void swap(FilmBitmap& other) {
+		m_words.swap(other.m_words);
+		std::swap(m_size, other.m_size);
+	}
+};
@@ -0,0 +1,204 @@
+#include "filmcatalog.h"
+#include "film.h"
+#include "taskscheduler.h"
+#include "resultorder.h"
+#include "profiler.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <unordered_set>
+
+namespace {
+	std::string lowercase(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+		return text;
+	}
+
+	// the title order: ignoring case, punctuation and a leading article (the collation keys), then by the titles as they are
+	bool titleBefore(const std::string& keyA, const Film* a, const std::string& keyB, const Film* b)
+	{
+		return keyA != keyB ? keyA < keyB : a->getTitle() < b->getTitle();
+	}
+
+	// the whole cast in one string, in billing order, for searching through
+	std::string joinCast(const std::vector<CastMember>& cast)
+	{
+		std::string joined;
+		for (const auto& member : cast) {
+			if (!joined.empty()) {
+				joined += ",  ";
+			}
+			joined += member.name;
+		}
+		return joined;
+	}
+}
+
+void FilmCatalog::build(std::vector<std::shared_ptr<Film>> films)
+{
+	/* ordering the films by title, so that the same films always get the same ids, and so that the order of the ids is
+	 * the title order results are shown in: ignoring case, punctuation and a leading article */
+	std::vector<std::pair<std::string, std::shared_ptr<Film>>> byTitle;
+	byTitle.reserve(films.size());
+	for (std::shared_ptr<Film>& film : films) {
+		std::string key{ collationKey(film->getTitle(), true) };
+		byTitle.emplace_back(std::move(key), std::move(film));
+	}
+	std::sort(byTitle.begin(), byTitle.end(), [](const auto& a, const auto& b) {
+		return titleBefore(a.first, a.second.get(), b.first, b.second.get());
+	});
+	m_films.clear();
+	m_films.reserve(byTitle.size());
+	for (auto& [key, film] : byTitle) {
+		m_films.push_back(std::move(film));
+	}
+
+	// every film fills in its own row of the presized columns, so the rows can be built on the scheduler's workers
+	const size_t count{ m_films.size() };
+	m_years.assign(count, 0);
+	m_genres.assign(count, 0);
+	m_titles.assign(count, {});
+	m_directors.assign(count, {});
+	m_casts.assign(count, {});
+
+	// the cast and description of every film are read out of its cold segment once, for the columns and the indexes
+	std::vector<FilmDetails> details(count);
+	TaskScheduler::getInstance()->parallelFor(0, count, CATALOG_BUILD_GRAIN, [this, &details](size_t first, size_t last) {
+		for (size_t id{ first }; id < last; ++id) {
+			const Film* film{ m_films[id].get() };
+			details[id] = film->readDetails();
+			m_years[id] = film->getReleaseYear();
+			m_genres[id] = film->getGenreBits();
+			m_titles[id] = lowercase(film->getTitle());
+			m_directors[id] = lowercase(film->getDirector());
+			m_casts[id] = lowercase(joinCast(details[id].cast));
+		}
+	});
+	buildSortKeys(m_years, m_directors, m_yearKeys, m_directorKeys);
+
+	std::vector<FilmCredits> credits;
+	credits.reserve(count);
+	for (FilmId id{ 0 }; id < count; ++id) {
+		credits.push_back({ &m_films[id]->getDirector(), &details[id].cast });
+	}
+	m_people.build(credits);
+	m_collaborations.build(m_people);
+
+	std::vector<std::string_view> descriptions;
+	descriptions.reserve(count);
+	for (const FilmDetails& film : details) {
+		descriptions.push_back(film.description);
+	}
+	m_similarity.build(view(), descriptions);
+	++m_version;
+}
+
+void FilmCatalog::update(const FilmCatalog& previous, std::span<const std::shared_ptr<Film>> added, std::span<const Film* const> removed)
+{
+	PROFILE_SCOPE("FilmCatalog::update");
+
+	/* where every film goes: the ones that stay keep their order, and each added one goes where its title sorts among
+	 * them, found by a binary search (so only the titles it passes on the way are collated) */
+	const std::unordered_set<const Film*> gone(removed.begin(), removed.end());
+	const std::vector<std::shared_ptr<Film>>& before{ previous.m_films };
+	std::vector<FilmId> staying;
+	staying.reserve(before.size());
+	for (FilmId id{ 0 }; id < before.size(); ++id) {
+		if (!gone.contains(before[id].get())) {
+			staying.push_back(id);
+		}
+	}
+	struct Arrival {
+		std::string key;
+		size_t index;						// in added
+		size_t position;					// how many of the films that stay come before it
+	};
+	std::vector<Arrival> arrivals;
+	arrivals.reserve(added.size());
+	for (size_t index{ 0 }; index < added.size(); ++index) {
+		arrivals.push_back({ collationKey(added[index]->getTitle(), true), index, 0 });
+	}
+	std::sort(arrivals.begin(), arrivals.end(), [&added](const Arrival& a, const Arrival& b) {
+		return titleBefore(a.key, added[a.index].get(), b.key, added[b.index].get());
+	});
+	for (Arrival& arrival : arrivals) {
+		auto at{ std::partition_point(staying.begin(), staying.end(), [&](FilmId id) {
+			return titleBefore(collationKey(before[id]->getTitle(), true), before[id].get(), arrival.key, added[arrival.index].get());
+		}) };
+		arrival.position = static_cast<size_t>(at - staying.begin());
+	}
+
+	FilmRemap remap;
+	remap.oldToNew.assign(before.size(), c_noFilm);
+	remap.added.assign(added.size(), c_noFilm);
+	m_films.clear();
+	m_films.reserve(staying.size() + added.size());
+	for (size_t stay{ 0 }, arrival{ 0 }; stay < staying.size() || arrival < arrivals.size();) {
+		const FilmId id{ static_cast<FilmId>(m_films.size()) };
+		if (arrival < arrivals.size() && arrivals[arrival].position == stay) {
+			remap.added[arrivals[arrival].index] = id;
+			remap.newToOld.push_back(c_noFilm);
+			m_films.push_back(added[arrivals[arrival++].index]);
+		}
+		else {
+			remap.oldToNew[staying[stay]] = id;
+			remap.newToOld.push_back(staying[stay]);
+			m_films.push_back(before[staying[stay++]]);
+		}
+	}
+
+	// the rows of the films that stay are copied, those of the added ones worked out like build() does
+	const size_t count{ m_films.size() };
+	m_years.assign(count, 0);
+	m_genres.assign(count, 0);
+	m_titles.assign(count, {});
+	m_directors.assign(count, {});
+	m_casts.assign(count, {});
+	TaskScheduler::getInstance()->parallelFor(0, count, CATALOG_BUILD_GRAIN, [&](size_t first, size_t last) {
+		for (size_t id{ first }; id < last; ++id) {
+			const FilmId old{ remap.newToOld[id] };
+			if (old != c_noFilm) {
+				m_years[id] = previous.m_years[old];
+				m_genres[id] = previous.m_genres[old];
+				m_titles[id] = previous.m_titles[old];
+				m_directors[id] = previous.m_directors[old];
+				m_casts[id] = previous.m_casts[old];
+				continue;
+			}
+			const Film* film{ m_films[id].get() };
+			m_years[id] = film->getReleaseYear();
+			m_genres[id] = film->getGenreBits();
+			m_titles[id] = lowercase(film->getTitle());
+			m_directors[id] = lowercase(film->getDirector());
+		}
+	});
+	updateSortKeys(previous.m_directorKeys, previous.m_directors, remap, m_years, m_directors, m_yearKeys, m_directorKeys);
+
+	// only the added films' details are read out of their cold segments, for their casts and the indexes
+	std::vector<FilmDetails> details(added.size());
+	TaskScheduler::getInstance()->parallelFor(0, added.size(), CATALOG_BUILD_GRAIN, [&](size_t first, size_t last) {
+		for (size_t index{ first }; index < last; ++index) {
+			details[index] = added[index]->readDetails();
+			m_casts[remap.added[index]] = lowercase(joinCast(details[index].cast));
+		}
+	});
+
+	std::vector<FilmCredits> credits;
+	std::vector<std::string_view> descriptions;
+	credits.reserve(added.size());
+	descriptions.reserve(added.size());
+	for (size_t index{ 0 }; index < added.size(); ++index) {
+		credits.push_back({ &added[index]->getDirector(), &details[index].cast });
+		descriptions.push_back(details[index].description);
+	}
+	m_people.update(previous.m_people, remap, credits);
+	m_collaborations.update(previous.m_collaborations, previous.m_people, m_people, remap);
+	m_similarity.update(previous.m_similarity, remap, view(), descriptions);
+	m_version = previous.m_version + 1;
+}
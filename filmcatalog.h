@@ -0,0 +1,86 @@
+#pragma once
+#include "filmbitmap.h"
+#include "filmutil.h"
+#include "personindex.h"
+#include "collaborationgraph.h"
+#include "similarityindex.h"
+#include "filmremap.h"
+
+#include <string>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <memory>
+
+/* FilmCatalog: Every film of our browser, by FilmId, along with the columns searches filter on. Each column holds one
+ * field of every film, in FilmId order, in the form the filters compare against (the text columns are already
+ * lowercase), so a filter reads one contiguous array instead of chasing a Film* and copying its strings per film.
+ *
+ * Alongside the columns, it indexes the films by the people in them (a PersonIndex), for jumping to a filmography, and
+ * keeps who worked with whom (a CollaborationGraph), for finding the films people made together, and what every film
+ * is like (a SimilarityIndex), for finding more like it.
+ *
+ * A catalog is built once, from the films first read, and never changed after it has been published (see CatalogStore):
+ * when films are added or removed, a new catalog is made from the previous one by update() (see FilmUI::reloadCatalog()),
+ * which carries over everything it can: the rows of the films that stay are copied, and only those of the added films are
+ * worked out, and the same goes for each index. The films are shared between the catalogs that have them, so a film
+ * that stays isn't copied either. Every catalog gets a new version, so whatever was worked out from an older one
+ * (cached search results) can tell it is out of date. */
+
+// CatalogView: The read-only columns of the catalog, the one thing filters get to see of it
+struct CatalogView {
+	std::span<const unsigned int> years;
+	std::span<const unsigned short> genres;				// one bit per genre, see genreBit()
+	std::span<const std::string> titles;				// lowercase
+	std::span<const std::string> directors;				// lowercase
+	std::span<const std::string> casts;					// lowercase, the whole cast in one string
+
+	// the casts member by member, with their roles (see PersonIndex): casts[id] split up
+	std::span<const unsigned int> castOffsets;
+	std::span<const Credit> credits;
+	std::span<const std::string> people;				// lowercase, by PersonId
+
+	// the sort keys of the films (see resultorder.h)
+	std::span<const std::uint64_t> yearKeys;
+	std::span<const std::uint64_t> directorKeys;
+
+	size_t size() const										{ return years.size(); }
+};
+
+class FilmCatalog {
+private:
+	std::vector<std::shared_ptr<class Film>> m_films;
+
+	std::vector<unsigned int> m_years;
+	std::vector<unsigned short> m_genres;
+	std::vector<std::string> m_titles;
+	std::vector<std::string> m_directors;
+	std::vector<std::string> m_casts;
+	std::vector<std::uint64_t> m_yearKeys;
+	std::vector<std::uint64_t> m_directorKeys;
+	PersonIndex m_people;
+	CollaborationGraph m_collaborations;
+	SimilarityIndex m_similarity;
+
+	unsigned long long m_version{ 0 };
+
+public:
+	// (Re)builds the catalog and its columns from the given films
+	void build(std::vector<std::shared_ptr<class Film>> films);
+
+	// Builds the catalog the previous one becomes once films are added to it and removed from it. The films that stay keep
+	// their order.
+	void update(const FilmCatalog& previous, std::span<const std::shared_ptr<class Film>> added, std::span<const class Film* const> removed);
+
+	CatalogView view() const {
+		return { m_years, m_genres, m_titles, m_directors, m_casts, m_people.castOffsets(), m_people.credits(), m_people.searchNames(),
+			m_yearKeys, m_directorKeys };
+	}
+
+	size_t size() const										{ return m_films.size(); }
+	Film* film(FilmId id) const								{ return m_films[id].get(); }
+	const PersonIndex& people() const						{ return m_people; }
+	const CollaborationGraph& collaborations() const		{ return m_collaborations; }
+	const SimilarityIndex& similarity() const				{ return m_similarity; }
+	unsigned long long getVersion() const					{ return m_version; }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include "filmbitmap.h"
+
+#include <vector>
+
+/* FilmRemap: Where the films of a catalog went when some were added to it and some removed (see FilmCatalog::update()).
+ * FilmIds are in title order, so the films that stay keep the order they were in: their ids only shift down past the
+ * removed films and up past the added ones, and anything sorted by FilmId before is still sorted after remapping. That
+ * is what lets every index of the catalog be updated by carrying over what it had, instead of being built anew. */
+
+inline constexpr FilmId c_noFilm{ ~0u };
+
+struct FilmRemap {
+	std::vector<FilmId> oldToNew;			// by the old FilmId: the film's new id, or c_noFilm if it was removed
+	std::vector<FilmId> newToOld;			// by the new FilmId: the film's old id, or c_noFilm if it was added
+	std::vector<FilmId> added;				// the new ids of the added films, in the order they were given
+
+	size_t size() const										{ return newToOld.size(); }
+	bool isAdded(FilmId id) const							{ return newToOld[id] == c_noFilm; }
+};
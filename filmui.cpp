@@ -1,26 +1,46 @@
 #include "filmui.h"
-#include "widget.h"
-#include "textbutton.h"
-#include "texturebutton.h"
-#include "slider.h"
-#include "genrebutton.h"
-#include "textfield.h"
+#include "profiler.h"
+#include "widgetsystem.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filterplan.h"
 
 #include "film.h"
 #include "filmutil.h"
 #include "global.h"
 #include "util.h"
+#include "renderqueue.h"
+#include "postercache.h"
+#include "thumbnailcache.h"
+#include "inputmanager.h"
+#include "catalogfile.h"
+#include "taskscheduler.h"
 #include "graphics.h"
 
 #include <string>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
+#include <string_view>
+#include <memory>
+#include <thread>
+#include <chrono>
 
 // called upon initialisation of the instance
 void FilmUI::init()
 {
-	graphics::preloadBitmaps(ASSET_PATH);
+	// not preloading the assets folder anymore: posters are loaded in the background by the PosterCache as they are needed,
+	// using the thumbnails baked by "FilmGUI --bake-thumbnails" wherever there are any
+	ThumbnailCache* thumbnails{ ThumbnailCache::getInstance() };
+	thumbnails->load();
+	thumbnails->setHiDpi(WINDOW_WIDTH >= 1.5f * CANVAS_WIDTH);
 	initialiseFilms();
+	m_catalog = m_store.acquire();
+	m_allFilms.resize(m_catalog->size());
+	m_allFilms.setAll();
+	m_search.start();
+	m_catalogWatcher.start(static_cast<std::string>(ASSET_PATH) + CATALOG_FILE);
+	showAllFilms();
 	calculateYearBounds();
 	initialiseWidgets();
 	setFont("Montserrat-Medium.ttf");
@@ -29,49 +49,64 @@ void FilmUI::init()
 // called whenever we go from main menu to search screen
 void FilmUI::initialiseSearchScreen()
 {
+	PROFILE_SCOPE("FilmUI::initialiseSearchScreen");
 	resetBrush();
 	m_state = FilmUIState::SEARCH_SCREEN;
-	m_currentWidgets.clear();
 	
 	/* The way filtering works: m_current_films serves as a temporary container that will have all the films in our database.
 	 * When we apply any filter (e.g. by clicking on a genre button), that widget is responsible of handling the entire
 	 * m_current_films container, and removing any films that do not fit its filter.*/
-	m_currentFilms = m_films;
-
-	// pushing back the undo button, the 2 sliders, the 10 genre buttons and the 3 textfields
-	for (unsigned int i{ 2 }; i < 20; ++i) {
-		m_currentWidgets.push_back(m_widgets[i]);
-	}
+	showAllFilms();
+	m_ui.setScreen(m_searchScreen);
 }
 
 void FilmUI::initialiseSearchResults()
 {
+	PROFILE_SCOPE("FilmUI::initialiseSearchResults");
 	resetBrush();
 	m_state = FilmUIState::SEARCH_RESULTS;
-	for (auto& widget : m_currentWidgets) {
-		if (widget->canFilter()) {
-			widget->filter(m_currentFilms);
-		}
-	}
-	m_currentWidgets.clear();
-	m_currentWidgets.push_back(m_widgets[2]);
+	FilterPlan plan;
+	m_ui.addToPlan(plan);
+	search(plan, false);
+	m_ui.setScreen(m_resultsScreen);
 }
 
 // called when we click "close" on the search screen
 void FilmUI::returnToMainMenu()
 {
+	PROFILE_SCOPE("FilmUI::returnToMainMenu");
 	resetBrush();
 	m_state = FilmUIState::MAIN_MENU;
-	for (auto& widget : m_currentWidgets) {
-		widget->resetState();
-	}
-	m_currentWidgets.clear();
-	m_currentWidgets.push_back(m_widgets[0]);		// pushing back the main menu textfield
-	m_currentWidgets.push_back(m_widgets[1]);		// pushing back the "advanced search" button
+	m_ui.resetScreen();
+	m_ui.setScreen(m_mainScreen);
+
+	// m_currentFilms holds the search results at this point, so forcing the main menu textfield to filter anew
+	FilterPlan plan;
+	m_ui.addToPlan(plan);
+	search(plan, false);
 }
 
 void FilmUI::draw()
 {
+	PROFILE_SCOPE("FilmUI::draw");
+
+	// every draw function below only queues its commands; they reach SGG, sorted and batched, on flush()
+	RenderQueue* renderQueue{ RenderQueue::getInstance() };
+
+	// if nothing has changed since the last frame, the commands we queued back then are still exactly what we want to draw.
+	// The profiler overlay changes every frame though, so while it is shown there is nothing to replay.
+	bool replay{ !m_dirty };
+#ifdef FILMGUI_PROFILE
+	replay = replay && !Profiler::getInstance()->isOverlayVisible();
+#endif
+	if (replay) {
+		renderQueue->replay();
+		return;
+	}
+
+	renderQueue->beginFrame();
+	PosterCache::getInstance()->beginFrame();
+
 	if (m_state == FilmUIState::MAIN_MENU) {
 		drawMainMenu();
 	}
@@ -81,10 +116,75 @@ void FilmUI::draw()
 	else {
 		drawSearchResults();
 	}
+	drawSearchProgress();
+
+#ifdef FILMGUI_PROFILE
+	Profiler::getInstance()->drawOverlay();
+#endif
+
+	renderQueue->flush();
+	m_dirty = false;
 }
 
 void FilmUI::update()
 {
+	// the one place we read the mouse and keyboard, once per frame
+	InputManager* input{ InputManager::getInstance() };
+	input->capture();
+
+#ifdef FILMGUI_PROFILE
+	// the start of update() is the start of a new frame, so closing the statistics of the last one before timing anything
+	Profiler::getInstance()->nextFrame();
+#endif
+	PROFILE_SCOPE("FilmUI::update");
+
+	// a poster finishing loading in the background changes what we draw just as much as input does, and so do the
+	// results of a search, or its progress
+	if (PosterCache::getInstance()->consumePosterReady()) {
+		m_dirty = true;
+	}
+	if (m_catalogWatcher.poll(graphics::getDeltaTime())) {
+		m_reloadPending = true;
+	}
+	if (m_reloadPending && !m_reloading) {
+		m_reloadPending = false;
+		reloadCatalog();
+	}
+	if (m_store.getVersion() != m_catalog->getVersion()) {
+		showNewestCatalog();
+	}
+	m_store.reclaim();
+	if (m_search.takeResult(m_currentFilms)) {
+		m_queryCache.insert(m_searching, m_catalog->getVersion(), m_currentFilms);
+		m_resultCount = m_currentFilms.count();
+
+		// the results are complete now, so the page is pulled from them instead, staying on the page the user is on
+		showResults(m_currentFilms);
+		m_dirty = true;
+	}
+	else if (m_search.isBusy()) {
+		m_dirty = true;
+	}
+
+	if (input->hasActivity()) {
+		m_idleTime = 0.0f;
+		m_dirty = true;
+	}
+	else {
+		m_idleTime += graphics::getDeltaTime();
+
+		// no input and nothing left to redraw: no widget or film can change, so there is nothing to update either
+		if (!m_dirty) {
+			if (m_idleMode && m_idleTime > IDLE_TIMEOUT) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_FRAME_TIME));
+			}
+			return;
+		}
+	}
+
+	m_ui.dispatchInput();
+	m_ui.update();
+
 	if (m_state == FilmUIState::MAIN_MENU) {
 		updateMainMenu();
 	}
@@ -98,118 +198,97 @@ void FilmUI::update()
 
 FilmUI::~FilmUI()
 {
-	for (auto& film : m_films) {
-		delete film;
-	}
-	for (auto& widget : m_widgets) {
-		delete widget;
-	}
-	m_films.clear();
-	m_widgets.clear();
-	m_currentFilms.clear();
-	m_currentWidgets.clear();
+	m_reloading.wait(true);
+	m_search.stop();
 }
 
 // used when in the main menu state
 void FilmUI::updateMainMenu()
 {
-
-	// if the textfield has filtered the current films, re-initialise them so that textfield filters them anew
-	if (m_currentFilms != m_films) {
-		m_currentFilms = m_films;
+	PROFILE_SCOPE("FilmUI::updateMainMenu");
+
+	/* if the text in the textfield has changed since we last filtered, filter again. Typing at the end of a query of plain
+	 * words can only narrow the results down, so then the films that matched before are the only ones worth checking.
+	 * Any other edit (or typing more of a year, a genre, or a word to leave out) can bring films back, so then we start
+	 * over from all the films. */
+	TextEdit edit;
+	TextField* searchField{ m_ui.getTextField(m_searchField) };
+	if (searchField && searchField->takeEdit(edit)) {
+		FilterPlan plan;
+		searchField->addToPlan(plan);
+		search(plan, edit.type == TextEditType::APPEND && searchField->appendNarrows());
 	}
 
-	// printing the current widgets
-	for (auto& widget : m_currentWidgets) {
-		widget->update();
-
-		// if we have clicked on the textfield and we have entered some text to it:
-		if (widget == m_widgets[0] && widget->canFilter()) {
-			widget->filter(m_currentFilms);
-		}
-
-		if (widget == m_widgets[1] && widget->isClicked()) {
-			widget->resetState();
-			initialiseSearchScreen();
-			break;
-		}
+	if (m_ui.isClicked(m_advancedSearchButton)) {
+		m_ui.resetState(m_advancedSearchButton);
+		initialiseSearchScreen();
 	}
 
+	updatePaging();
 	filmUpdate();
 }
 
 void FilmUI::updateSearchScreen()
 {
-	graphics::MouseState mouse;
-	graphics::getMouseState(mouse);
-
-	float mouse_x{ graphics::windowToCanvasX(static_cast<float>(mouse.cur_pos_x)) };
-	float mouse_y{ graphics::windowToCanvasY(static_cast<float>(mouse.cur_pos_y)) };
+	PROFILE_SCOPE("FilmUI::updateSearchScreen");
 
-	for (auto& widget : m_currentWidgets) {
-		widget->update();
-		// if we click on the undo button, reset its state, and go back to MAIN_MENU state
-		if (widget == m_widgets[2] && widget->isClicked()) {
-			widget->resetState();
-			returnToMainMenu();
-			break;
-		}
+	// if we click on the undo button, reset its state, and go back to MAIN_MENU state
+	if (m_ui.isClicked(m_backButton)) {
+		m_ui.resetState(m_backButton);
+		returnToMainMenu();
+	}
 
-		// if we click on "Apply Filters", move to the SEARCH_RESULTS state
-		if (widget == m_widgets[15] && widget->isClicked()) {
-			widget->resetState();
-			initialiseSearchResults();
-			break;
-		}
+	// if we click on "Apply Filters", move to the SEARCH_RESULTS state
+	else if (m_ui.isClicked(m_applyButton)) {
+		m_ui.resetState(m_applyButton);
+		initialiseSearchResults();
+	}
 
-		// if we click on "Clear Filters", reset the state of all gadgets, and reset the unordered_set of current films
-		if (widget == m_widgets[16] && widget->isClicked()) {
-			for (auto& currWidget : m_currentWidgets) {
-				currWidget->resetState();
-			}
-			m_currentFilms = m_films;
-		}
+	// if we click on "Clear Filters", reset the state of all gadgets, and reset the unordered_set of current films
+	else if (m_ui.isClicked(m_clearButton)) {
+		m_ui.resetScreen();
+		showAllFilms();
 	}
 }
 
 void FilmUI::updateSearchResults()
 {
+	PROFILE_SCOPE("FilmUI::updateSearchResults");
 	// same thing as in updateMainMenu() in regards to films
+	updatePaging();
 	filmUpdate();
 
-	for (auto& widget : m_currentWidgets) {
-		widget->update();
-		// if we click on the undo button
-		if (widget == m_widgets[2] && widget->isClicked()) {
-			widget->resetState();
-			initialiseSearchScreen();
-			break;
-		}
+	// if we click on the undo button
+	if (m_ui.isClicked(m_backButton)) {
+		m_ui.resetState(m_backButton);
+		initialiseSearchScreen();
 	}
 }
 
 // the first "state" of our app, when we've just launched the app, or when we've clicked the close button on the advanced search screen
 void FilmUI::drawMainMenu()
 {
+	PROFILE_SCOPE("FilmUI::drawMainMenu");
 	// drawing the background 
 	setTexture(m_brush, "background.png");
 	m_brush.outline_opacity = 0.0f;
-	graphics::drawRect(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2, CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
+	queueRect(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2, CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
 
-	// drawing all our films, 2 rows of 5 columns
-	for (auto& film : m_currentFilms) {
-		film->draw();
-	}
+	// drawing the films of the current page, 2 rows of 5 columns
+	RenderQueue::getInstance()->nextLayer();
+	drawPage();
+	drawPageInfo();
+	drawSimilar();
 
-	for (auto& widget : m_currentWidgets) {
-		widget->draw();
-	}
+	RenderQueue::getInstance()->nextLayer();
+	m_ui.draw();
 
 	// drawing a background for the film info
+	RenderQueue::getInstance()->nextLayer();
 	SETCOLOUR(m_brush.fill_color, 0.1f, 0.1f, 0.1f);
 	m_brush.fill_opacity = 0.9f;
 	setTexture(m_brush, "");
-	graphics::drawRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.9f), CANVAS_WIDTH, canvasHeightOffset(0.43f), m_brush);
+	queueRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.9f), CANVAS_WIDTH, canvasHeightOffset(0.43f), m_brush);
 
 	resetBrush();
 	
@@ -218,10 +297,12 @@ void FilmUI::drawMainMenu()
 // the second "state" of our app, when we've clicked on "Advanced Search" on the main menu (or clicked on the back button on the results screen)
 void FilmUI::drawSearchScreen()
 {
+	PROFILE_SCOPE("FilmUI::drawSearchScreen");
 	// drawing the background,
 	setTexture(m_brush, "graphite2.png");
 	SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
-	graphics::drawRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.5f), CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
+	queueRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.5f), CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
+	RenderQueue::getInstance()->nextLayer();
 
 	// inside which will be a rectangle centered towards the middle, in which we will have the sliders to filter the year, the genre
 	// buttons, the textfields for title/"person" (aka director + actor filter), an "apply filters" button, and a "reset filters" button
@@ -231,21 +312,20 @@ void FilmUI::drawSearchScreen()
 	m_brush.outline_opacity = 0.25f;
 	SETCOLOUR(m_brush.outline_color, 0.5f, 0.5f, 0.5f);
 	m_brush.fill_opacity = 0.9f;
-	graphics::drawRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.5f), canvasWidthOffset(0.66f), canvasHeightOffset(0.66f), m_brush);
+	queueRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.5f), canvasWidthOffset(0.66f), canvasHeightOffset(0.66f), m_brush);
 
 	// "Genres", top left
 	setFont("Montserrat-Medium.ttf");
 	SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
 	m_brush.fill_opacity = 1.0f;
 	m_brush.outline_opacity = 0.0f;
-	graphics::drawText(canvasWidthOffset(0.18f), canvasHeightOffset(0.2f), 18, "Genres:", m_brush);
+	queueText(canvasWidthOffset(0.18f), canvasHeightOffset(0.2f), 18, "Genres:", m_brush);
 
 	// "Year", middle left
-	graphics::drawText(canvasWidthOffset(0.18f), canvasHeightOffset(0.575f), 18, "Year:", m_brush);
+	queueText(canvasWidthOffset(0.18f), canvasHeightOffset(0.575f), 18, "Year:", m_brush);
 
-	for (auto& widget : m_currentWidgets) {
-		widget->draw();
-	}
+	RenderQueue::getInstance()->nextLayer();
+	m_ui.draw();
 
 	resetBrush();
 }
@@ -253,41 +333,374 @@ void FilmUI::drawSearchScreen()
 // the third "state" of our app, when we've applied some filters and get the results back
 void FilmUI::drawSearchResults()
 {
+	PROFILE_SCOPE("FilmUI::drawSearchResults");
 
 	// drawing the background 
 	setTexture(m_brush, "background.png");
 	m_brush.outline_opacity = 0.0f;
-	graphics::drawRect(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2, CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
+	queueRect(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2, CANVAS_WIDTH, CANVAS_HEIGHT, m_brush);
 
-	// drawing all our films, 2 rows of 5 columns
-	for (auto& film : m_currentFilms) {
-		film->draw();
-	}
+	// drawing the films of the current page, 2 rows of 5 columns
+	RenderQueue::getInstance()->nextLayer();
+	drawPage();
+	drawPageInfo();
+	drawSimilar();
 
-	for (auto& widget : m_currentWidgets) {
-		widget->draw();
-	}
+	RenderQueue::getInstance()->nextLayer();
+	m_ui.draw();
 
 	// drawing a background for the film info
+	RenderQueue::getInstance()->nextLayer();
 	SETCOLOUR(m_brush.fill_color, 0.1f, 0.1f, 0.1f);
 	m_brush.fill_opacity = 0.9f;
 	setTexture(m_brush, "");
-	graphics::drawRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.9f), CANVAS_WIDTH, canvasHeightOffset(0.43f), m_brush);
+	queueRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.9f), CANVAS_WIDTH, canvasHeightOffset(0.43f), m_brush);
 
 	// if our search failed, drawing "No results found" on the screen.
-	if (m_currentFilms.size() == 0) {
+	RenderQueue::getInstance()->nextLayer();
+	if (m_matches.empty()) {
 		SETCOLOUR(m_brush.fill_color, 0.2f, 0.2f, 0.2f);
-		graphics::drawText(canvasWidthOffset(0.45f), canvasHeightOffset(0.5f), 30, "No Results Found.", m_brush);
+		queueText(canvasWidthOffset(0.45f), canvasHeightOffset(0.5f), 30, "No Results Found.", m_brush);
+	}
+	// else, for each film on the page, print their respective info.
+	else {
+		drawPage();
+	}
+	resetBrush();
+}
+
+void FilmUI::search(const FilterPlan& plan, bool refine)
+{
+	if (!plan.active) {
+		showAllFilms();
+		return;
+	}
+
+	m_page = 0;
+	m_people.clear();
+	m_plan.assign(plan);
+	QuerySignature signature{ QuerySignature::of(plan) };
+	if (m_queryCache.lookup(signature, m_catalog->getVersion(), m_currentFilms)) {
+		m_search.cancel();
+		m_resultCount = m_currentFilms.count();
+		showResults(m_currentFilms);
+		return;
+	}
+
+	/* while a search is running, the current results are those of an older one, which this one may not narrow down.
+	 * The first page is filtered right here, and m_search counts the rest in the background. m_currentFilms stays as it
+	 * is until its result comes in, so the cursor can search through it in the meantime. */
+	const FilmBitmap& base{ refine && !m_search.isBusy() ? m_currentFilms : m_allFilms };
+	m_search.submit(plan, base, m_catalog);
+	m_searching = std::move(signature);
+	browse(plan, base);
+}
+
+void FilmUI::showAllFilms()
+{
+	m_search.cancel();
+	m_currentFilms = m_allFilms;
+	m_resultCount = m_currentFilms.count();
+	m_page = 0;
+	m_people.clear();
+	m_plan.assign(FilterPlan{});
+	showResults(m_currentFilms);
+}
+
+void FilmUI::selectPerson(PersonId person, CreditKind kind, bool add, PersonQueryMode mode)
+{
+	if (!add) {
+		m_people.clear();
+	}
+	m_peopleMode = mode;
+	bool known{ false };
+	for (const PersonTerm& term : m_people) {
+		known = known || (term.person == person && term.kind == kind);
+	}
+	if (!known) {
+		m_people.push_back({ person, kind });
+	}
+	showPeople();
+}
+
+void FilmUI::showPeople()
+{
+	PROFILE_SCOPE("FilmUI::showPeople");
+	m_search.cancel();
+
+	// a single person's films are all of them, whatever they did in them; together, each counts as what they were clicked as
+	const PersonIndex& people{ m_catalog->people() };
+	if (m_people.size() == 1) {
+		const PersonTerm everything{ m_people[0].person, CreditKind::ANY };
+		runPersonQuery(people, m_catalog->collaborations(), { &everything, 1 }, PersonQueryMode::ALL, m_currentFilms);
+	}
+	else {
+		runPersonQuery(people, m_catalog->collaborations(), m_people, m_peopleMode, m_currentFilms);
+	}
+	m_resultCount = m_currentFilms.count();
+	m_page = 0;
+	m_plan.assign(FilterPlan{});
+	showResults(m_currentFilms);
+
+	m_peopleLabel = "Films of ";
+	if (m_people.size() == 1) {
+		m_peopleLabel += people.name(m_people[0].person);
+		std::vector<Collaborator> top;
+		m_catalog->collaborations().topCollaborators(m_people[0].person, 2, top);
+		for (size_t i{ 0 }; i < top.size(); ++i) {
+			m_peopleLabel += (i ? ", " : " (most often with ") + people.name(top[i].person);
+		}
+		if (!top.empty()) {
+			m_peopleLabel += ")";
+		}
+	}
+	else {
+		for (size_t i{ 0 }; i < m_people.size(); ++i) {
+			if (i) {
+				m_peopleLabel += m_peopleMode == PersonQueryMode::ALL ? " and " : " or ";
+			}
+			m_peopleLabel += people.name(m_people[i].person);
+			m_peopleLabel += m_people[i].kind == CreditKind::DIRECTED ? " (directing)" : " (acting)";
+		}
+	}
+
+	// the label has the room between the sort buttons and the page info, and is cut short if it doesn't fit in it
+	const size_t room{ static_cast<size_t>(canvasWidthOffset(0.37f) / (13 * INFO_CHARACTER_WIDTH)) };
+	if (m_peopleLabel.size() > room) {
+		m_peopleLabel.resize(room - 3);
+		m_peopleLabel += "...";
+	}
+}
+
+void FilmUI::browse(const FilterPlan& plan, const FilmBitmap& base)
+{
+	m_sorting = false;
+	m_results.reset(plan, m_catalog->view(), base);
+	m_matches.clear();
+	fillPage();
+}
+
+void FilmUI::showResults(const FilmBitmap& results)
+{
+	if (m_order == ResultOrder::TITLE) {
+		browse(FilterPlan{}, results);
+		return;
+	}
+	m_sorting = true;
+	m_sorter.reset(results, m_order, m_catalog->view(), m_plan.bind());
+	m_matches.clear();
+	fillPage();
+}
+
+void FilmUI::fillPage()
+{
+	PROFILE_SCOPE("FilmUI::fillPage");
+	const size_t wanted{ (m_page + 1) * RESULTS_PAGE_SIZE + 1 };
+	if (m_sorting) {
+		m_sorter.take(m_matches, wanted);
+	}
+	else if (m_matches.size() < wanted) {
+		m_results.pull(m_matches, wanted - m_matches.size());
+	}
+
+	// the results may have shrunk under the page we were on, in which case we go back to their last page
+	if (m_page * RESULTS_PAGE_SIZE >= m_matches.size()) {
+		m_page = m_matches.empty() ? 0 : (m_matches.size() - 1) / RESULTS_PAGE_SIZE;
+	}
+
+	/* laying the page out in 2 rows of 5 columns, in the order of the results. The columns leave the right of the screen
+	 * to the "More like this" strip (see drawSimilar()), and do so whether it is shown or not, so that clicking a film
+	 * never moves it out from under the mouse. */
+	const size_t first{ m_page * RESULTS_PAGE_SIZE };
+	const size_t last{ std::min(first + RESULTS_PAGE_SIZE, m_matches.size()) };
+	bool activeShown{ false };
+	for (size_t slot{ 0 }; first + slot < last; ++slot) {
+		Film* film{ m_catalog->film(m_matches[first + slot]) };
+		film->setPosX(canvasWidthOffset((slot % 5) * 0.15f + 0.09f));
+		film->setPosY(canvasHeightOffset(((slot / 5) / 3.0f) + 0.2f));
+		activeShown = activeShown || film == m_activeFilm;
+	}
+
+	// a film that has left the page can't stay clicked, or no other film could be clicked
+	if (m_activeFilm && !activeShown) {
+		m_activeFilm->setActive(false);
+		m_activeFilm = nullptr;
+	}
+	pageDetails();
+	m_dirty = true;
+}
+
+void FilmUI::updatePaging()
+{
+	if (m_ui.isClicked(m_previousPageButton)) {
+		m_ui.resetState(m_previousPageButton);
+		if (m_page > 0) {
+			--m_page;
+			fillPage();
+		}
+	}
+	else if (m_ui.isClicked(m_nextPageButton)) {
+		m_ui.resetState(m_nextPageButton);
+		if (m_matches.size() > (m_page + 1) * RESULTS_PAGE_SIZE) {
+			++m_page;
+			fillPage();
+		}
+	}
+
+	// a new order starts over from the first page. While a search is still running, its results get sorted when they come in.
+	for (unsigned int order{ 0 }; order < 4; ++order) {
+		if (!m_ui.isClicked(m_orderButtons[order])) {
+			continue;
+		}
+		m_ui.resetState(m_orderButtons[order]);
+		if (m_order != static_cast<ResultOrder>(order)) {
+			m_order = static_cast<ResultOrder>(order);
+			m_page = 0;
+			if (!m_search.isBusy()) {
+				showResults(m_currentFilms);
+			}
+		}
+	}
+}
+
+void FilmUI::drawPage()
+{
+	const size_t first{ m_page * RESULTS_PAGE_SIZE };
+	const size_t last{ std::min(first + RESULTS_PAGE_SIZE, m_matches.size()) };
+	for (size_t i{ first }; i < last; ++i) {
+		m_catalog->film(m_matches[i])->draw();
+	}
+}
+
+void FilmUI::drawPageInfo()
+{
+	// the number of pages is only known once m_search has counted the results; until then, only the page we're on
+	char text[64];
+	if (m_search.isBusy()) {
+		std::snprintf(text, sizeof(text), "Page %zu, counting...", m_page + 1);
 	}
-	// else, for each film that was returned, print their respective info.
 	else {
-		for (auto& film : m_currentFilms) {
-			film->draw();
+		size_t pages{ std::max<size_t>((m_resultCount + RESULTS_PAGE_SIZE - 1) / RESULTS_PAGE_SIZE, 1) };
+		std::snprintf(text, sizeof(text), "Page %zu of %zu, %zu film%s by %s", m_page + 1, pages, m_resultCount,
+			m_resultCount == 1 ? "" : "s", orderName(m_order));
+	}
+
+	// whose films they are, between the sort buttons and the page info
+	if (!m_people.empty()) {
+		setFont("Montserrat-MediumItalic.ttf");
+		SETCOLOUR(m_brush.fill_color, 0.0f, 0.0f, 0.0f);
+		queueText(canvasWidthOffset(0.28f), canvasHeightOffset(0.672f), 13, m_peopleLabel, m_brush);
+	}
+	setFont("Montserrat-Medium.ttf");
+	SETCOLOUR(m_brush.fill_color, 0.0f, 0.0f, 0.0f);
+	m_brush.fill_opacity = 1.0f;
+	queueText(canvasWidthOffset(0.66f), canvasHeightOffset(0.672f), 13, text, m_brush);
+	resetBrush();
+}
+
+void FilmUI::updateSimilar()
+{
+	if (m_activeFilm == m_similarTo) {
+		return;
+	}
+	m_similarTo = m_activeFilm;
+	m_similar.clear();
+
+	// the active film is always one of the page, which is where its id is
+	const size_t first{ m_page * RESULTS_PAGE_SIZE };
+	const size_t last{ std::min(first + RESULTS_PAGE_SIZE, m_matches.size()) };
+	for (size_t i{ first }; m_activeFilm && i < last; ++i) {
+		if (m_catalog->film(m_matches[i]) == m_activeFilm) {
+			m_catalog->similarity().similarTo(m_matches[i], SIMILAR_FILMS, m_similar);
 		}
 	}
+	pageDetails();
+}
+
+void FilmUI::pageDetails()
+{
+	PROFILE_SCOPE("FilmUI::pageDetails");
+	std::vector<Film*> shown;
+	const size_t first{ m_page * RESULTS_PAGE_SIZE };
+	const size_t last{ std::min(first + RESULTS_PAGE_SIZE, m_matches.size()) };
+	for (size_t i{ first }; i < last; ++i) {
+		shown.push_back(m_catalog->film(m_matches[i]));
+	}
+	for (const FilmId id : m_similar) {
+		shown.push_back(m_catalog->film(id));
+	}
+
+	// the films that may still be drawn keep their details (they are only read when they are), the others let go of them
+	std::sort(shown.begin(), shown.end());
+	for (Film* film : m_paged) {
+		if (!std::binary_search(shown.begin(), shown.end(), film)) {
+			film->releaseDetails();
+		}
+	}
+	m_paged = std::move(shown);
+}
+
+void FilmUI::drawSimilar()
+{
+	if (!m_activeFilm || m_similarTo != m_activeFilm || m_similar.empty()) {
+		return;
+	}
+
+	setFont("Montserrat-Medium.ttf");
+	SETCOLOUR(m_brush.fill_color, 0.0f, 0.0f, 0.0f);
+	m_brush.fill_opacity = 1.0f;
+	queueText(canvasWidthOffset(0.77f), canvasHeightOffset(0.14f), 16, "More like this", m_brush);
+
+	// a small poster per film, with its title, year and director next to it
+	for (size_t i{ 0 }; i < m_similar.size(); ++i) {
+		Film* film{ m_catalog->film(m_similar[i]) };
+		const float y{ canvasHeightOffset(0.22f + i * 0.12f) };
+		film->drawPoster(canvasWidthOffset(0.79f), y, POSTER_WIDTH * 0.4f, POSTER_HEIGHT * 0.4f);
+
+		std::string title{ film->getTitle() };
+		if (title.size() > 24) {
+			title.resize(21);
+			title += "...";
+		}
+		setFont("Montserrat-Medium.ttf");
+		SETCOLOUR(m_brush.fill_color, 0.0f, 0.0f, 0.0f);
+		queueText(canvasWidthOffset(0.82f), y - 4.0f, 13, title, m_brush);
+		setFont("Montserrat-MediumItalic.ttf");
+		SETCOLOUR(m_brush.fill_color, 0.3f, 0.3f, 0.3f);
+		queueText(canvasWidthOffset(0.82f), y + 12.0f, 11, std::to_string(film->getReleaseYear()) + ", " + film->getDirector(), m_brush);
+	}
+	resetBrush();
+}
+
+void FilmUI::drawSearchProgress()
+{
+	if (!m_search.isBusy()) {
+		return;
+	}
+
+	// a thin bar at the top of the screen, filling up as the search goes through the films
+	RenderQueue::getInstance()->nextLayer();
+	setTexture(m_brush, "");
+	m_brush.outline_opacity = 0.0f;
+	m_brush.fill_opacity = 0.8f;
+	SETCOLOUR(m_brush.fill_color, 0.2f, 0.2f, 0.2f);
+	queueRect(canvasWidthOffset(0.5f), canvasHeightOffset(0.005f), CANVAS_WIDTH, canvasHeightOffset(0.01f), m_brush);
+
+	float progress{ m_search.getProgress() };
+	SETCOLOUR(m_brush.fill_color, 1.0f, 0.9f, 0.2f);
+	queueRect(CANVAS_WIDTH * progress / 2.0f, canvasHeightOffset(0.005f), CANVAS_WIDTH * progress, canvasHeightOffset(0.01f), m_brush);
+
+	SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
+	m_brush.fill_opacity = 1.0f;
+	queueText(canvasWidthOffset(0.01f), canvasHeightOffset(0.04f), 14, "Searching...", m_brush);
 	resetBrush();
 }
 
+void FilmUI::setIdleMode(bool idleMode)
+{
+	m_idleMode = idleMode;
+}
+
 // resets FilmUI's brush member variable
 void FilmUI::resetBrush()
 {
@@ -303,12 +716,12 @@ void FilmUI::calculateYearBounds()
 {
 	// minYear is initialised at 10000, maxYear is initialised at 0
 
-	for (auto& film : m_films) {
-		if (film->getReleaseYear() < m_minYear) {
-			m_minYear = film->getReleaseYear();
+	for (const unsigned int year : m_catalog->view().years) {
+		if (year < m_minYear) {
+			m_minYear = year;
 		}
-		if (film->getReleaseYear() > m_maxYear) {
-			m_maxYear = film->getReleaseYear();
+		if (year > m_maxYear) {
+			m_maxYear = year;
 		}
 	}
 }
@@ -316,12 +729,30 @@ void FilmUI::calculateYearBounds()
 // Used during updates in the MAIN_MENU and SEARCH_RESULTS states. Handles the films and the way they update.
 void FilmUI::filmUpdate()
 {
-	graphics::MouseState mouse;
-	graphics::getMouseState(mouse);
-	float mouse_x{ graphics::windowToCanvasX(static_cast<float>(mouse.cur_pos_x)) };
-	float mouse_y{ graphics::windowToCanvasY(static_cast<float>(mouse.cur_pos_y)) };
+	PROFILE_SCOPE("FilmUI::filmUpdate");
+	const InputSnapshot& input{ InputManager::getInstance()->getSnapshot() };
+	float mouse_x{ input.mouseX };
+	float mouse_y{ input.mouseY };
+
+	/* the names in the info panel of the clicked film can be clicked too, showing that person's films, or with Ctrl or
+	 * Shift held, the films they made with the people clicked before or those of any of them. Since that changes the
+	 * page, there's nothing left to do with the films of this one. */
+	if (m_activeFilm) {
+		const std::string* person{ m_activeFilm->personAt(mouse_x, mouse_y) };
+		m_activeFilm->setHoveredPerson(person);
+		if (person && input.leftPressed) {
+			m_activeFilm->setHoveredPerson(nullptr);
+			CreditKind kind{ person == &m_activeFilm->getDirector() ? CreditKind::DIRECTED : CreditKind::ACTED };
+			selectPerson(m_catalog->people().find(*person), kind, input.ctrl || input.shift,
+				input.shift ? PersonQueryMode::ANY : PersonQueryMode::ALL);
+			return;
+		}
+	}
 
-	for (auto& film : m_currentFilms) {
+	const size_t first{ m_page * RESULTS_PAGE_SIZE };
+	const size_t last{ std::min(first + RESULTS_PAGE_SIZE, m_matches.size()) };
+	for (size_t i{ first }; i < last; ++i) {
+		Film* film{ m_catalog->film(m_matches[i]) };
 		film->update();
 		film->setHighlighted(film->contains(mouse_x, mouse_y));
 
@@ -329,19 +760,20 @@ void FilmUI::filmUpdate()
 		 *  any film we hover on will have its info displayed at the bottom of the screen. If a film has been clicked
 		 *  (so m_activeFilm!=nullptr), only the highlighted film will have its info shown at the bottom of the screen */
 		if (!m_activeFilm) {
-			if (film->isHighlighted() && mouse.button_left_pressed) {
+			if (film->isHighlighted() && input.leftPressed) {
 				m_activeFilm = film;
 				film->setActive(true);
 			}
 		}
 		else {
 			// if we have already selected a film and we click anywhere else on the screen, we go back to the previous state
-			if (m_activeFilm == film && !(film->contains(mouse_x, mouse_y)) && mouse.button_left_pressed) {
+			if (m_activeFilm == film && !(film->contains(mouse_x, mouse_y)) && input.leftPressed) {
 				m_activeFilm = nullptr;
 				film->setActive(false);
 
-				// if the coordinates we've clicked on belong to any  other film, make that film active
-				for (auto& otherFilm : m_films) {
+				// if the coordinates we've clicked on belong to any other film of the page, make that film active
+				for (size_t other{ first }; other < last; ++other) {
+					Film* otherFilm{ m_catalog->film(m_matches[other]) };
 					if (otherFilm->contains(mouse_x, mouse_y)) {
 						m_activeFilm = otherFilm;
 						otherFilm->setActive(true);
@@ -350,6 +782,7 @@ void FilmUI::filmUpdate()
 			}
 		}
 	}
+	updateSimilar();
 }
 
 FilmUI* FilmUI::getInstance()
@@ -368,264 +801,126 @@ void FilmUI::releaseInstance()
 	m_instance = nullptr;
 }
 
-// lengthy initialisation, initialises all widgets
+// loads every widget from the layout file. The sliders go from the oldest to the newest film, so the year bounds have to be known by now.
 void FilmUI::initialiseWidgets()
 {
-	// m_widgets represents all the widgets in our application. m_currentWidgets represents the widgets in our current app
-	// state (MAIN_MENU, SEARCH_SCREEN and SEARCH_RESULTS respectively). Initialised with the main menu widgets.
-
-	// reserving 25 spots for both m_widgets and m_currentWidgets, since we have 19 widgets and resizing is relatively expensive
-	m_widgets.reserve(25);
-	m_currentWidgets.reserve(25);
-
-	// main menu textfield - widget[0]
-	TextField* mainMenuTextfield{ new TextField{canvasWidthOffset(0.75f), canvasHeightOffset(0.04f), 220, 30, TextfieldUseage::GENERAL}};
-	m_widgets.push_back(mainMenuTextfield);
-	m_currentWidgets.push_back(mainMenuTextfield);
-
-	// advanced search button - widgets[1]
-	// in main menu widgets, not in search screen widgets, in search result widgets
-	TextButton* adv{ new TextButton{canvasWidthOffset(0.906f), canvasHeightOffset(0.047f), 140, 25, "Advanced Search", TextButtonUseage::ADVANCED_SEARCH}};
-	m_widgets.push_back(adv);
-	m_currentWidgets.push_back(adv);
-
-	// undo button - widgets[2]
-	// not in main menu widgets, in search screen widgets, in search result widgets
-	TextureButton* undo{ new TextureButton{canvasWidthOffset(0.96f), canvasHeightOffset(0.05f), 30, 30, "undo.png", TextureButtonUseage::DEFAULT} };
-	m_widgets.push_back(undo);
-	
-	// slider1 & slider2 - widgets[3] & widgets[4]
-	// not in main menu widgets, in search screen widgets, not in search result widgets
-	Slider* slider1{ new Slider{canvasWidthOffset(0.375f), canvasHeightOffset(0.675f), 18, 42, m_minYear, m_maxYear, SliderUseage::LOWER_BOUND} };
-	Slider* slider2{ new Slider{canvasWidthOffset(0.375f), canvasHeightOffset(0.75f), 18, 42, m_minYear, m_maxYear, SliderUseage::UPPER_BOUND} };
-	m_widgets.push_back(slider1);
-	m_widgets.push_back(slider2);
-
-
-	// the 10 genre buttons - widgets[5]-widgets[14]
-	// not in main menu widgets, in search screen widgets, not in search result widgets
-
-	// previousUpperBound: Using a custom variable to mark the previous GenreButton's rightmost x coordinate.
-	// All GenreButtons will have to be in the search screen's inner rectangle, therefore starting drawing them from canvasWidthOffset(0.18f)
-	float previousUpperBound { canvasWidthOffset(0.18f) };
-
-	// when we reach a certain position of the canvas width, we will be drawing the following GenreButtons
-	// slightly lower on the canvas (incrementing currentHeightOffset by 0.06f)
-	float currentHeightOffset { canvasHeightOffset(0.25f) };
-
-	for (const auto genre : genresToArray()) {
+	m_ui.load(static_cast<std::string>(ASSET_PATH) + LAYOUT_FILE, m_minYear, m_maxYear);
+
+	m_mainScreen = m_ui.findScreen("main");
+	m_searchScreen = m_ui.findScreen("search");
+	m_resultsScreen = m_ui.findScreen("results");
+
+	m_searchField = m_ui.find("search");
+	m_advancedSearchButton = m_ui.find("advancedSearch");
+	m_backButton = m_ui.find("back");
+	m_applyButton = m_ui.find("applyFilters");
+	m_clearButton = m_ui.find("clearFilters");
+	m_previousPageButton = m_ui.find("previousPage");
+	m_nextPageButton = m_ui.find("nextPage");
+	m_orderButtons[static_cast<unsigned int>(ResultOrder::TITLE)] = m_ui.find("sortTitle");
+	m_orderButtons[static_cast<unsigned int>(ResultOrder::YEAR)] = m_ui.find("sortYear");
+	m_orderButtons[static_cast<unsigned int>(ResultOrder::DIRECTOR)] = m_ui.find("sortDirector");
+	m_orderButtons[static_cast<unsigned int>(ResultOrder::RELEVANCE)] = m_ui.find("sortRelevance");
+
+	m_ui.setScreen(m_mainScreen);
+}
 
-		// calculating the width the current GenreButton will require
-		float currentWidth{ GenreButton::calculateWidth(genre) };
+namespace {
+	// reads the catalog file, and publishes a new version of the catalog if any of its films have changed
+	void reloadFromFile(CatalogStore& store)
+	{
+		PROFILE_SCOPE("reloadFromFile");
+		std::vector<FilmRecord> records;
+		if (!loadCatalogFile(static_cast<std::string>(ASSET_PATH) + CATALOG_FILE, records)) {
+			return;
+		}
 
-		// if drawing a GenreButton will not take us over our custom limit (canvasWidthOffset(0.5f)
-		if (previousUpperBound + currentWidth < canvasWidthOffset(0.5f)) {
-			GenreButton* genreButton{ new GenreButton{previousUpperBound + 10.0f + currentWidth * 0.5f, currentHeightOffset, 22.5f, genre} };
-			m_widgets.push_back(genreButton);
-			previousUpperBound = genreButton->getPosX() + genreButton->getWidth() / 2.0f;
+		// films are told apart by title: a film whose details changed is removed and added again
+		const CatalogRef current{ store.acquire() };
+		std::unordered_map<std::string_view, const Film*> byTitle;
+		for (FilmId id{ 0 }; id < current->size(); ++id) {
+			byTitle.emplace(current->film(id)->getTitle(), current->film(id));
 		}
-		// else, if drawing the GenreButton would take us over our custom limit, resetting previousUpperBound, incrementing currHeightOffset
-		else {
-			previousUpperBound = canvasWidthOffset(0.18f);
-			currentHeightOffset += canvasHeightOffset(0.06f);
-			GenreButton* genreButton{ new GenreButton{previousUpperBound + 10.0f + currentWidth * 0.5f, currentHeightOffset, 22.5f, genre} };
-			m_widgets.push_back(genreButton);
-			previousUpperBound = genreButton->getPosX() + genreButton->getWidth() / 2.0f;
+		std::vector<FilmRecord> changed;
+		std::unordered_set<const Film*> kept;
+		for (FilmRecord& record : records) {
+			const auto found{ byTitle.find(record.title) };
+			if (found != byTitle.end() && sameFilm(*found->second, record)) {
+				kept.insert(found->second);
+			}
+			else {
+				changed.push_back(std::move(record));
+			}
+		}
+		const std::vector<std::shared_ptr<Film>> added{ makeFilms(changed) };
+		std::vector<const Film*> removed;
+		for (FilmId id{ 0 }; id < current->size(); ++id) {
+			if (!kept.contains(current->film(id))) {
+				removed.push_back(current->film(id));
+			}
+		}
+		if (added.empty() && removed.empty()) {
+			return;
 		}
-	}
-
-	// apply filters button - widgets[15]
-	// not in main menu widgets, in search screen widgets, not in search result widgets
-
-	TextButton* apply{ new TextButton{canvasWidthOffset(0.7f), canvasHeightOffset(0.3f), 100, 25, "Apply Filters", TextButtonUseage::APPLY_FILTERS} };
-	m_widgets.push_back(apply);
 
-	// clear filters button - widgets[16]
-	// not in main menu widgets, in search screen widgets, not in search result widgets
+		FilmCatalog next;
+		next.update(*current, added, removed);
+		store.publish(std::move(next));
+	}
+}
 
-	TextButton* clear{ new TextButton{canvasWidthOffset(0.7f), canvasHeightOffset(0.36f), 100, 25, "Clear Filters", TextButtonUseage::CLEAR_FILTERS} };
-	m_widgets.push_back(clear);
+// the films come from the catalog file, so that they can be changed (even while we run) without touching the code
+void FilmUI::initialiseFilms()
+{
+	std::vector<FilmRecord> records;
+	loadCatalogFile(static_cast<std::string>(ASSET_PATH) + CATALOG_FILE, records);
+	FilmCatalog catalog;
+	catalog.build(makeFilms(records));
+	m_store.publish(std::move(catalog));
+}
 
-	// the three textfields (actor, director and title textfields) - widgets[17]-[19]
-	// not in main menu widgets, in search screen widgets, not in search result widgets
+void FilmUI::reloadCatalog()
+{
+	m_reloading = true;
+	TaskScheduler::getInstance()->submit([this]() {
+		reloadFromFile(m_store);
+		m_reloading = false;
+		m_reloading.notify_all();
+	});
+}
 
-	TextField* actorTextfield{ new TextField{canvasWidthOffset(0.7f), canvasHeightOffset(0.65f), 220, 30, TextfieldUseage::ACTOR} };
-	m_widgets.push_back(actorTextfield);
+void FilmUI::showNewestCatalog()
+{
+	PROFILE_SCOPE("FilmUI::showNewestCatalog");
+	if (m_activeFilm) {
+		m_activeFilm->setActive(false);
+		m_activeFilm = nullptr;
+	}
+	m_similarTo = nullptr;
+	m_similar.clear();
 
-	TextField* directorTextField{ new TextField(canvasWidthOffset(0.7f), canvasHeightOffset(0.71f), 220, 30, TextfieldUseage::DIRECTOR) };
-	m_widgets.push_back(directorTextField);
+	// the films of the version we showed so far may go with it, so nothing of theirs is kept paged in
+	for (Film* film : m_paged) {
+		film->releaseDetails();
+	}
+	m_paged.clear();
 
-	TextField* titleTextField{ new TextField{canvasWidthOffset(0.7f), canvasHeightOffset(0.77f), 220, 30, TextfieldUseage::TITLE} };
-	m_widgets.push_back(titleTextField);
-}
+	// the version we showed so far is held on to until the results have been worked out anew, since they still refer to it
+	const CatalogRef previous{ std::move(m_catalog) };
+	m_catalog = m_store.acquire();
+	m_allFilms.resize(m_catalog->size());
+	m_allFilms.setAll();
 
-// very lengthy initialisation, initialises 10 films with their respective titles and further info, feel free to ignore
-void FilmUI::initialiseFilms()
-{
-	std::string_view title{ "12 Angry Men" };
-	std::string_view director{ "Sidney Lumet" };
-	unsigned int releaseYear{ 1957 };
-	std::array<std::string, 5> cast;
-	cast[0] = "Henry Fonda";
-	cast[1] = "Lee J. Cobb";
-	cast[2] = "John Fiedler";
-	cast[3] = "Martin Balsalm";
-	cast[4] = "E.G.Marshall";
-	std::unordered_set<Genre> genres;
-	genres.insert(Genre::drama);
-	std::string_view description{"The defense and the prosecution have rested and the jury is filing into the jury room to decide if a young Spanish-American is guilty or innocent of murdering his father. What begins as an open and shut case soon becomes a mini-drama of each of the jurors' prejudices and preconceptions about the trial, the accused, and each other."};
-	std::string_view poster{ "12AngryMen.png" };
-	Film* film{ new Film{title, releaseYear, director, genres, cast, description, poster} };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Chungking Express";
-	director = "Wong Kar-Wai";
-	releaseYear = 1994;
-	cast[0] = "Brigitte Lin";
-	cast[1] = "Takeshi Kaneshiro";
-	cast[2] = "Tony Leung Chiu-Wai";
-	cast[3] = "Faye Wong";
-	cast[4] = "Valerie Chow";
-	genres.insert(Genre::comedy);
-	genres.insert(Genre::crime);
-	genres.insert(Genre::drama);
-	genres.insert(Genre::romance);
-	description = "Two melancholic Hong Kong policemen fall in love: one with a mysterious underworld figure, the other with a beautiful and ethereal server at a late-night restaurant he frequents.";
-	poster = "ChungkingExpress.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Eternal Sunshine of the Spotless Mind";
-	director = "Michel Gondry";
-	releaseYear = 2004;
-	cast[0] = "Jim Carrey";
-	cast[1] = "Kate Winslet";
-	cast[2] = "Kirsten Dunst";
-	cast[3] = "Mark Ruffalo";
-	cast[4] = "Elijah Wood";
-	genres.insert(Genre::drama);
-	genres.insert(Genre::romance);
-	description = "Joel Barish, heartbroken that his girlfriend underwent a procedure to erase him from her memory, decides to do the same. However, as he watches his memories of her fade away, he realises that he still loves her, and may be too late to correct his mistake.";
-	poster = "EternalSunshine.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Grave of the Fireflies";
-	director = "Isao Takahata";
-	releaseYear = 1988;
-	cast[0] = "Tsutomu Tatsumi";
-	cast[1] = "Ayano Siraishi";
-	cast[2] = "Yoshiko Shinohara";
-	cast[3] = "Akemi Yamaguchi";
-	cast[4] = "Masayo Sakai";
-	genres.insert(Genre::animation);
-	genres.insert(Genre::drama);
-	genres.insert(Genre::war);
-	description = "In the final months of World War II, 14-year-old Seita and his sister Setsuko are orphaned when their mother is killed during an air raid in Kobe, Japan. After a falling out with their aunt, they move into an abandoned bomb shelter. With no surviving relatives and their emergency rations depleted, Seita and Setsuko struggle to survive.";
-	poster = "GraveOfTheFireflies.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Memories of Murder";
-	director = "Bong Joon-ho";
-	releaseYear = 2003;
-	cast[0] = "Song Kang-ho";
-	cast[1] = "Kim Sang-kyung";
-	cast[2] = "Park No-shik";
-	cast[3] = "Byun Hee-bong";
-	cast[4] = "Kim Roe-ha";
-	genres.insert(Genre::mystery);
-	genres.insert(Genre::thriller);
-	description = "1986, Gyunggi Province. The body of a young woman is found brutally raped and murdered. Two months later, a series of rapes and murders commences under similar circumstances. A special task force is set up in the area, with two local detectives joined by a detective from Seoul who requested to be assigned to the case.";
-	poster = "MemoriesOfMurder.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Princess Mononoke";
-	director = "Hayao Miyazaki";
-	releaseYear = 1997;
-	cast[0] = "Yoji Matsuda";
-	cast[1] = "Yuriko Ishida";
-	cast[2] = "Akihiro Miwa";
-	cast[3] = "Yuko Tanaka";
-	cast[4] = "Sumi Shimamoto";
-	genres.insert(Genre::animation);
-	genres.insert(Genre::adventure);
-	genres.insert(Genre::drama);
-	genres.insert(Genre::war);
-	description = "Ashitaka, a prince of the disappearing Emishi people, is cursed by a demonized boar god and must journey to the west to find a cure. Along the way, he encounters San, a young human woman fighting to protect the forest, and Lady Eboshi, who is trying to destroy it. Ashitaka must find a way to bring balance to this conflict.";
-	poster = "PrincessMononoke.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Spirited Away";
-	director = "Hayao Miyazaki";
-	releaseYear = 2001;
-	cast[0] = "Rumi Hiiragi";
-	cast[1] = "Miyu Irino";
-	cast[2] = "Mari Natsuki";
-	cast[3] = "Yumi Tamai";
-	cast[4] = "Bunta Sagawara";
-	genres.insert(Genre::animation);
-	genres.insert(Genre::adventure);
-	description = "A young girl, Chihiro, becomes trapped in a strange new world of spirits. When her parents undergo a mysterious transformation, she must call upon the courage she never knew she had to free her family.";
-	poster = "SpiritedAway.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Night on Earth";
-	director = "Jim Jarmusch";
-	releaseYear = 1991;
-	cast[0] = "Winona Ryder";
-	cast[1] = "Gena Rowlands";
-	cast[2] = "Matti Pellonpaa";
-	cast[3] = "Giancarlo Esposito";
-	cast[4] = "Isaach De Bankole";
-	genres.insert(Genre::comedy);
-	genres.insert(Genre::drama);
-	description = "An anthology of 5 different cab drivers in 5 American and European cities and their remarkable fares on the same eventful night.";
-	poster = "NightOnEarth.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Se7en";
-	director = "David Fincher";
-	releaseYear = 1995;
-	cast[0] = "Brad Pitt";
-	cast[1] = "Morgan Freeman";
-	cast[2] = "Kevin Spacey";
-	cast[3] = "Gwyneth Paltrow";
-	cast[4] = "Emily Wagner";
-	genres.insert(Genre::crime);
-	genres.insert(Genre::mystery);
-	genres.insert(Genre::thriller);
-	description = "Two homicide detectives are on a desperate hunt for a serial killer whose crimes are based on the \"seven deadly sins\".The seasoned Det.Sommerset researches each sin in an effort to get inside the killer's mind, while his novice partner, Mills, scoffs at his efforts to unravel the case.";
-	poster = "Se7en.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-	genres.clear();
-
-	title = "Style Wars";
-	director = "Tony Silver";
-	releaseYear = 1983;
-	cast[0] = "Rammellzee";
-	cast[1] = "Ed Koch";
-	cast[2] = "DJ Kay Slay";
-	cast[3] = "Butch";
-	cast[4] = "Kase";
-	genres.insert(Genre::documentary);
-	description = "A documentary that exposes the rich growing subculture of hip-hop that was developing in New York City in the late '70s and early '80s, specifically focusing on graffiti art and breakdancing.";
-	poster = "StyleWars.png";
-	film = new Film{ title, releaseYear, director, genres, cast, description, poster };
-	m_films.insert(film);
-
-	m_currentFilms = m_films;
+	// whatever was being shown is shown again, out of the new films (PersonIds stay the same, so m_people still holds)
+	if (!m_people.empty()) {
+		showPeople();
+	}
+	else if (m_plan.plan.active) {
+		const OwnedFilterPlan current{ m_plan };
+		search(current.bind(), false);
+	}
+	else {
+		showAllFilms();
+	}
+	m_dirty = true;
 }
\ No newline at end of file
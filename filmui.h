@@ -1,20 +1,26 @@
 #pragma once
-#include "widget.h"
-#include "textbutton.h"
-#include "texturebutton.h"
-#include "slider.h"
-#include "genrebutton.h"
-#include "textfield.h"
+#include "widgetsystem.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filterplan.h"
+#include "searchworker.h"
+#include "querycache.h"
+#include "resultcursor.h"
+#include "resultorder.h"
+#include "catalogwatcher.h"
+#include "catalogstore.h"
 
 #include "film.h"
 #include "filmutil.h"
 #include "global.h"
 #include "util.h"
+#include "renderqueue.h"
 #include "graphics.h"
 
 #include <string>
 #include <vector>
 #include <unordered_set>
+#include <atomic>
 
 // FilmUI will be our main class. It will be the one responsible for all the films and widgets.
 
@@ -32,19 +38,77 @@ private:
 	unsigned int m_minYear{ 10000 };
 	unsigned int m_maxYear {0};
 
-	// m_films: All the films in our project
-	std::unordered_set<class Film*> m_films;
-
-	/* m_currentFilms: For the search results. Initially contains all the films in our project, but every "valid" widget
-	 * that accesses it (every widget that can filter at a set point of time), modifies its elements and removes the ones
-	 * that don't fit its filter. */
-	std::unordered_set<Film*> m_currentFilms;
-
-	// m_widgets: for all the widgets included in our project
-	std::vector<class Widget*> m_widgets;
-
-	// m_currentWidgets: for the widgets in the current screen ("state")
-	std::vector<Widget*> m_currentWidgets;
+	/* m_store: Every version of the catalog (all the films in our project, by FilmId, along with the columns the widgets
+	 * filter on) that is still in use. m_catalog is the version we show, which we move on from once a reload has
+	 * published a newer one. Declared first, so that the store goes after everything that refers to its versions. */
+	CatalogStore m_store;
+	CatalogRef m_catalog;
+
+	// m_reloading: Whether a reload of the catalog is running on the scheduler. m_reloadPending: one is due after it.
+	std::atomic<bool> m_reloading{ false };
+	bool m_reloadPending{ false };
+
+	/* m_currentFilms: For the search results. Initially selects all the films in our project; searches narrow it down to
+	 * the ones that fit what the widgets filter on. m_allFilms always selects every film. */
+	FilmBitmap m_currentFilms;
+	FilmBitmap m_allFilms;
+
+	// m_catalogWatcher: Tells us when the catalog file has changed, so the films can be reloaded without a restart
+	CatalogWatcher m_catalogWatcher;
+
+	// m_search: Runs the searches in the background, each on the version of the catalog it was submitted with
+	SearchWorker m_search;
+
+	// m_queryCache: The results of recent searches. m_searching is the signature of the search m_search is running, whose
+	// results get cached once they're in.
+	QueryCache m_queryCache;
+	QuerySignature m_searching;
+
+	/* m_results: The current results as a stream, pulled from only as far as the page being shown needs. m_matches is
+	 * what has been pulled so far, m_page the page of RESULTS_PAGE_SIZE films being shown. m_resultCount is the total
+	 * number of results, once m_search has counted them. */
+	ResultCursor m_results;
+	std::vector<FilmId> m_matches;
+	size_t m_page{ 0 };
+	size_t m_resultCount{ 0 };
+
+	/* m_order: The order the results are shown in. In title order they stream out of m_results; in any other, they can
+	 * only be sorted once they are complete, so until then they stream out in title order, and from then on they come
+	 * out of m_sorter (m_sorting). m_plan is the plan of the current results, for the relevance order. */
+	ResultOrder m_order{ ResultOrder::TITLE };
+	ResultSorter m_sorter;
+	bool m_sorting{ false };
+	OwnedFilterPlan m_plan;
+
+	/* m_people: Whose films the current results are, after clicking names in the info panel: one person's filmography,
+	 * or, with Ctrl held (m_peopleMode ALL) or Shift (ANY), the films of several of them together. Empty for any other
+	 * results. m_peopleLabel says who they are, along with whom a single person worked with most. */
+	std::vector<PersonTerm> m_people;
+	PersonQueryMode m_peopleMode{ PersonQueryMode::ALL };
+	std::string m_peopleLabel;
+
+	// m_similar: The films most like m_similarTo (the active film, as of the last update), for the "More like this" strip
+	std::vector<FilmId> m_similar;
+	Film* m_similarTo{ nullptr };
+
+	// m_paged: The films that may be drawn (those of the page and the strip), sorted, whose details may be paged in
+	std::vector<Film*> m_paged;
+
+	// m_ui: All the widgets included in our project, loaded from the layout file. Only the current screen's are updated/drawn.
+	WidgetSystem m_ui;
+
+	// the screens, one per state, and the widgets FilmUI itself reacts to, looked up by name once the layout has been loaded
+	unsigned int m_mainScreen{ 0 };
+	unsigned int m_searchScreen{ 0 };
+	unsigned int m_resultsScreen{ 0 };
+	WidgetId m_searchField;
+	WidgetId m_advancedSearchButton;
+	WidgetId m_backButton;
+	WidgetId m_applyButton;
+	WidgetId m_clearButton;
+	WidgetId m_previousPageButton;
+	WidgetId m_nextPageButton;
+	WidgetId m_orderButtons[4];				// by ResultOrder
 
 	// m_brush: FilmUI will have its own Brush member variable for drawing purposes
 	struct graphics::Brush m_brush;
@@ -52,6 +116,59 @@ private:
 	// m_activeFilm: Signifies the film we've clicked on
 	Film* m_activeFilm{ nullptr };
 
+	/* m_dirty: Set whenever something that affects what we draw may have changed (any input, a state transition etc.).
+	 * While it is false, update() skips all the widget/film work and draw() replays the commands of the previous frame. */
+	bool m_dirty{ true };
+
+	// m_idleTime: How long (in ms) it has been since the last input. m_idleMode: whether we throttle updates when idle.
+	float m_idleTime{ 0.0f };
+	bool m_idleMode{ false };
+
+	/* Hands a search to m_search; m_currentFilms keeps the previous results until it is done. With refine, only the films
+	 * of the current results are searched, which is only correct if the plan can only narrow them down further (and only
+	 * done if they are up to date). A plan that filters nothing selects every film right away, and so does a search whose
+	 * results are still in m_queryCache. */
+	void search(const FilterPlan& plan, bool refine);
+
+	// Selects every film without searching, dropping any search still running
+	void showAllFilms();
+
+	// Starts streaming the films of base that pass the plan into m_matches, and fills the current page from them
+	void browse(const FilterPlan& plan, const FilmBitmap& base);
+
+	// Adds a person clicked in the info panel (as a director or a cast member) to m_people, or starts m_people over with them
+	void selectPerson(PersonId person, CreditKind kind, bool add, PersonQueryMode mode);
+
+	/* Selects the films of m_people straight from the catalog's PersonIndex, dropping any search still running. Costs as
+	 * much as their filmographies are long (plus clearing the bitmap), instead of looking for their names in every cast. */
+	void showPeople();
+
+	// Shows results that are complete, in m_order
+	void showResults(const FilmBitmap& results);
+
+	// Pulls as many results as the current page needs (and one more, to know whether there is a next page), and lays the page out
+	void fillPage();
+
+	// Handles the previous/next page and the sort order buttons, in the states that show films
+	void updatePaging();
+
+	// Draws the films of the current page, with the page number and result count underneath
+	void drawPage();
+	void drawPageInfo();
+
+	// Looks up the films most like the active film, whenever a different one has become active
+	void updateSimilar();
+
+	// Releases the details of the films that can no longer be drawn (see Film::details()), so that only those of about a
+	// page of films are ever resident
+	void pageDetails();
+
+	// Draws the "More like this" strip of the active film, down the right of the films
+	void drawSimilar();
+
+	// While a search is running, draws how far along it is on top of everything else
+	void drawSearchProgress();
+
 	// called after every iteration of draw, resets our Brush member variable
 	void resetBrush();
 
@@ -79,10 +196,17 @@ private:
 	// Called when we go from the search screen to the search results
 	void initialiseSearchResults();
 
-	// Lengthy initialisation of all films, done outside init() for readability purposes
+	// Creates the films of the catalog file, and publishes the first version of the catalog with them
 	void initialiseFilms();
 
-	// Lengthy initialisation of all widgets, done outside init() for readability purposes
+	/* Reads the catalog file again on one of the scheduler's workers, and publishes a version of the catalog with films
+	 * added, changed and removed to match it (see FilmCatalog::update()). Until it is done, the current version is shown. */
+	void reloadCatalog();
+
+	// Moves on to the newest version of the catalog, searching for whatever was on screen again among its films
+	void showNewestCatalog();
+
+	// Loads the layout file and looks up the widgets FilmUI needs to know about
 	void initialiseWidgets();
 
 	FilmUI() = default;
@@ -92,6 +216,10 @@ public:
 	void draw();
 	void init();
 
+	/* Idle mode: Once there has been no input for IDLE_TIMEOUT ms, every update sleeps for IDLE_FRAME_TIME ms, lowering
+	 * the update rate (and our CPU use) until the next input. Meant for kiosks that show the browser all day. */
+	void setIdleMode(bool idleMode);
+
 	// To get the currently active instance of FilmUI
 	static FilmUI* getInstance();
 
@@ -4,6 +4,7 @@
 #include <utility>
 #include <vector>
 #include <array>
+#include <cctype>
 
 // serves as a "toString" for genres
 const std::string genreName(const Genre genre) {
@@ -45,3 +46,45 @@ const std::vector<std::string> descriptionTokenized(const std::string& descripti
 {
 	
 }*/
+
+unsigned int roleWeight(const Role role) {
+	switch (role) {
+	case Role::lead:
+		return 3;
+	case Role::supporting:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+std::vector<std::string> tokenize(const std::string& line)
+{
+	std::vector<std::string> tokens;
+	size_t i{ 0 };
+	while (i < line.size()) {
+		if (std::isspace(static_cast<unsigned char>(line[i]))) {
+			++i;
+		}
+		else if (line[i] == '#') {
+			break;
+		}
+		else if (line[i] == '"') {
+			size_t end{ line.find('"', i + 1) };
+			if (end == std::string::npos) {
+				end = line.size();
+			}
+			tokens.push_back(line.substr(i + 1, end - i - 1));
+			i = end + 1;
+		}
+		else {
+			size_t end{ i };
+			while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end]))) {
+				++end;
+			}
+			tokens.push_back(line.substr(i, end - i));
+			i = end;
+		}
+	}
+	return tokens;
+}
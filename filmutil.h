@@ -6,7 +6,8 @@
 #include <array>
 
 /* filmutil.h: Includes an enum class for the genres in our browser and many helper functions for said enum
- * class (like a function that returns the name of each genre and a function that returns all genres).	*/
+ * class (like a function that returns the name of each genre and a function that returns all genres), and the
+ * roles a film's cast members can have. */
 
 enum class Genre {
 	adventure,
@@ -25,4 +26,27 @@ enum class Genre {
 const std::string genreName(const Genre genre);		// Genre is an enum class, therefore it is cheaper to pass by value than by reference
 
 // provides us with an array including all genres. Utilised in the forEach loop in filmUI when creating genre buttons
-const std::array<Genre, 10> genresToArray();
\ No newline at end of file
+const std::array<Genre, 10> genresToArray();
+
+// the bit a genre has in a set of genres kept as one bit per genre (like a Film's, or the catalog's genres column)
+inline unsigned short genreBit(Genre genre)					{ return static_cast<unsigned short>(1u << static_cast<unsigned int>(genre)); }
+
+// the kind of part a cast member plays. Casts are listed in billing order, which mostly puts the leads first.
+enum class Role : unsigned char {
+	lead,
+	supporting,
+	extra,
+};
+
+// CastMember: one entry of a film's cast
+struct CastMember {
+	std::string name;
+	Role role;
+};
+
+// how much a search matching a cast member counts towards a film's relevance, depending on their role: leads the most
+unsigned int roleWeight(const Role role);
+
+// splits a line of a text file (the layout, the catalog) into its fields: whitespace separated, "double quoted" fields
+// may contain spaces, and everything after a # is a comment
+std::vector<std::string> tokenize(const std::string& line);
\ No newline at end of file
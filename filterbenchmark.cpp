@@ -0,0 +1,715 @@
+#include "filterbenchmark.h"
+#include "filterplan.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filmutil.h"
+#include "taskscheduler.h"
+#include "resultorder.h"
+#include "personindex.h"
+#include "collaborationgraph.h"
+#include "similarityindex.h"
+#include "queryparser.h"
+#include "filmremap.h"
+#include "catalogstore.h"
+#include "film.h"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <random>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <utility>
+#include <ranges>
+#include <thread>
+#include <memory>
+#include <unordered_set>
+
+namespace {
+	// SyntheticCatalog: the same columns as a FilmCatalog, filled with made up films
+	struct SyntheticCatalog {
+		std::vector<unsigned int> years;
+		std::vector<unsigned short> genres;
+		std::vector<std::string> titles;
+		std::vector<std::string> directors;
+		std::vector<std::string> casts;
+		std::vector<std::vector<CastMember>> castMembers;
+		std::vector<std::string> descriptions;
+		PersonIndex people;
+		std::vector<std::uint64_t> yearKeys;
+		std::vector<std::uint64_t> directorKeys;
+
+		CatalogView view() const {
+			return { years, genres, titles, directors, casts, people.castOffsets(), people.credits(), people.searchNames(),
+				yearKeys, directorKeys };
+		}
+	};
+
+	const std::array<const char*, 16> c_titleWords{ "the", "night", "murder", "spirit", "away", "express", "memories", "of",
+		"sunshine", "angry", "men", "earth", "grave", "wars", "princess", "love" };
+	const std::array<const char*, 12> c_firstNames{ "hayao", "sidney", "isao", "wong", "michel", "bong", "jim", "david",
+		"tony", "kate", "brad", "song" };
+	const std::array<const char*, 12> c_lastNames{ "miyazaki", "lumet", "takahata", "kar-wai", "gondry", "joon-ho",
+		"jarmusch", "fincher", "silver", "winslet", "pitt", "kang-ho" };
+
+	// the catalog's own sort keys and people, from its columns
+	void buildIndexes(SyntheticCatalog& catalog)
+	{
+		buildSortKeys(catalog.years, catalog.directors, catalog.yearKeys, catalog.directorKeys);
+
+		std::vector<FilmCredits> credits;
+		credits.reserve(catalog.years.size());
+		for (size_t film{ 0 }; film < catalog.years.size(); ++film) {
+			credits.push_back({ &catalog.directors[film], &catalog.castMembers[film] });
+		}
+		catalog.people.build(credits);
+	}
+
+	SyntheticCatalog makeCatalog(size_t films)
+	{
+		SyntheticCatalog catalog;
+		std::mt19937 random{ 42 };
+		auto pick{ [&random](size_t count) { return static_cast<size_t>(random() % count); } };
+		auto name{ [&]() { return std::string{ c_firstNames[pick(c_firstNames.size())] } + " " + c_lastNames[pick(c_lastNames.size())]; } };
+
+		for (size_t film{ 0 }; film < films; ++film) {
+			catalog.years.push_back(1920 + static_cast<unsigned int>(pick(105)));
+
+			// one to three genres per film
+			unsigned short genres{ 0 };
+			for (size_t count{ 1 + pick(3) }; count > 0; --count) {
+				genres |= genreBit(genresToArray()[pick(10)]);
+			}
+			catalog.genres.push_back(genres);
+
+			std::string title{ c_titleWords[pick(c_titleWords.size())] };
+			for (size_t words{ 1 + pick(3) }; words > 0; --words) {
+				title += " ";
+				title += c_titleWords[pick(c_titleWords.size())];
+			}
+			catalog.titles.push_back(title);
+
+			// a description of a dozen words, which are the title's words again
+			std::string description{ title };
+			for (size_t words{ 0 }; words < 12; ++words) {
+				description += " ";
+				description += c_titleWords[pick(c_titleWords.size())];
+			}
+			catalog.descriptions.push_back(description);
+
+			catalog.directors.push_back(name());
+
+			/* two to twelve cast members: two leads, then the supporting cast, the last of a long cast being an extra. The
+			 * extras come from a far larger crowd than everyone else, so that there are people with only a few films too. */
+			std::vector<CastMember> members;
+			std::string cast;
+			for (size_t actor{ 0 }, actors{ 2 + pick(11) }; actor < actors; ++actor) {
+				Role role{ actor < 2 ? Role::lead : actor + 1 == actors && actors > 5 ? Role::extra : Role::supporting };
+				members.push_back({ role == Role::extra ? "extra " + std::to_string(pick(films / 4 + 1)) : name(), role });
+				cast += (actor ? ",  " : "") + members.back().name;
+			}
+			catalog.casts.push_back(cast);
+			catalog.castMembers.push_back(std::move(members));
+		}
+		buildIndexes(catalog);
+		return catalog;
+	}
+
+	// the films of a catalog that keep passes, in the same order, as a catalog of their own
+	template <typename Keep>
+	SyntheticCatalog keepFilms(const SyntheticCatalog& from, Keep keep)
+	{
+		SyntheticCatalog catalog;
+		for (size_t film{ 0 }; film < from.years.size(); ++film) {
+			if (keep(film)) {
+				catalog.years.push_back(from.years[film]);
+				catalog.genres.push_back(from.genres[film]);
+				catalog.titles.push_back(from.titles[film]);
+				catalog.directors.push_back(from.directors[film]);
+				catalog.casts.push_back(from.casts[film]);
+				catalog.castMembers.push_back(from.castMembers[film]);
+				catalog.descriptions.push_back(from.descriptions[film]);
+			}
+		}
+		buildIndexes(catalog);
+		return catalog;
+	}
+
+	// whether two person indexes credit the same people (by name, their ids being their own) with the same films
+	bool samePeople(const PersonIndex& a, const PersonIndex& b)
+	{
+		bool same{ a.filmCount() == b.filmCount() };
+		for (FilmId film{ 0 }; same && film < a.filmCount(); ++film) {
+			const std::span<const Credit> castA{ a.cast(film) };
+			const std::span<const Credit> castB{ b.cast(film) };
+			same = a.name(a.director(film)) == b.name(b.director(film)) && std::equal(castA.begin(), castA.end(), castB.begin(),
+				castB.end(), [&](const Credit& x, const Credit& y) { return a.name(x.person) == b.name(y.person) && x.role == y.role; });
+		}
+		for (PersonId person{ 0 }; same && person < a.size(); ++person) {
+			const PersonId other{ b.find(a.name(person)) };
+			for (const CreditKind kind : { CreditKind::DIRECTED, CreditKind::ACTED, CreditKind::ANY }) {
+				const std::span<const FilmId> films{ a.filmography(person, kind) };
+				same = same && (other == c_noPerson ? films.empty() : std::ranges::equal(films, b.filmography(other, kind)));
+			}
+		}
+		return same;
+	}
+
+	// whether two graphs (of the two person indexes) have everyone working with the same people, on as many films
+	bool sameCollaborations(const CollaborationGraph& a, const PersonIndex& peopleA, const CollaborationGraph& b, const PersonIndex& peopleB)
+	{
+		bool same{ true };
+		for (PersonId person{ 0 }; same && person < peopleA.size(); ++person) {
+			const PersonId other{ peopleB.find(peopleA.name(person)) };
+			const std::span<const PersonId> collaborators{ a.collaborators(person) };
+			if (other == c_noPerson) {
+				same = collaborators.empty();
+				continue;
+			}
+			same = collaborators.size() == b.collaborators(other).size();
+			for (size_t index{ 0 }; same && index < collaborators.size(); ++index) {
+				const PersonId partner{ peopleB.find(peopleA.name(collaborators[index])) };
+				same = partner != c_noPerson && a.sharedFilms(person, collaborators[index]) == b.sharedFilms(other, partner);
+			}
+		}
+		return same;
+	}
+
+	// times one filter over all the films, repeated, and returns the average in microseconds
+	template <typename Filter>
+	double timeFilter(Filter filter, unsigned int repeats)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		for (unsigned int repeat{ 0 }; repeat < repeats; ++repeat) {
+			filter();
+		}
+		std::chrono::duration<double, std::micro> elapsed{ std::chrono::steady_clock::now() - start };
+		return elapsed.count() / repeats;
+	}
+
+	/* filters all the films a partition at a time with exactly the given number of threads (the calling one and
+	 * threads - 1 of the scheduler's workers) claiming partitions, which is what runFilterParallel() does with all of them */
+	void filterWithThreads(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out, unsigned int threads)
+	{
+		std::atomic<size_t> next{ 0 };
+		const size_t partitionWords{ filterPartitionWords() };
+		TaskScheduler::getInstance()->parallelFor(0, threads, 1, [&](size_t, size_t) {
+			for (size_t first{ next++ * partitionWords }; first < in.wordCount(); first = next++ * partitionWords) {
+				runFilter(plan, catalog, in, out, first, first + partitionWords);
+			}
+		});
+	}
+
+	bool sameFilms(const FilmBitmap& a, const FilmBitmap& b)
+	{
+		bool same{ a.size() == b.size() };
+		for (size_t word{ 0 }; same && word < a.wordCount(); ++word) {
+			same = a.word(word) == b.word(word);
+		}
+		return same;
+	}
+}
+
+bool runFilterBenchmark(size_t films)
+{
+	SyntheticCatalog synthetic{ makeCatalog(films) };
+	CatalogView catalog{ synthetic.view() };
+
+	FilmBitmap all;
+	all.resize(films);
+	all.setAll();
+	FilmBitmap generic;
+	generic.resize(films);
+	FilmBitmap specialised;
+	specialised.resize(films);
+
+	// a few searches like the ones the browser runs: the search screen always has the year range on, the main menu only text
+	std::vector<std::pair<const char*, FilterPlan>> searches;
+	FilterPlan plan;
+	plan.requireGenre(Genre::drama);
+	searches.emplace_back("genre", plan);
+	plan = {};
+	plan.restrictYears(1980, 2000);
+	searches.emplace_back("year", plan);
+	plan.requireGenre(Genre::drama);
+	plan.requireGenre(Genre::romance);
+	searches.emplace_back("genre + year", plan);
+	plan.matchTitle("night");
+	searches.emplace_back("genre + year + title", plan);
+	plan = {};
+	plan.restrictYears(1950, 2020);
+	plan.matchDirector("miyazaki");
+	plan.matchActor("kate");
+	searches.emplace_back("year + director + actor", plan);
+	plan = {};
+	const std::string_view query{ "director:miyazaki genre:drama year:1990..2005 -war \"night\" -genre:war" };
+	parseQuery(query, plan);
+	searches.emplace_back("query language", plan);
+	plan = {};
+	plan.matchAnyText("love");
+	searches.emplace_back("any text", plan);
+
+	// enough repeats for the cheap searches to take a measurable amount of time on small catalogs
+	const unsigned int repeats{ static_cast<unsigned int>(std::max<size_t>(5, 20000000 / std::max<size_t>(films, 1))) };
+
+	std::cout << "Filtering " << films << " films, " << repeats << " runs per search (microseconds per run)\n";
+	std::cout << std::left << std::setw(26) << "search" << std::right << std::setw(10) << "matches" << std::setw(12) << "generic"
+		<< std::setw(14) << "specialised" << std::setw(10) << "speedup" << '\n';
+
+	bool agree{ true };
+	for (const auto& [name, search] : searches) {
+		double genericTime{ timeFilter([&]() { runFilterGeneric(search, catalog, all, generic); }, repeats) };
+		double specialisedTime{ timeFilter([&]() { runFilter(search, catalog, all, specialised); }, repeats) };
+
+		bool same{ sameFilms(generic, specialised) };
+		agree = agree && same;
+
+		std::cout << std::left << std::setw(26) << name << std::right << std::setw(10) << specialised.count() << std::fixed
+			<< std::setprecision(1) << std::setw(12) << genericTime << std::setw(14) << specialisedTime << std::setprecision(2)
+			<< std::setw(9) << genericTime / specialisedTime << 'x' << (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	// what parsing the query above costs, which the main menu textfield does on every keystroke
+	const unsigned int parses{ 100000 };
+	double parseTime{ timeFilter([&]() { plan = {}; parseQuery(query, plan); }, parses) };
+	std::cout << "\nParsing \"" << query << "\" into a plan: " << std::fixed << std::setprecision(3) << parseTime
+		<< " microseconds\n";
+
+	/* negated years leave films out rather than keeping only them: every query below has to select exactly the films
+	 * whose year it allows, whether its exclusions narrow the years down or are held as excluded years */
+	struct YearQuery {
+		std::string_view query;
+		bool (*allowed)(unsigned int year);
+	};
+	const YearQuery yearQueries[]{
+		{ "-year:1994", [](unsigned int year) { return year != 1994; } },
+		{ "-year:..1990", [](unsigned int year) { return year > 1990; } },
+		{ "year:1970..2010 -year:1990..1999", [](unsigned int year) { return year >= 1970 && year <= 2010 && (year < 1990 || year > 1999); } },
+		{ "-year:1980..1984 -year:1985..1989 -year:2000..", [](unsigned int year) { return year < 1980 || (year > 1989 && year < 2000); } },
+		{ "year:1990 -year:1990", [](unsigned int) { return false; } },
+		{ "-year:1980 -year:1990", [](unsigned int year) { return year != 1980 && year != 1990; } },
+		{ "-year:1990 -year:1980", [](unsigned int year) { return year != 1980 && year != 1990; } },
+		{ "-year:1990 -year:1980 -year:1985 year:1980..1989", [](unsigned int year) { return year > 1980 && year <= 1989 && year != 1985; } },
+	};
+	for (const YearQuery& yearQuery : yearQueries) {
+		FilterPlan years;
+		parseQuery(yearQuery.query, years);
+		runFilter(years, catalog, all, specialised);
+		runFilterGeneric(years, catalog, all, generic);
+		bool same{ sameFilms(generic, specialised) };
+		for (FilmId film{ 0 }; same && film < catalog.size(); ++film) {
+			same = specialised.test(film) == yearQuery.allowed(catalog.years[film]);
+		}
+		agree = agree && same;
+		std::cout << "Negated years \"" << yearQuery.query << "\": " << specialised.count() << " films"
+			<< (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	/* the scaling curve of the partitioned filter, on the most expensive of the searches (every film goes through the text
+	 * predicates): 1, 2, 4... threads, up to as many as the scheduler can run at once (its workers and the calling thread) */
+	const FilterPlan& heaviest{ searches.back().second };
+	const unsigned int maxThreads{ TaskScheduler::getInstance()->getWorkerCount() + 1 };
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads{ 1 }; threads < maxThreads; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	runFilter(heaviest, catalog, all, generic);
+	const unsigned int scalingRepeats{ std::max(1u, repeats / 10) };
+
+	std::cout << "\nScaling of \"" << searches.back().first << "\" over partitions of " << FILTER_PARTITION_FILMS << " films, "
+		<< scalingRepeats << " runs per thread count (microseconds per run)\n";
+	std::cout << std::left << std::setw(26) << "threads" << std::right << std::setw(10) << "time" << std::setw(12) << "speedup"
+		<< std::setw(14) << "efficiency" << '\n';
+
+	double singleThreaded{ 0.0 };
+	for (const unsigned int threads : threadCounts) {
+		specialised.clear();
+		double time{ timeFilter([&]() { filterWithThreads(heaviest, catalog, all, specialised, threads); }, scalingRepeats) };
+		if (threads == 1) {
+			singleThreaded = time;
+		}
+
+		// however the partitions were spread over the threads, the result has to be the same as a single pass
+		bool same{ sameFilms(generic, specialised) };
+		agree = agree && same;
+
+		std::cout << std::left << std::setw(26) << threads << std::right << std::fixed << std::setprecision(1) << std::setw(10) << time
+			<< std::setprecision(2) << std::setw(11) << singleThreaded / time << 'x' << std::setprecision(0) << std::setw(13)
+			<< 100.0 * singleThreaded / time / threads << '%' << (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	/* sorting every film in each of the orders: collecting the keys, serving the first page with a partial sort, then the
+	 * full radix sort, against std::sort of the same keys (which it has to agree with) */
+	std::cout << "\nSorting " << films << " results (microseconds)\n";
+	std::cout << std::left << std::setw(26) << "order" << std::right << std::setw(10) << "keys" << std::setw(12) << "first page"
+		<< std::setw(14) << "radix sort" << std::setw(12) << "std::sort" << '\n';
+
+	FilterPlan relevancePlan;
+	relevancePlan.matchAnyText("love");
+	for (const ResultOrder order : { ResultOrder::YEAR, ResultOrder::DIRECTOR, ResultOrder::RELEVANCE }) {
+		ResultSorter sorter;
+		std::vector<FilmId> page;
+		std::vector<FilmId> sorted;
+		double keysTime{ timeFilter([&]() { sorter.reset(all, order, catalog, relevancePlan); }, 1) };
+		double pageTime{ timeFilter([&]() { sorter.take(page, RESULTS_PAGE_SIZE); }, 1) };
+		double radixTime{ timeFilter([&]() { sorter.take(sorted, sorter.size()); }, 1) };
+
+		ResultSorter reference;
+		reference.reset(all, order, catalog, relevancePlan);
+		std::vector<FilmId> expected;
+		double standardTime{ timeFilter([&]() { reference.sortWith([](auto first, auto last) { std::sort(first, last); }); }, 1) };
+		reference.take(expected, reference.size());
+
+		bool same{ sorted == expected && std::equal(page.begin(), page.end(), expected.begin()) };
+		agree = agree && same;
+
+		std::cout << std::left << std::setw(26) << orderName(order) << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << keysTime << std::setw(12) << pageTime << std::setw(14) << radixTime << std::setw(12) << standardTime
+			<< (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	/* person queries on the credits of the catalog: the films of two people together, worked out by galloping through
+	 * their filmographies and checked against merging them, and someone's most frequent collaborators */
+	const PersonIndex& people{ synthetic.people };
+	CollaborationGraph graph;
+	double graphTime{ timeFilter([&]() { graph.build(people); }, 1) };
+	std::cout << "\nPerson queries over " << people.credits().size() << " cast credits of " << people.size()
+		<< " people, graph built in " << std::fixed << std::setprecision(1) << graphTime << " (microseconds)\n"
+		<< std::left << std::setw(26) << "query" << std::right << std::setw(10) << "films" << std::setw(12) << "time"
+		<< std::setw(14) << "merge" << '\n';
+
+	/* the two people with the most films, and someone who worked with the busiest of them on only a few, so that their
+	 * filmographies are as uneven as they get, and someone who never did */
+	std::vector<PersonId> byFilms(people.size());
+	for (PersonId person{ 0 }; person < people.size(); ++person) {
+		byFilms[person] = person;
+	}
+	std::sort(byFilms.begin(), byFilms.end(), [&people](PersonId a, PersonId b) {
+		return people.filmography(a).size() > people.filmography(b).size();
+	});
+	PersonId rare{ byFilms[1] };
+	for (const PersonId person : graph.collaborators(byFilms[0])) {
+		if (people.filmography(person).size() < people.filmography(rare).size()) {
+			rare = person;
+		}
+	}
+	PersonId stranger{ byFilms.back() };
+	for (auto person{ byFilms.rbegin() }; person != byFilms.rend() && graph.sharedFilms(byFilms[0], stranger); ++person) {
+		stranger = *person;
+	}
+	const std::vector<std::pair<const char*, std::vector<PersonTerm>>> queries{
+		{ "two busiest", { { byFilms[0], CreditKind::ANY }, { byFilms[1], CreditKind::ANY } } },
+		{ "directing + acting", { { byFilms[0], CreditKind::DIRECTED }, { byFilms[1], CreditKind::ACTED } } },
+		{ "busiest + rare", { { byFilms[0], CreditKind::ANY }, { rare, CreditKind::ANY } } },
+		{ "busiest + never together", { { byFilms[0], CreditKind::ANY }, { stranger, CreditKind::ANY } } },
+	};
+	FilmBitmap together;
+	together.resize(films);
+	FilmBitmap merged;
+	merged.resize(films);
+	for (const auto& [name, terms] : queries) {
+		double queryTime{ timeFilter([&]() { runPersonQuery(people, graph, terms, PersonQueryMode::ALL, together); }, repeats) };
+
+		// merging the filmographies, the way a query would without the galloping
+		double mergeTime{ timeFilter([&]() {
+			merged.clear();
+			std::vector<FilmId> result;
+			for (size_t term{ 0 }; term < terms.size(); ++term) {
+				const auto filmography{ people.filmography(terms[term].person, terms[term].kind) };
+				std::vector<FilmId> credited(filmography.begin(), filmography.end());
+				if (term == 0) {
+					result = std::move(credited);
+					continue;
+				}
+				std::vector<FilmId> both;
+				std::set_intersection(result.begin(), result.end(), credited.begin(), credited.end(), std::back_inserter(both));
+				result = std::move(both);
+			}
+			for (const FilmId id : result) {
+				merged.set(id);
+			}
+		}, repeats) };
+
+		bool same{ sameFilms(together, merged) };
+		agree = agree && same;
+		std::cout << std::left << std::setw(26) << name << std::right << std::setw(10) << together.count() << std::fixed
+			<< std::setprecision(1) << std::setw(12) << queryTime << std::setw(14) << mergeTime << (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	std::vector<Collaborator> top;
+	double topTime{ timeFilter([&]() { graph.topCollaborators(byFilms[0], 10, top); }, repeats) };
+	std::cout << std::left << std::setw(26) << "top 10 collaborators" << std::right << std::setw(10) << top.size() << std::fixed
+		<< std::setprecision(1) << std::setw(12) << topTime << '\n';
+
+	/* the films most like a few of them, scoring every film with the SSE2 dot product and with the plain one, which have
+	 * to pick the same films */
+	std::vector<std::string_view> descriptions(synthetic.descriptions.begin(), synthetic.descriptions.end());
+	SimilarityIndex similarity;
+	double similarityTime{ timeFilter([&]() { similarity.build(synthetic.view(), descriptions); }, 1) };
+	std::cout << "\nSimilar films, " << SIMILARITY_DIMENSIONS << " dimensions a film, index built in " << std::fixed
+		<< std::setprecision(1) << similarityTime << " (microseconds)\n" << std::left << std::setw(26) << "film" << std::right
+		<< std::setw(10) << "similar" << std::setw(12) << "simd" << std::setw(14) << "scalar" << '\n';
+	std::vector<FilmId> simd;
+	std::vector<FilmId> scalar;
+	for (const FilmId film : { FilmId{ 0 }, static_cast<FilmId>(films / 2), static_cast<FilmId>(films - 1) }) {
+		double simdTime{ timeFilter([&]() { similarity.score(film, 10, simd); }, repeats) };
+		double scalarTime{ timeFilter([&]() { similarity.scoreScalar(film, 10, scalar); }, repeats) };
+		bool same{ simd == scalar };
+		agree = agree && same;
+		std::cout << std::left << std::setw(26) << ("film " + std::to_string(film)) << std::right << std::setw(10) << simd.size()
+			<< std::fixed << std::setprecision(1) << std::setw(12) << simdTime << std::setw(14) << scalarTime
+			<< (same ? "" : "  MISMATCH") << '\n';
+	}
+
+	/* updating the indexes of a catalog in place, against building them anew: one film in 50 leaves and another one in 50
+	 * arrives, and both ways have to end up with the same indexes (telling people apart by name, as their ids differ) */
+	const SyntheticCatalog before{ keepFilms(synthetic, [](size_t film) { return film % 50 != 0; }) };
+	const SyntheticCatalog after{ keepFilms(synthetic, [](size_t film) { return film % 50 != 25; }) };
+	FilmRemap remap;
+	remap.oldToNew.assign(before.years.size(), c_noFilm);
+	remap.newToOld.assign(after.years.size(), c_noFilm);
+	std::vector<FilmCredits> addedCredits;
+	std::vector<std::string_view> addedDescriptions;
+	for (size_t film{ 0 }, old{ 0 }, current{ 0 }; film < films; ++film) {
+		const bool inBefore{ film % 50 != 0 };
+		const bool inAfter{ film % 50 != 25 };
+		if (inBefore && inAfter) {
+			remap.oldToNew[old] = static_cast<FilmId>(current);
+			remap.newToOld[current] = static_cast<FilmId>(old);
+		}
+		else if (inAfter) {
+			remap.added.push_back(static_cast<FilmId>(current));
+			addedCredits.push_back({ &after.directors[current], &after.castMembers[current] });
+			addedDescriptions.push_back(after.descriptions[current]);
+		}
+		old += inBefore;
+		current += inAfter;
+	}
+
+	CollaborationGraph beforeGraph;
+	beforeGraph.build(before.people);
+	std::vector<std::string_view> beforeDescriptions(before.descriptions.begin(), before.descriptions.end());
+	SimilarityIndex beforeSimilarity;
+	beforeSimilarity.build(before.view(), beforeDescriptions);
+
+	SyntheticCatalog updated{ after };
+	CollaborationGraph updatedGraph;
+	SimilarityIndex updatedSimilarity;
+	std::vector<std::string_view> afterDescriptions(after.descriptions.begin(), after.descriptions.end());
+	CollaborationGraph afterGraph;
+	SimilarityIndex afterSimilarity;
+
+	std::cout << "\nUpdating the indexes of " << before.years.size() << " films, " << remap.added.size() << " added and "
+		<< before.years.size() + remap.added.size() - after.years.size() << " removed (microseconds)\n" << std::left << std::setw(26)
+		<< "index" << std::right << std::setw(10) << "same" << std::setw(12) << "update" << std::setw(14) << "build" << '\n';
+	auto compare{ [&](const char* name, double updateTime, double buildTime, bool same) {
+		agree = agree && same;
+		std::cout << std::left << std::setw(26) << name << std::right << std::setw(10) << (same ? "yes" : "no") << std::fixed
+			<< std::setprecision(1) << std::setw(12) << updateTime << std::setw(14) << buildTime << (same ? "" : "  MISMATCH") << '\n';
+	} };
+
+	double updateTime{ timeFilter([&]() { updateSortKeys(before.directorKeys, before.directors, remap, updated.years, updated.directors,
+		updated.yearKeys, updated.directorKeys); }, 1) };
+	double buildTime{ timeFilter([&]() { buildSortKeys(after.years, after.directors, updated.yearKeys, updated.directorKeys); }, 1) };
+	updateSortKeys(before.directorKeys, before.directors, remap, updated.years, updated.directors, updated.yearKeys, updated.directorKeys);
+	compare("sort keys", updateTime, buildTime, updated.yearKeys == after.yearKeys && updated.directorKeys == after.directorKeys);
+
+	std::vector<FilmCredits> afterCredits;
+	for (size_t film{ 0 }; film < after.years.size(); ++film) {
+		afterCredits.push_back({ &after.directors[film], &after.castMembers[film] });
+	}
+	PersonIndex rebuilt;
+	updateTime = timeFilter([&]() { updated.people.update(before.people, remap, addedCredits); }, 1);
+	buildTime = timeFilter([&]() { rebuilt.build(afterCredits); }, 1);
+	compare("people", updateTime, buildTime, samePeople(updated.people, after.people) && samePeople(after.people, updated.people));
+
+	updateTime = timeFilter([&]() { updatedGraph.update(beforeGraph, before.people, updated.people, remap); }, 1);
+	buildTime = timeFilter([&]() { afterGraph.build(after.people); }, 1);
+	compare("collaborations", updateTime, buildTime, sameCollaborations(updatedGraph, updated.people, afterGraph, after.people)
+		&& sameCollaborations(afterGraph, after.people, updatedGraph, updated.people));
+
+	updateTime = timeFilter([&]() { updatedSimilarity.update(beforeSimilarity, remap, updated.view(), addedDescriptions); }, 1);
+	buildTime = timeFilter([&]() { afterSimilarity.build(after.view(), afterDescriptions); }, 1);
+	bool same{ true };
+	std::vector<FilmId> similar;
+	std::vector<FilmId> expected;
+	for (FilmId film{ 0 }; same && film < after.years.size(); film += std::max<FilmId>(1, static_cast<FilmId>(after.years.size() / 64))) {
+		updatedSimilarity.similarTo(film, SIMILAR_FILMS, similar);
+		afterSimilarity.similarTo(film, SIMILAR_FILMS, expected);
+		same = similar == expected;
+	}
+	compare("similar films", updateTime, buildTime, same);
+
+	/* reloading the catalog while searching it: a writer keeps publishing versions with one film in 50 swapped for
+	 * another (see above) while readers search whichever version is current, pinned or referenced, and check that every
+	 * search found what it should have in that version. Afterwards, every version but the current one has to be freed. */
+	const size_t storeFilms{ std::min<size_t>(films, 10000) };
+	std::vector<FilmDetails> details;
+	for (size_t film{ 0 }; film < storeFilms; ++film) {
+		details.push_back({ synthetic.titles[film] + ".png", synthetic.descriptions[film], synthetic.castMembers[film] });
+	}
+	std::vector<ColdRecord> cold{ ColdSegment::write(details) };
+	std::vector<std::shared_ptr<Film>> filmObjects;
+	for (size_t film{ 0 }; film < storeFilms; ++film) {
+		std::unordered_set<Genre> genres;
+		for (const Genre genre : genresToArray()) {
+			if (synthetic.genres[film] & genreBit(genre)) {
+				genres.insert(genre);
+			}
+		}
+		filmObjects.push_back(std::make_shared<Film>(synthetic.titles[film], synthetic.years[film], synthetic.directors[film], genres,
+			cold[film]));
+	}
+	std::vector<std::shared_ptr<Film>> leaving[2];			// by the parity of the version: what the next one removes
+	for (size_t film{ 0 }; film < storeFilms; ++film) {
+		if (film % 50 == 25) {
+			leaving[1].push_back(filmObjects[film]);
+		}
+		else if (film % 50 == 0) {
+			leaving[0].push_back(filmObjects[film]);
+		}
+	}
+	std::vector<std::shared_ptr<Film>> first;
+	for (size_t film{ 0 }; film < storeFilms; ++film) {
+		if (film % 50 != 0) {
+			first.push_back(filmObjects[film]);
+		}
+	}
+
+	CatalogStore store;
+	FilmCatalog built;
+	built.build(first);
+	store.publish(std::move(built));
+
+	// what the search finds in either kind of version: the odd ones (like the first) and the even ones
+	const FilterPlan& reloaded{ searches.back().second };
+	size_t found[2]{};
+	for (const unsigned long long version : { 1ull, 2ull }) {
+		const CatalogPin pinned{ store.pin() };
+		FilmBitmap in;
+		in.resize(pinned->size());
+		in.setAll();
+		FilmBitmap out;
+		out.resize(pinned->size());
+		runFilterGeneric(reloaded, pinned->view(), in, out);
+		found[version % 2] = out.count();
+		if (version == 1) {
+			FilmCatalog next;
+			std::vector<const Film*> removed;
+			for (const auto& film : leaving[1]) {
+				removed.push_back(film.get());
+			}
+			next.update(*pinned, leaving[0], removed);
+			store.publish(std::move(next));
+		}
+	}
+
+	const unsigned int readerCount{ std::max(2u, std::min(4u, std::thread::hardware_concurrency())) };
+	const unsigned int reloads{ 40 };
+	std::atomic<bool> writing{ true };
+	std::atomic<size_t> reads{ 0 };
+	std::atomic<size_t> wrong{ 0 };
+	std::vector<std::thread> readers;
+	for (unsigned int reader{ 0 }; reader < readerCount; ++reader) {
+		readers.emplace_back([&, reader]() {
+			FilmBitmap in;
+			FilmBitmap out;
+			CatalogRef held;
+			for (size_t read{ 0 }; writing || read == 0; ++read) {
+				// every other reader holds on to a reference now and then, across a few searches
+				if (reader % 2 && read % 8 == 0) {
+					held = store.acquire();
+				}
+				auto check{ [&](const FilmCatalog& catalog) {
+					in.resize(catalog.size());
+					in.setAll();
+					out.resize(catalog.size());
+					runFilter(reloaded, catalog.view(), in, out);
+					if (out.count() != found[catalog.getVersion() % 2]) {
+						++wrong;
+					}
+				} };
+				if (held) {
+					check(*held);
+				}
+				else {
+					const CatalogPin pinned{ store.pin() };
+					check(*pinned);
+				}
+				if (read % 8 == 7) {
+					held = {};
+				}
+				++reads;
+			}
+		});
+	}
+
+	double reloadTime{ timeFilter([&]() {
+		for (unsigned int reload{ 0 }; reload < reloads; ++reload) {
+			const CatalogRef current{ store.acquire() };
+			const unsigned long long parity{ current->getVersion() % 2 };
+			std::vector<const Film*> removed;
+			for (const auto& film : leaving[parity]) {
+				removed.push_back(film.get());
+			}
+			FilmCatalog next;
+			next.update(*current, leaving[1 - parity], removed);
+			store.publish(std::move(next));
+		}
+	}, 1) };
+	writing = false;
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+	store.reclaim();
+	const size_t leftOver{ store.retiredCount() };
+	const bool consistent{ wrong == 0 && leftOver == 0 };
+	agree = agree && consistent;
+	std::cout << "\nReloading " << storeFilms << " films " << reloads << " times while " << readerCount << " readers search them: "
+		<< std::fixed << std::setprecision(1) << reloadTime / reloads << " microseconds a reload, " << reads << " searches, "
+		<< wrong << " wrong, " << leftOver << " versions left over" << (consistent ? "" : "  MISMATCH") << '\n';
+
+	/* the hot/cold split of the same films: what each keeps resident (the Film itself, and whatever of its title and
+	 * director doesn't fit in the strings), against what its details take in the cold segment and would as text, and
+	 * how long paging them in takes. Every film's details have to read back as they were written. */
+	size_t resident{ 0 };
+	size_t text{ 0 };
+	bool intact{ true };
+	for (size_t film{ 0 }; film < storeFilms; ++film) {
+		const Film& object{ *filmObjects[film] };
+		resident += sizeof(Film);
+		for (const std::string* field : { &object.getTitle(), &object.getDirector() }) {
+			resident += field->size() >= sizeof(std::string) ? field->capacity() + 1 : 0;
+		}
+		text += details[film].poster.size() + details[film].description.size();
+		for (const CastMember& member : details[film].cast) {
+			text += member.name.size() + 1;
+		}
+		const FilmDetails read{ object.readDetails() };
+		intact = intact && read.poster == details[film].poster && read.description == details[film].description &&
+			std::ranges::equal(read.cast, details[film].cast, [](const CastMember& a, const CastMember& b) {
+				return a.name == b.name && a.role == b.role;
+			});
+	}
+	const double pageInTime{ timeFilter([&]() {
+		for (const std::shared_ptr<Film>& film : filmObjects) {
+			film->details();
+			film->releaseDetails();
+		}
+	}, 1) / std::max<size_t>(storeFilms, 1) };
+	const double perFilm{ 1.0 / std::max<size_t>(storeFilms, 1) };
+	const size_t segmentSize{ cold.empty() ? 0 : cold.front().segment->size() };
+	agree = agree && intact;
+	std::cout << "\nHot/cold split of " << storeFilms << " films: " << std::fixed << std::setprecision(1) << resident * perFilm
+		<< " bytes a film resident (sizeof(Film) " << sizeof(Film) << "), details " << segmentSize * perFilm << " bytes a film cold"
+		<< (cold.empty() || cold.front().segment->isMapped() ? " (mapped)" : " (in memory)") << " against " << text * perFilm
+		<< " as text, " << std::setprecision(2) << pageInTime << " microseconds to page a film's in"
+		<< (intact ? "" : "  MISMATCH") << '\n';
+	return agree;
+}
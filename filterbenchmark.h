@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+
+/* The filter benchmark (FilmGUI --bench-filters [films]): Builds a synthetic catalog of the given number of films and
+ * times runFilterGeneric() against the specialised kernels of runFilter() on a few typical searches, checking along the way
+ * that both select exactly the same films. Then times the partitioned filter of runFilterParallel() on 1, 2, 4... threads,
+ * up to all the TaskScheduler can run, checking that every thread count selects the same films as a single pass. Finally
+ * times sorting every film in each of the result orders, radix sort against std::sort, and then updating the indexes of
+ * the catalog for a few added and removed films, against building them anew (which they have to end up the same as), and last
+ * publishes version after version of a CatalogStore while a few threads search it, checking every search against the
+ * version it saw, and that the old versions are all freed, and measures what the films of that catalog keep resident
+ * against what their details take in their ColdSegment, checking that the details all read back as written. Prints the
+ * tables to std::cout. Returns false if any two results ever disagree. */
+bool runFilterBenchmark(size_t films);
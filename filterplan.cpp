@@ -0,0 +1,355 @@
+#include "filterplan.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <array>
+#include <utility>
+#include <algorithm>
+
+void FilterPlan::requireGenre(Genre genre)
+{
+	active |= GENRE;
+	genres |= genreBit(genre);
+}
+
+void FilterPlan::excludeGenre(Genre genre)
+{
+	active |= GENRE;
+	excludedGenres |= genreBit(genre);
+}
+
+void FilterPlan::restrictYears(unsigned int from, unsigned int to)
+{
+	active |= YEAR;
+	fromYear = std::max(fromYear, from);
+	toYear = std::min(toYear, to);
+	clipExcludedYears();
+}
+
+void FilterPlan::excludeYears(unsigned int from, unsigned int to)
+{
+	active |= YEAR;
+	YearRange range{ std::max(from, fromYear), std::min(to, toYear) };
+	if (range.from > range.to) {
+		return;
+	}
+
+	// in 64 bits, so that a range running up to ~0u still touches the one after it
+	auto touches{ [](const YearRange& first, const YearRange& second) {
+		return first.from <= static_cast<unsigned long long>(second.to) + 1 && second.from <= static_cast<unsigned long long>(first.to) + 1;
+	} };
+	if (excludedYearCount == excludedYears.size() &&
+		std::none_of(excludedYears.begin(), excludedYears.end(), [&](const YearRange& excluded) { return touches(excluded, range); })) {
+		return;
+	}
+
+	// the ranges before it, the new one with every range it touches merged in, and the ranges after it
+	std::array<YearRange, FILTER_MAX_TERMS> merged;
+	unsigned int mergedCount{ 0 };
+	bool placed{ false };
+	for (unsigned int excluded{ 0 }; excluded < excludedYearCount; ++excluded) {
+		const YearRange& other{ excludedYears[excluded] };
+		if (touches(other, range)) {
+			range = { std::min(range.from, other.from), std::max(range.to, other.to) };
+			continue;
+		}
+		if (!placed && other.from > range.to) {
+			merged[mergedCount++] = range;
+			placed = true;
+		}
+		merged[mergedCount++] = other;
+	}
+	if (!placed) {
+		merged[mergedCount++] = range;
+	}
+	excludedYears = merged;
+	excludedYearCount = mergedCount;
+	clipExcludedYears();
+}
+
+void FilterPlan::clipExcludedYears()
+{
+	unsigned int kept{ 0 };
+	for (unsigned int excluded{ 0 }; excluded < excludedYearCount; ++excluded) {
+		const YearRange range{ std::max(excludedYears[excluded].from, fromYear), std::min(excludedYears[excluded].to, toYear) };
+		if (range.from <= range.to) {
+			excludedYears[kept++] = range;
+		}
+	}
+	excludedYearCount = kept;
+
+	// the ranges are in order and don't touch, so only the first can start the years off and only the last can end them
+	if (excludedYearCount > 0 && excludedYears[0].from == fromYear) {
+		if (excludedYears[0].to == toYear) {
+			// nothing is left
+			fromYear = ~0u;
+			toYear = 0;
+			excludedYearCount = 0;
+			return;
+		}
+		fromYear = excludedYears[0].to + 1;
+		std::copy(excludedYears.begin() + 1, excludedYears.begin() + excludedYearCount, excludedYears.begin());
+		--excludedYearCount;
+	}
+	if (excludedYearCount > 0 && excludedYears[excludedYearCount - 1].to == toYear) {
+		toYear = excludedYears[--excludedYearCount].from - 1;
+	}
+}
+
+// the first text of each kind goes in its view, any more in terms
+void FilterPlan::matchTitle(std::string_view text)
+{
+	if (!text.empty() && (active & TITLE)) {
+		addTerm(TITLE, false, text);
+	}
+	else if (!text.empty()) {
+		active |= TITLE;
+		title = text;
+	}
+}
+
+void FilterPlan::matchDirector(std::string_view text)
+{
+	if (!text.empty() && (active & DIRECTOR)) {
+		addTerm(DIRECTOR, false, text);
+	}
+	else if (!text.empty()) {
+		active |= DIRECTOR;
+		director = text;
+	}
+}
+
+void FilterPlan::matchActor(std::string_view text)
+{
+	if (!text.empty() && (active & ACTOR)) {
+		addTerm(ACTOR, false, text);
+	}
+	else if (!text.empty()) {
+		active |= ACTOR;
+		actor = text;
+	}
+}
+
+void FilterPlan::matchAnyText(std::string_view text)
+{
+	if (!text.empty() && (active & ANY_TEXT)) {
+		addTerm(ANY_TEXT, false, text);
+	}
+	else if (!text.empty()) {
+		active |= ANY_TEXT;
+		anyText = text;
+	}
+}
+
+void FilterPlan::excludeText(unsigned int predicate, std::string_view text)
+{
+	if (!text.empty()) {
+		addTerm(predicate, true, text);
+	}
+}
+
+void FilterPlan::addTerm(unsigned int predicate, bool excluded, std::string_view text)
+{
+	if (termCount < terms.size()) {
+		active |= TERMS;
+		terms[termCount++] = { predicate, excluded, text };
+	}
+}
+
+namespace {
+	constexpr unsigned int c_columnPredicates{ FilterPlan::GENRE | FilterPlan::YEAR };
+	constexpr unsigned int c_textPredicates{ FilterPlan::TITLE | FilterPlan::DIRECTOR | FilterPlan::ACTOR | FilterPlan::ANY_TEXT |
+		FilterPlan::TERMS };
+
+	bool contains(const std::string& text, std::string_view part)
+	{
+		return text.find(part) != std::string::npos;
+	}
+
+	bool containsAnywhere(const CatalogView& catalog, FilmId id, std::string_view part)
+	{
+		return contains(catalog.titles[id], part) || contains(catalog.directors[id], part) || contains(catalog.casts[id], part);
+	}
+
+	// whether one film passes every extra term of a plan
+	bool passesTerms(const FilterPlan& plan, const CatalogView& catalog, FilmId id)
+	{
+		for (unsigned int term{ 0 }; term < plan.termCount; ++term) {
+			const FilterPlan::TextTerm& text{ plan.terms[term] };
+			bool found;
+			switch (text.predicate) {
+			case FilterPlan::TITLE:		found = contains(catalog.titles[id], text.text); break;
+			case FilterPlan::DIRECTOR:	found = contains(catalog.directors[id], text.text); break;
+			case FilterPlan::ACTOR:		found = contains(catalog.casts[id], text.text); break;
+			default:					found = containsAnywhere(catalog, id, text.text); break;
+			}
+			if (found == text.excluded) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/* The kernel for one combination of predicates. Films are taken 64 at a time (one word of the bitmaps): the column
+	 * predicates are evaluated for all 64 without branches, and only the films that are still in after them go through
+	 * the (much more expensive) text predicates. */
+	template <unsigned int Active>
+	void filterKernel(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out, size_t firstWord, size_t lastWord)
+	{
+		const std::uint64_t* input{ in.words() };
+		std::uint64_t* output{ out.words() };
+		const size_t size{ in.size() };
+
+		const unsigned short* genres{ catalog.genres.data() };
+		const unsigned int* years{ catalog.years.data() };
+		const unsigned short requiredGenres{ plan.genres };
+		const unsigned short excludedGenres{ plan.excludedGenres };
+		const unsigned int fromYear{ plan.fromYear };
+		const unsigned int toYear{ plan.toYear };
+		const FilterPlan::YearRange* excludedYears{ plan.excludedYears.data() };
+		const unsigned int excludedYearCount{ plan.excludedYearCount };
+
+		for (size_t index{ firstWord }; index < lastWord; ++index) {
+			std::uint64_t word{ input[index] };
+
+			if constexpr ((Active & c_columnPredicates) != 0) {
+				const size_t first{ index * 64 };
+				const size_t last{ std::min(first + 64, size) };
+				std::uint64_t passed{ 0 };
+				for (size_t id{ first }; id < last; ++id) {
+					bool matches{ true };
+					if constexpr ((Active & FilterPlan::GENRE) != 0) {
+						matches &= ((genres[id] & requiredGenres) == requiredGenres) & ((genres[id] & excludedGenres) == 0);
+					}
+					if constexpr ((Active & FilterPlan::YEAR) != 0) {
+						matches &= (years[id] >= fromYear) & (years[id] <= toYear);
+						for (unsigned int excluded{ 0 }; excluded < excludedYearCount; ++excluded) {
+							matches &= (years[id] < excludedYears[excluded].from) | (years[id] > excludedYears[excluded].to);
+						}
+					}
+					passed |= static_cast<std::uint64_t>(matches) << (id - first);
+				}
+				word &= passed;
+			}
+
+			if constexpr ((Active & c_textPredicates) != 0) {
+				for (std::uint64_t remaining{ word }; remaining; remaining &= remaining - 1) {
+					const int bit{ std::countr_zero(remaining) };
+					const size_t id{ index * 64 + bit };
+					bool matches{ true };
+					if constexpr ((Active & FilterPlan::TITLE) != 0) {
+						matches = matches && contains(catalog.titles[id], plan.title);
+					}
+					if constexpr ((Active & FilterPlan::DIRECTOR) != 0) {
+						matches = matches && contains(catalog.directors[id], plan.director);
+					}
+					if constexpr ((Active & FilterPlan::ACTOR) != 0) {
+						matches = matches && contains(catalog.casts[id], plan.actor);
+					}
+					if constexpr ((Active & FilterPlan::ANY_TEXT) != 0) {
+						matches = matches && containsAnywhere(catalog, static_cast<FilmId>(id), plan.anyText);
+					}
+					if constexpr ((Active & FilterPlan::TERMS) != 0) {
+						matches = matches && passesTerms(plan, catalog, static_cast<FilmId>(id));
+					}
+					if (!matches) {
+						word &= ~(std::uint64_t{ 1 } << bit);
+					}
+				}
+			}
+
+			output[index] = word;
+		}
+	}
+
+	using FilterKernel = void (*)(const FilterPlan&, const CatalogView&, const FilmBitmap&, FilmBitmap&, size_t, size_t);
+
+	template <size_t... Combinations>
+	constexpr std::array<FilterKernel, sizeof...(Combinations)> makeKernels(std::index_sequence<Combinations...>)
+	{
+		return { &filterKernel<static_cast<unsigned int>(Combinations)>... };
+	}
+
+	// c_kernels[mask]: the kernel for the plans whose active mask is mask
+	constexpr std::array<FilterKernel, FilterPlan::COMBINATIONS> c_kernels{ makeKernels(std::make_index_sequence<FilterPlan::COMBINATIONS>{}) };
+}
+
+void OwnedFilterPlan::assign(const FilterPlan& from)
+{
+	plan = from;
+	title.assign(from.title);
+	director.assign(from.director);
+	actor.assign(from.actor);
+	anyText.assign(from.anyText);
+	for (unsigned int term{ 0 }; term < from.termCount; ++term) {
+		terms[term].assign(from.terms[term].text);
+	}
+}
+
+FilterPlan OwnedFilterPlan::bind() const
+{
+	FilterPlan bound{ plan };
+	bound.title = title;
+	bound.director = director;
+	bound.actor = actor;
+	bound.anyText = anyText;
+	for (unsigned int term{ 0 }; term < bound.termCount; ++term) {
+		bound.terms[term].text = terms[term];
+	}
+	return bound;
+}
+
+void runFilter(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out)
+{
+	PROFILE_SCOPE("runFilter");
+	runFilter(plan, catalog, in, out, 0, in.wordCount());
+}
+
+void runFilter(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out, size_t firstWord, size_t lastWord)
+{
+	c_kernels[plan.active & (FilterPlan::COMBINATIONS - 1)](plan, catalog, in, out, firstWord, std::min(lastWord, in.wordCount()));
+}
+
+void runFilterParallel(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out, TaskPriority priority)
+{
+	PROFILE_SCOPE("runFilterParallel");
+	const FilterKernel kernel{ c_kernels[plan.active & (FilterPlan::COMBINATIONS - 1)] };
+	TaskScheduler::getInstance()->parallelFor(0, in.wordCount(), filterPartitionWords(), [&](size_t firstWord, size_t lastWord) {
+		kernel(plan, catalog, in, out, firstWord, lastWord);
+	}, priority);
+}
+
+bool passesFilter(const FilterPlan& plan, const CatalogView& catalog, FilmId id)
+{
+	if ((plan.active & FilterPlan::GENRE) && ((catalog.genres[id] & plan.genres) != plan.genres || (catalog.genres[id] & plan.excludedGenres))) {
+		return false;
+	}
+	if ((plan.active & FilterPlan::YEAR) && (catalog.years[id] < plan.fromYear || catalog.years[id] > plan.toYear ||
+		std::any_of(plan.excludedYears.begin(), plan.excludedYears.begin() + plan.excludedYearCount,
+			[&](const FilterPlan::YearRange& excluded) { return catalog.years[id] >= excluded.from && catalog.years[id] <= excluded.to; }))) {
+		return false;
+	}
+	if ((plan.active & FilterPlan::TITLE) && !contains(catalog.titles[id], plan.title)) {
+		return false;
+	}
+	if ((plan.active & FilterPlan::DIRECTOR) && !contains(catalog.directors[id], plan.director)) {
+		return false;
+	}
+	if ((plan.active & FilterPlan::ACTOR) && !contains(catalog.casts[id], plan.actor)) {
+		return false;
+	}
+	if ((plan.active & FilterPlan::ANY_TEXT) && !containsAnywhere(catalog, id, plan.anyText)) {
+		return false;
+	}
+	return !(plan.active & FilterPlan::TERMS) || passesTerms(plan, catalog, id);
+}
+
+void runFilterGeneric(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out)
+{
+	out.clear();
+	in.forEach([&plan, &catalog, &out](FilmId id) {
+		if (passesFilter(plan, catalog, id)) {
+			out.set(id);
+		}
+	});
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filmutil.h"
+#include "taskscheduler.h"
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <algorithm>
+
+/* FilterPlan: Everything a search filters on, gathered from the widgets before any film is looked at. Each kind of
+ * predicate has a bit, and the bits of the predicates that are in use make up the plan's active mask.
+ *
+ * runFilter() then looks the mask up in a table of kernels, one per combination of predicates, each compiled from the
+ * same template with the inactive predicates removed at compile time (if constexpr). So the kernel that runs evaluates
+ * only what the search uses, in one pass over the films, with no "is this predicate on?" or "what kind of textfield is
+ * this?" branches left in its loops. runFilterGeneric() is the same filter with those checks done at run time instead; it
+ * is what the kernels are benchmarked against (FilmGUI --bench-filters).
+ *
+ * Large catalogs are filtered in partitions of FILTER_PARTITION_FILMS films (small enough for the columns a partition reads
+ * to stay in a core's cache) on the TaskScheduler's workers. A partition only ever writes its own words of the output
+ * bitmap, so there is nothing to merge afterwards: the result is the same, bit for bit, whichever thread ran which
+ * partition and in whatever order.
+ *
+ * The text predicates only keep a view of the widget's text, so a plan must not outlive the widgets it was made from.
+ * There is room for one text of each kind in the views, and for up to FILTER_MAX_TERMS more (a second title, or text a
+ * film must not contain) in terms, all in place, so that building a plan never allocates. Texts past that are dropped. */
+
+struct FilterPlan {
+	static constexpr unsigned int GENRE{ 1 << 0 };			// the film has every one of the genres
+	static constexpr unsigned int YEAR{ 1 << 1 };			// the film came out between fromYear and toYear, and not in the excluded years
+	static constexpr unsigned int TITLE{ 1 << 2 };			// the title contains the text
+	static constexpr unsigned int DIRECTOR{ 1 << 3 };		// the director's name contains the text
+	static constexpr unsigned int ACTOR{ 1 << 4 };			// someone in the cast has a name that contains the text
+	static constexpr unsigned int ANY_TEXT{ 1 << 5 };		// any of the title/director/cast contains the text (the main menu textfield)
+	static constexpr unsigned int TERMS{ 1 << 6 };			// every one of terms holds
+	static constexpr unsigned int COMBINATIONS{ 1 << 7 };
+
+	// YearRange: years a film must not have come out in, from and to included
+	struct YearRange {
+		unsigned int from{ 0 };
+		unsigned int to{ 0 };
+
+		bool operator==(const YearRange& other) const = default;
+	};
+
+	// TextTerm: a text that didn't fit in the views below, and where it has to be (or, if excluded, not be) found
+	struct TextTerm {
+		unsigned int predicate{ 0 };						// TITLE, DIRECTOR, ACTOR or ANY_TEXT
+		bool excluded{ false };
+		std::string_view text;
+	};
+
+	unsigned int active{ 0 };
+
+	unsigned short genres{ 0 };
+	unsigned short excludedGenres{ 0 };					// the film has none of these (still part of GENRE)
+	unsigned int fromYear{ 0 };
+	unsigned int toYear{ ~0u };
+	std::array<YearRange, FILTER_MAX_TERMS> excludedYears{};	// the film came out in none of these (still part of YEAR)
+	unsigned int excludedYearCount{ 0 };
+
+	// all lowercase, like the columns they're compared to
+	std::string_view title;
+	std::string_view director;
+	std::string_view actor;
+	std::string_view anyText;
+
+	std::array<TextTerm, FILTER_MAX_TERMS> terms{};
+	unsigned int termCount{ 0 };
+
+	// the predicates narrow the plan down, so adding the same kind twice keeps the stricter of the two
+	void requireGenre(Genre genre);
+	void excludeGenre(Genre genre);
+	void restrictYears(unsigned int from, unsigned int to);
+
+	/* an exclusion at either end of the years still allowed narrows them down, any other is kept in excludedYears. Those
+	 * are kept in order, and ranges that touch or overlap are merged, so the same years excluded in any order (or pieces)
+	 * make the same plan. There is room for FILTER_MAX_TERMS ranges, like for the terms: one past that is dropped. */
+	void excludeYears(unsigned int from, unsigned int to);
+
+	// an empty text filters nothing, so it leaves the plan as it was
+	void matchTitle(std::string_view text);
+	void matchDirector(std::string_view text);
+	void matchActor(std::string_view text);
+	void matchAnyText(std::string_view text);
+
+	// the film passes only if the text is not where the predicate (TITLE, DIRECTOR, ACTOR or ANY_TEXT) looks
+	void excludeText(unsigned int predicate, std::string_view text);
+
+private:
+	// a text beyond the one of each kind the views hold
+	void addTerm(unsigned int predicate, bool excluded, std::string_view text);
+
+	// clips the excluded years to fromYear..toYear, and narrows those down by any that are at either end of them
+	void clipExcludedYears();
+};
+
+// OwnedFilterPlan: A FilterPlan that owns its text, for plans that have to outlive the widgets they came from
+struct OwnedFilterPlan {
+	FilterPlan plan;
+	std::string title;
+	std::string director;
+	std::string actor;
+	std::string anyText;
+	std::array<std::string, FILTER_MAX_TERMS> terms;
+
+	// copies a plan and its text
+	void assign(const FilterPlan& from);
+
+	// the plan, with its text views pointing at our own strings (which may have moved since assign())
+	FilterPlan bind() const;
+};
+
+// Writes the films of the input that pass every active predicate into the output, through the kernel specialised for the
+// plan's active mask. The output must be sized to the catalog.
+void runFilter(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out);
+
+// The same, for only the words [firstWord, lastWord) of the bitmaps (films 64 * firstWord onwards). The rest of the output
+// is left as it was, so a long filter can be run a piece at a time.
+void runFilter(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out, size_t firstWord, size_t lastWord);
+
+// The same, split into partitions run on the TaskScheduler's workers (and the calling thread), returning once all are done
+void runFilterParallel(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out,
+	TaskPriority priority = TaskPriority::BULK);
+
+// how many words of the bitmaps make up one partition of FILTER_PARTITION_FILMS films
+inline size_t filterPartitionWords()						{ return std::max<size_t>(FILTER_PARTITION_FILMS / 64, 1); }
+
+// Whether one film passes every active predicate, checking which are active as it goes
+bool passesFilter(const FilterPlan& plan, const CatalogView& catalog, FilmId id);
+
+// The same filter, checking which predicates are active for every film, as a baseline for the benchmark
+void runFilterGeneric(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& in, FilmBitmap& out);
@@ -1,4 +1,5 @@
 #include "genrebutton.h"
+#include "profiler.h"
 
 #include <utility>
 
@@ -11,13 +12,13 @@ float GenreButton::calculateWidth(Genre genre)
 
 GenreButton::GenreButton(const float pos_x, const float pos_y, const float height, const Genre genre) :
 	TextButton{pos_x, pos_y, calculateWidth(genre), height, genreName(genre), TextButtonUseage::OTHER},
-	Button{pos_x, pos_y, calculateWidth(genre), height},
 	m_genre{genre}
 {
 }
 
 void GenreButton::draw()
 {
+	PROFILE_SCOPE("GenreButton::draw");
 	// drawing the rectangle of the button
 	float highlighted{ 0.3f + m_highlighted * 0.4f };
 
@@ -31,45 +32,18 @@ void GenreButton::draw()
 	else {
 		SETCOLOUR(m_brush.fill_color, 0.6f, 0.5f, 0.0f);
 	}
-	graphics::drawRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
+	queueRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
 
 	SETCOLOUR(m_brush.fill_color, 0.15f, 0.15f, 0.15f);
 	m_brush.outline_opacity = 0.0f;
-	graphics::drawText(m_pos_x-m_width / 2.175f, m_pos_y + m_height / 4.0f, m_height * 0.625f, genreName(m_genre), m_brush);
+	queueText(m_pos_x-m_width / 2.175f, m_pos_y + m_height / 4.0f, m_height * 0.625f, genreName(m_genre), m_brush);
 
 }
 
-// A Genre Button is valid for filtering if it has been clicked (m_clicked == true)
-bool GenreButton::canFilter() const
+void GenreButton::addToPlan(FilterPlan& plan) const
 {
-	return m_clicked;
-}
-
-// if the genre button is clicked, it filters the unordered_set of films passed to it, removing any that don't have its genre
-void GenreButton::filter(std::unordered_set<class Film*>& currFilms) const
-{
-	// iterating through the unordered_set of films
-	auto iter { currFilms.begin() };
-	while (iter != currFilms.end()) {
-
-		// fetching the respective unordered_set of genres for every film, and iterating through it
-		std::unordered_set<enum class Genre> genres { (*iter)->getGenres() };
-		auto genre_iter { genres.begin() };
-		while (genre_iter != genres.end()) {
-
-			// if we have found the genre this Genre Button contains, breaking the loop and continuing with the next film in the set
-			if (*genre_iter == m_genre) {
-				break;
-			}
-			++genre_iter;
-		}
-
-		// if we went through all the genres but didn't find the one this Genre Button has, erasing the film from the set, while incrementing the iterator
-		if (genre_iter == genres.end()) {
-			currFilms.erase(iter++);
-			continue;
-		}
-		++iter;
+	if (m_clicked) {
+		plan.requireGenre(m_genre);
 	}
 }
 
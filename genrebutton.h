@@ -1,6 +1,8 @@
 #pragma once
 #include "textbutton.h"
 #include "filmutil.h"
+#include "filmcatalog.h"
+#include "filterplan.h"
 
 #include <utility>
 
@@ -14,10 +16,13 @@ public:
 	// is automatically generated on creation based on the (size of the) name of the genre
 	GenreButton(const float pos_x, const float pos_y, const float height, const Genre genre);
 
-	void draw() override;
-	// void update() override;	- DEPRECATED: GenreButton will utilise Button's update()
-	bool canFilter() const override;
-	void filter(std::unordered_set<class Film*>& currFilms) const override;
+	void draw();
+	// void update() override;	- DEPRECATED: GenreButton has nothing to update
+
+	// adds this button's genre to a search, if it is clicked
+	void addToPlan(FilterPlan& plan) const;
+
+	Genre getGenre() const								{ return m_genre; }
 
 	// calculates the width based on the name of the genre (passed as param)
 	static float calculateWidth(Genre genre);	// static, since we'll be using it in FilmUI to calculate the width of a GenreButton before initialising it
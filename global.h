@@ -1,7 +1,45 @@
 #pragma once
 
+#ifdef _WIN32
 #define ASSET_PATH "assets\\"
+#else
+#define ASSET_PATH "assets/"
+#endif
 #define WINDOW_WIDTH 1400
 #define WINDOW_HEIGHT 900
 #define CANVAS_WIDTH 1200
-#define CANVAS_HEIGHT 700
\ No newline at end of file
+#define CANVAS_HEIGHT 700
+#define POSTER_WIDTH 105
+#define POSTER_HEIGHT 160
+#define POSTER_CACHE_BUDGET (64 * 1024 * 1024)
+#define IDLE_TIMEOUT 5000.0f
+#define IDLE_FRAME_TIME 100
+#define PROFILER_HISTORY 240
+#define PROFILER_TRACE_EVENTS 65536
+#define PROFILER_TRACE_FILE "trace.json"
+#define INPUT_REPEAT_DELAY 400.0f
+#define INPUT_REPEAT_INTERVAL 35.0f
+#define TEXTFIELD_MAX_LENGTH 4096
+#define TEXTFIELD_CHARACTER_WIDTH 8.5f
+#define LAYOUT_FILE "layout.txt"
+#define FILTER_PARTITION_FILMS 4096
+#define SCHEDULER_MAX_WORKERS 64u
+#define CATALOG_BUILD_GRAIN 1024
+#define QUERY_CACHE_BUDGET (16 * 1024 * 1024)
+#define RESULTS_PAGE_SIZE 10
+#define RESULT_SORT_PARTIAL 16
+#define INFO_CHARACTER_WIDTH 0.55f
+#define COLLABORATION_BUILD_GRAIN 1024
+#define PERSON_QUERY_GALLOP_RATIO 8
+#define SIMILARITY_DIMENSIONS 64u
+#define SIMILARITY_TOP_BILLED 3u
+#define SIMILARITY_MAX_WORDS 24u
+#define SIMILARITY_PRECOMPUTE_FILMS 4096
+#define SIMILAR_FILMS 4u
+#define FILTER_MAX_TERMS 8u
+#define CATALOG_FILE "films.txt"
+#define CATALOG_POLL_INTERVAL 500.0f
+#define CATALOG_RELOAD_DELAY 150.0f
+#define CATALOG_READER_SLOTS 64
+#define COLD_COMPRESS true
+#define COLD_COMPRESS_MIN 64
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "inputmanager.h"
+#include "global.h"
+#include "graphics.h"
+
+#include <vector>
+
+InputManager* InputManager::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new InputManager();
+	}
+	return s_instance;
+}
+
+void InputManager::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+InputManager::InputManager()
+{
+	// a frame rarely produces more than a couple of events, unless someone is typing very fast while dragging
+	m_events.reserve(32);
+}
+
+char InputManager::characterOf(int key, bool shift)
+{
+	if (key >= graphics::SCANCODE_A && key <= graphics::SCANCODE_Z) {
+		return static_cast<char>((shift ? 'A' : 'a') + (key - graphics::SCANCODE_A));
+	}
+	if (key >= graphics::SCANCODE_1 && key <= graphics::SCANCODE_0) {
+		static const char digits[]{ "1234567890" };
+		static const char shifted[]{ "!@#$%^&*()" };
+		return (shift ? shifted : digits)[key - graphics::SCANCODE_1];
+	}
+
+	switch (key) {
+	case graphics::SCANCODE_SPACE:			return ' ';
+	case graphics::SCANCODE_MINUS:			return shift ? '_' : '-';
+	case graphics::SCANCODE_EQUALS:			return shift ? '+' : '=';
+	case graphics::SCANCODE_LEFTBRACKET:	return shift ? '{' : '[';
+	case graphics::SCANCODE_RIGHTBRACKET:	return shift ? '}' : ']';
+	case graphics::SCANCODE_BACKSLASH:		return shift ? '|' : '\\';
+	case graphics::SCANCODE_SEMICOLON:		return shift ? ':' : ';';
+	case graphics::SCANCODE_APOSTROPHE:		return shift ? '"' : '\'';
+	case graphics::SCANCODE_GRAVE:			return shift ? '~' : '`';
+	case graphics::SCANCODE_COMMA:			return shift ? '<' : ',';
+	case graphics::SCANCODE_PERIOD:			return shift ? '>' : '.';
+	case graphics::SCANCODE_SLASH:			return shift ? '?' : '/';
+	default:								return '\0';
+	}
+}
+
+void InputManager::pushKey(InputEventType type, int key)
+{
+	InputEvent event;
+	event.type = type;
+	event.key = static_cast<graphics::scancode_t>(key);
+	event.x = m_snapshot.mouseX;
+	event.y = m_snapshot.mouseY;
+	event.shift = m_snapshot.shift;
+	event.ctrl = m_snapshot.ctrl;
+	m_events.push_back(event);
+
+	// holding ctrl turns keys into shortcuts, which don't type anything
+	char character{ characterOf(key, m_snapshot.shift) };
+	if (type != InputEventType::KEY_UP && character && !m_snapshot.ctrl) {
+		event.type = InputEventType::TEXT;
+		event.character = character;
+		m_events.push_back(event);
+	}
+}
+
+void InputManager::capture()
+{
+	m_events.clear();
+
+	graphics::MouseState mouse;
+	graphics::getMouseState(mouse);
+
+	InputSnapshot& snapshot{ m_snapshot };
+	snapshot.previousMouseX = snapshot.mouseX;
+	snapshot.previousMouseY = snapshot.mouseY;
+	snapshot.mouseX = graphics::windowToCanvasX(static_cast<float>(mouse.cur_pos_x));
+	snapshot.mouseY = graphics::windowToCanvasY(static_cast<float>(mouse.cur_pos_y));
+	snapshot.moved = snapshot.mouseX != snapshot.previousMouseX || snapshot.mouseY != snapshot.previousMouseY;
+	snapshot.leftDown = mouse.button_left_down;
+	snapshot.leftPressed = mouse.button_left_pressed;
+	snapshot.leftReleased = mouse.button_left_released;
+	snapshot.dragging = mouse.dragging;
+	snapshot.shift = graphics::getKeyState(graphics::SCANCODE_LSHIFT) || graphics::getKeyState(graphics::SCANCODE_RSHIFT);
+	snapshot.ctrl = graphics::getKeyState(graphics::SCANCODE_LCTRL) || graphics::getKeyState(graphics::SCANCODE_RCTRL);
+
+	// the mouse events
+	InputEvent event;
+	event.x = snapshot.mouseX;
+	event.y = snapshot.mouseY;
+	event.shift = snapshot.shift;
+	event.ctrl = snapshot.ctrl;
+	if (snapshot.leftPressed) {
+		event.type = InputEventType::CLICK;
+		m_events.push_back(event);
+	}
+	if (snapshot.leftDown && snapshot.moved && !snapshot.leftPressed) {
+		event.type = InputEventType::DRAG;
+		event.dx = snapshot.mouseX - snapshot.previousMouseX;
+		event.dy = snapshot.mouseY - snapshot.previousMouseY;
+		m_events.push_back(event);
+	}
+	if (snapshot.leftReleased) {
+		event.type = InputEventType::RELEASE;
+		m_events.push_back(event);
+	}
+
+	// the key events. One pass over the keys we care about, once per frame, however many widgets want keys.
+	float now{ graphics::getGlobalTime() };
+	auto captureKey{ [this, now](int key) {
+		bool down{ graphics::getKeyState(static_cast<graphics::scancode_t>(key)) };
+		if (down && !m_keys[key]) {
+			pushKey(InputEventType::KEY_DOWN, key);
+			m_nextRepeat[key] = now + INPUT_REPEAT_DELAY;
+		}
+		else if (down) {
+			for (unsigned int repeats{ 0 }; now >= m_nextRepeat[key]; ++repeats) {
+				if (repeats < c_maxRepeatsPerFrame) {
+					pushKey(InputEventType::KEY_REPEAT, key);
+				}
+				m_nextRepeat[key] += INPUT_REPEAT_INTERVAL;
+			}
+		}
+		else if (m_keys[key]) {
+			pushKey(InputEventType::KEY_UP, key);
+		}
+		m_keys[key] = down;
+	} };
+
+	for (int key{ c_firstKey }; key <= c_lastKey; ++key) {
+		captureKey(key);
+	}
+	for (int key{ c_firstModifier }; key <= c_lastModifier; ++key) {
+		captureKey(key);
+	}
+}
+
+bool InputManager::wasKeyPressed(graphics::scancode_t key) const
+{
+	for (const auto& event : m_events) {
+		if (event.type == InputEventType::KEY_DOWN && event.key == key) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "global.h"
+#include "graphics.h"
+
+#include <vector>
+#include <bitset>
+
+/* InputManager: Reads the mouse and keyboard exactly once per frame (capture()), and turns the difference from the
+ * previous frame into discrete events. Nothing else in our project calls graphics::getMouseState() or getKeyState():
+ * widgets get the events FilmUI routes to them through Widget::onEvent(), and anything that needs the current mouse
+ * position or button state reads it from the snapshot.
+ *
+ * Key repeat is generated here, per key, from the global time: a held key repeats INPUT_REPEAT_DELAY ms after it went
+ * down, then every INPUT_REPEAT_INTERVAL ms, no matter how irregular our frames are. SGG only lets us see which keys are
+ * down at the time of a frame though, so a key pressed and released between two frames can never be seen.
+ *
+ * Text is produced for a US keyboard layout: letters, digits, space and the punctuation on the main block. */
+
+enum class InputEventType {
+	KEY_DOWN,		// a key went down
+	KEY_REPEAT,		// a held key repeated
+	KEY_UP,			// a key was released
+	TEXT,			// a character was typed (on key down and on every repeat)
+	CLICK,			// the left mouse button went down
+	RELEASE,		// the left mouse button was released
+	DRAG			// the mouse moved while the left mouse button was held down
+};
+
+struct InputEvent {
+	InputEventType type;
+	graphics::scancode_t key{ graphics::SCANCODE_UNKNOWN };		// KEY_DOWN, KEY_REPEAT, KEY_UP, and the key that typed a TEXT
+	char character{ '\0' };									// TEXT
+	float x{ 0.0f };										// the mouse position at the time of the event, in canvas units
+	float y{ 0.0f };
+	float dx{ 0.0f };										// DRAG: how far the mouse moved since the previous frame
+	float dy{ 0.0f };
+	bool shift{ false };									// the modifiers held at the time of the event
+	bool ctrl{ false };
+};
+
+// InputSnapshot: the state of the mouse for the current frame, in canvas units
+struct InputSnapshot {
+	float mouseX{ 0.0f };
+	float mouseY{ 0.0f };
+	float previousMouseX{ 0.0f };
+	float previousMouseY{ 0.0f };
+	bool leftDown{ false };
+	bool leftPressed{ false };
+	bool leftReleased{ false };
+	bool dragging{ false };
+	bool moved{ false };
+	bool shift{ false };
+	bool ctrl{ false };
+};
+
+class InputManager {
+private:
+	// the range of scancodes we look at: everything from A to the arrow keys, plus the modifiers
+	static constexpr int c_firstKey{ graphics::SCANCODE_A };
+	static constexpr int c_lastKey{ graphics::SCANCODE_UP };
+	static constexpr int c_firstModifier{ graphics::SCANCODE_LCTRL };
+	static constexpr int c_lastModifier{ graphics::SCANCODE_RGUI };
+	static constexpr int c_keyCount{ c_lastModifier + 1 };
+
+	// the most repeats a key generates in a single frame, so that a long stall doesn't turn into a burst of repeats
+	static constexpr unsigned int c_maxRepeatsPerFrame{ 4 };
+
+	static inline InputManager* s_instance{ nullptr };
+
+	InputSnapshot m_snapshot;
+	std::vector<InputEvent> m_events;
+
+	std::bitset<c_keyCount> m_keys;
+	float m_nextRepeat[c_keyCount]{};		// the global time each held key repeats next
+
+	// pushes a key event, along with the TEXT event of the key, if it types anything
+	void pushKey(InputEventType type, int key);
+
+	// the character a key types with the given modifiers, or '\0'
+	static char characterOf(int key, bool shift);
+
+	InputManager();
+
+public:
+	static InputManager* getInstance();
+	static void releaseInstance();
+
+	// Called once, at the start of every frame. Takes the snapshot and replaces the events of the previous frame.
+	void capture();
+
+	const InputSnapshot& getSnapshot() const				{ return m_snapshot; }
+	const std::vector<InputEvent>& getEvents() const		{ return m_events; }
+
+	// true if anything at all happened this frame: any event, or the mouse moved
+	bool hasActivity() const								{ return !m_events.empty() || m_snapshot.moved; }
+
+	bool isKeyDown(graphics::scancode_t key) const			{ return key < c_keyCount && m_keys[key]; }
+
+	// true if the key went down this frame (not on repeats)
+	bool wasKeyPressed(graphics::scancode_t key) const;
+};
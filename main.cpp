@@ -3,6 +3,19 @@
 #include "global.h"
 #include "filmui.h"
 #include "film.h"
+#include "renderqueue.h"
+#include "postercache.h"
+#include "thumbnailcache.h"
+#include "taskscheduler.h"
+#include "profiler.h"
+#include "inputmanager.h"
+#include "filterbenchmark.h"
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <iostream>
 
 void update(float ms)
 {
@@ -17,7 +30,31 @@ void draw()
     filmUI->draw();
 }
 
-int main(int argc, char* argv) {
+int main(int argc, char* argv[]) {
+
+    // offline step: bake the poster thumbnails and exit, without ever opening a window
+    if (argc > 1 && std::string{ argv[1] } == "--bake-thumbnails") {
+        ThumbnailCache* thumbnails{ ThumbnailCache::getInstance() };
+        thumbnails->load();
+        std::cout << "Baked " << thumbnails->bake() << " thumbnail(s)." << std::endl;
+        ThumbnailCache::releaseInstance();
+        TaskScheduler::releaseInstance();
+        return 0;
+    }
+
+    // offline step: time the specialised filter kernels against the generic filter on a synthetic catalog, and exit
+    if (argc > 1 && std::string{ argv[1] } == "--bench-filters") {
+        size_t films{ 100000 };
+        if (argc > 2) {
+            const std::string_view count{ argv[2] };
+            const auto [end, error] { std::from_chars(count.data(), count.data() + count.size(), films) };
+            if (error != std::errc{} || end != count.data() + count.size()) {
+                std::cerr << "usage: FilmGUI --bench-filters [number of films]" << std::endl;
+                return 1;
+            }
+        }
+        return runFilterBenchmark(films) ? 0 : 1;
+    }
 
     graphics::createWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "FilmGUI");
 
@@ -30,10 +67,20 @@ int main(int argc, char* argv) {
     graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
 
     filmUI->init();
+#ifndef FILMGUI_HEADLESS
+    // the headless backend runs a fixed number of frames as fast as it can, sleeping would only skew its timings
+    filmUI->setIdleMode(true);
+#endif
     graphics::startMessageLoop();
     graphics::destroyWindow();
     
     FilmUI::releaseInstance();
+    RenderQueue::releaseInstance();
+    PosterCache::releaseInstance();
+    ThumbnailCache::releaseInstance();
+    TaskScheduler::releaseInstance();
+    Profiler::releaseInstance();
+    InputManager::releaseInstance();
 
     return 0;
 }
\ No newline at end of file
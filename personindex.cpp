@@ -0,0 +1,183 @@
+#include "personindex.h"
+
+#include <algorithm>
+#include <utility>
+#include <cctype>
+#include <iterator>
+
+PersonId PersonIndex::intern(const std::string& name)
+{
+	auto [iter, added] { m_ids.try_emplace(name, static_cast<PersonId>(m_names.size())) };
+	if (added) {
+		m_names.push_back(name);
+		std::string searchName{ name };
+		std::transform(searchName.begin(), searchName.end(), searchName.begin(), ::tolower);
+		m_searchNames.push_back(std::move(searchName));
+	}
+	return iter->second;
+}
+
+void PersonIndex::addCredits(const FilmCredits& film, std::vector<PersonId>& credits, std::vector<CreditKind>& kinds)
+{
+	const size_t first{ credits.size() };
+	auto credit{ [&](const std::string& name, CreditKind kind) {
+		PersonId person{ intern(name) };
+		for (size_t i{ first }; i < credits.size(); ++i) {
+			if (credits[i] == person) {
+				kinds[i] = static_cast<CreditKind>(static_cast<unsigned char>(kinds[i]) | static_cast<unsigned char>(kind));
+				return person;
+			}
+		}
+		credits.push_back(person);
+		kinds.push_back(kind);
+		return person;
+	} };
+	m_directors.push_back(film.director->empty() ? c_noPerson : credit(*film.director, CreditKind::DIRECTED));
+	unsigned short billing{ 0 };
+	for (const CastMember& member : *film.cast) {
+		if (!member.name.empty()) {
+			m_cast.push_back({ credit(member.name, CreditKind::ACTED), billing++, member.role });
+		}
+	}
+	m_castOffsets.push_back(static_cast<unsigned int>(m_cast.size()));
+}
+
+void PersonIndex::build(std::span<const FilmCredits> films)
+{
+	m_names.clear();
+	m_searchNames.clear();
+	m_ids.clear();
+	m_castOffsets.assign(1, 0);
+	m_cast.clear();
+	m_directors.clear();
+
+	/* the credits of every film first, a person once per film even if they are credited twice (directing and acting, say),
+	 * along with what they did in it. The casts are written out as they go, since they are in film order anyway. Then,
+	 * per kind of filmography, one pass over the credits counts everyone's films, which gives the offsets, and another
+	 * writes the films in. Going through the films in FilmId order leaves every filmography sorted. */
+	std::vector<PersonId> credits;
+	std::vector<CreditKind> kinds;
+	std::vector<unsigned int> creditOffsets{ 0 };
+	for (const FilmCredits& film : films) {
+		addCredits(film, credits, kinds);
+		creditOffsets.push_back(static_cast<unsigned int>(credits.size()));
+	}
+
+	for (const CreditKind kind : { CreditKind::DIRECTED, CreditKind::ACTED, CreditKind::ANY }) {
+		Filmographies& filmographies{ m_filmographies[static_cast<unsigned int>(kind) - 1] };
+		filmographies.offsets.assign(m_names.size() + 1, 0);
+		for (size_t credit{ 0 }; credit < credits.size(); ++credit) {
+			if (hasKind(kinds[credit], kind)) {
+				++filmographies.offsets[credits[credit] + 1];
+			}
+		}
+		for (size_t person{ 0 }; person < m_names.size(); ++person) {
+			filmographies.offsets[person + 1] += filmographies.offsets[person];
+		}
+
+		filmographies.films.resize(filmographies.offsets.back());
+		std::vector<unsigned int> next(filmographies.offsets.begin(), filmographies.offsets.end() - 1);
+		for (size_t film{ 0 }; film < films.size(); ++film) {
+			for (unsigned int credit{ creditOffsets[film] }; credit < creditOffsets[film + 1]; ++credit) {
+				if (hasKind(kinds[credit], kind)) {
+					filmographies.films[next[credits[credit]]++] = static_cast<FilmId>(film);
+				}
+			}
+		}
+	}
+}
+
+void PersonIndex::update(const PersonIndex& previous, const FilmRemap& remap, std::span<const FilmCredits> added)
+{
+	m_names = previous.m_names;
+	m_searchNames = previous.m_searchNames;
+	m_ids = previous.m_ids;
+	m_castOffsets.assign(1, 0);
+	m_cast.clear();
+	m_directors.clear();
+
+	/* the casts and directors in the new FilmId order: the films that stay copy theirs over, the added ones are credited
+	 * like build() does, their credits kept (by the added film) for the filmographies */
+	std::vector<size_t> addedIndex(remap.size(), 0);
+	for (size_t index{ 0 }; index < remap.added.size(); ++index) {
+		addedIndex[remap.added[index]] = index;
+	}
+	std::vector<PersonId> credits;
+	std::vector<CreditKind> kinds;
+	std::vector<FilmId> creditFilms;
+	for (size_t id{ 0 }; id < remap.size(); ++id) {
+		if (remap.isAdded(static_cast<FilmId>(id))) {
+			addCredits(added[addedIndex[id]], credits, kinds);
+			creditFilms.resize(credits.size(), static_cast<FilmId>(id));
+			continue;
+		}
+		const FilmId old{ remap.newToOld[id] };
+		const std::span<const Credit> cast{ previous.cast(old) };
+		m_cast.insert(m_cast.end(), cast.begin(), cast.end());
+		m_castOffsets.push_back(static_cast<unsigned int>(m_cast.size()));
+		m_directors.push_back(previous.m_directors[old]);
+	}
+
+	/* everyone's filmography of each kind: their old one remapped (which leaves it sorted, and drops the removed films),
+	 * merged with the added films they are credited on */
+	for (const CreditKind kind : { CreditKind::DIRECTED, CreditKind::ACTED, CreditKind::ANY }) {
+		const Filmographies& before{ previous.m_filmographies[static_cast<unsigned int>(kind) - 1] };
+		Filmographies& filmographies{ m_filmographies[static_cast<unsigned int>(kind) - 1] };
+
+		std::vector<std::pair<PersonId, FilmId>> fresh;
+		for (size_t credit{ 0 }; credit < credits.size(); ++credit) {
+			if (hasKind(kinds[credit], kind)) {
+				fresh.emplace_back(credits[credit], creditFilms[credit]);
+			}
+		}
+		std::sort(fresh.begin(), fresh.end());
+
+		filmographies.offsets.assign(1, 0);
+		filmographies.offsets.reserve(m_names.size() + 1);
+		filmographies.films.clear();
+		filmographies.films.reserve(before.films.size() + fresh.size());
+		std::vector<FilmId> remapped;
+		std::vector<FilmId> credited;
+		auto next{ fresh.begin() };
+		for (PersonId person{ 0 }; person < m_names.size(); ++person) {
+			remapped.clear();
+			if (person < previous.m_names.size()) {
+				for (unsigned int film{ before.offsets[person] }; film < before.offsets[person + 1]; ++film) {
+					if (remap.oldToNew[before.films[film]] != c_noFilm) {
+						remapped.push_back(remap.oldToNew[before.films[film]]);
+					}
+				}
+			}
+			credited.clear();
+			for (; next != fresh.end() && next->first == person; ++next) {
+				credited.push_back(next->second);
+			}
+			std::merge(remapped.begin(), remapped.end(), credited.begin(), credited.end(), std::back_inserter(filmographies.films));
+			filmographies.offsets.push_back(static_cast<unsigned int>(filmographies.films.size()));
+		}
+	}
+}
+
+PersonId PersonIndex::find(const std::string& name) const
+{
+	auto iter{ m_ids.find(name) };
+	return iter == m_ids.end() ? c_noPerson : iter->second;
+}
+
+std::span<const FilmId> PersonIndex::filmography(PersonId person, CreditKind kind) const
+{
+	if (person >= m_names.size()) {
+		return {};
+	}
+	const Filmographies& filmographies{ m_filmographies[static_cast<unsigned int>(kind) - 1] };
+	const unsigned int first{ filmographies.offsets[person] };
+	return std::span<const FilmId>{ filmographies.films }.subspan(first, filmographies.offsets[person + 1] - first);
+}
+
+std::span<const Credit> PersonIndex::cast(FilmId film) const
+{
+	if (film + 1 >= m_castOffsets.size()) {
+		return {};
+	}
+	return std::span<const Credit>{ m_cast }.subspan(m_castOffsets[film], m_castOffsets[film + 1] - m_castOffsets[film]);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "filmbitmap.h"
+#include "filmutil.h"
+#include "filmremap.h"
+
+#include <string>
+#include <vector>
+#include <span>
+#include <unordered_map>
+
+/* PersonIndex: Everyone who directed or played in a film, with the films they did, so that a person's filmography is a
+ * lookup instead of a substring search over every cast.
+ *
+ * The filmographies are stored in CSR form: one array with the FilmIds of every person's films, one person after the
+ * other, and one array of offsets into it, where person p's films are films[offsets[p]] up to films[offsets[p + 1]].
+ * Each filmography is in FilmId order. There is one such pair of arrays for the films people directed, one for those
+ * they acted in, and one for both, so that whichever is asked for is a sorted run of films already.
+ *
+ * The casts are stored the same way the other way round: one array with the Credits of every film's cast, in billing
+ * order, and one array of offsets into it by FilmId. A cast takes as much room as it has members, however long it is.
+ * Built along with the catalog, and updated along with it: PersonIds never change, so someone who is no longer in any
+ * film keeps their id (with no films), and the people of the added films that are new get the next ones. */
+
+using PersonId = unsigned int;
+inline constexpr PersonId c_noPerson{ ~0u };
+
+// CreditKind: What someone did in a film, as bits, so that ANY is both
+enum class CreditKind : unsigned char { DIRECTED = 1, ACTED = 2, ANY = 3 };
+
+inline bool hasKind(CreditKind credited, CreditKind wanted)	{ return static_cast<unsigned char>(credited) & static_cast<unsigned char>(wanted); }
+
+// Credit: one cast member of a film, as the PersonIndex stores it
+struct Credit {
+	PersonId person;
+	unsigned short billing;									// 0 for the first billed
+	Role role;
+};
+
+// FilmCredits: The people of one film, which is all the PersonIndex needs to know about it
+struct FilmCredits {
+	const std::string* director;
+	const std::vector<CastMember>* cast;
+};
+
+class PersonIndex {
+private:
+	std::vector<std::string> m_names;						// by PersonId
+	std::vector<std::string> m_searchNames;					// by PersonId, lowercase, what searches compare against
+	std::unordered_map<std::string, PersonId> m_ids;		// by name, exactly as the films spell it
+
+	// Filmographies: everyone's films of one kind, in CSR form
+	struct Filmographies {
+		std::vector<unsigned int> offsets;					// m_names.size() + 1 of them
+		std::vector<FilmId> films;
+	};
+	Filmographies m_filmographies[3];						// by CreditKind - 1
+	std::vector<PersonId> m_directors;						// by FilmId
+
+	std::vector<unsigned int> m_castOffsets;				// one per film, and one more
+	std::vector<Credit> m_cast;
+
+	// the id of a name, adding it if it is new
+	PersonId intern(const std::string& name);
+
+	// adds a film (the next FilmId) to the casts and directors, and its people to credits, each once, with what they did
+	void addCredits(const FilmCredits& film, std::vector<PersonId>& credits, std::vector<CreditKind>& kinds);
+
+public:
+	// (Re)builds the index from the people of the films of a catalog, in FilmId order
+	void build(std::span<const FilmCredits> films);
+
+	// Builds the index of a catalog that was updated (by remap) from the one of the previous index: the films that stay
+	// are carried over, and only the credits of the added ones (in the order of remap.added) are looked at
+	void update(const PersonIndex& previous, const FilmRemap& remap, std::span<const FilmCredits> added);
+
+	// The id of the person with the given name, or c_noPerson
+	PersonId find(const std::string& name) const;
+
+	// The films a person directed, acted in, or either
+	std::span<const FilmId> filmography(PersonId person, CreditKind kind = CreditKind::ANY) const;
+	std::span<const Credit> cast(FilmId film) const;
+	PersonId director(FilmId film) const					{ return m_directors[film]; }
+
+	const std::string& name(PersonId person) const			{ return m_names[person]; }
+	size_t size() const										{ return m_names.size(); }
+	size_t filmCount() const								{ return m_directors.size(); }
+
+	// for the catalog's view: the lowercase names, and the casts in CSR form
+	std::span<const std::string> searchNames() const		{ return m_searchNames; }
+	std::span<const unsigned int> castOffsets() const		{ return m_castOffsets; }
+	std::span<const Credit> credits() const					{ return m_cast; }
+};
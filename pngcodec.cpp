@@ -0,0 +1,510 @@
+#include "pngcodec.h"
+
+#include <vector>
+#include <string>
+#include <array>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+	// reads a deflate stream bit by bit, least significant bit first
+	class BitReader {
+	private:
+		const unsigned char* m_data;
+		size_t m_size;
+		size_t m_pos{ 0 };
+		unsigned int m_buffer{ 0 };
+		int m_count{ 0 };
+
+	public:
+		bool m_failed{ false };
+
+		BitReader(const unsigned char* data, size_t size) : m_data{ data }, m_size{ size } {}
+
+		unsigned int bits(int n)
+		{
+			while (m_count < n) {
+				if (m_pos >= m_size) {
+					m_failed = true;
+					return 0;
+				}
+				m_buffer |= static_cast<unsigned int>(m_data[m_pos++]) << m_count;
+				m_count += 8;
+			}
+			unsigned int value{ m_buffer & ((1u << n) - 1) };
+			m_buffer >>= n;
+			m_count -= n;
+			return value;
+		}
+
+		// stored blocks start at a byte boundary, so dropping whatever is left of the current byte
+		void alignToByte()
+		{
+			m_buffer >>= m_count % 8;
+			m_count -= m_count % 8;
+		}
+	};
+
+	// a canonical Huffman code: how many codes there are of every length, and the symbols ordered by code
+	struct Huffman {
+		std::array<unsigned short, 16> counts{};
+		std::vector<unsigned short> symbols;
+	};
+
+	void buildHuffman(Huffman& huffman, const unsigned char* lengths, int n)
+	{
+		huffman.counts.fill(0);
+		for (int i{ 0 }; i < n; ++i) {
+			++huffman.counts[lengths[i]];
+		}
+		huffman.counts[0] = 0;
+
+		std::array<unsigned short, 16> offsets{};
+		for (int len{ 1 }; len < 16; ++len) {
+			offsets[len] = offsets[len - 1] + huffman.counts[len - 1];
+		}
+		huffman.symbols.assign(n, 0);
+		for (int i{ 0 }; i < n; ++i) {
+			if (lengths[i] != 0) {
+				huffman.symbols[offsets[lengths[i]]++] = static_cast<unsigned short>(i);
+			}
+		}
+	}
+
+	// the codes of a block compressed with fixed Huffman codes: literals/lengths 0-143 in 8 bits, 144-255 in 9, 256-279 in 7
+	// and 280-287 in 8, distances all in 5
+	Huffman fixedLengths()
+	{
+		unsigned char lengths[288];
+		std::fill(lengths, lengths + 144, 8);
+		std::fill(lengths + 144, lengths + 256, 9);
+		std::fill(lengths + 256, lengths + 280, 7);
+		std::fill(lengths + 280, lengths + 288, 8);
+		Huffman huffman;
+		buildHuffman(huffman, lengths, 288);
+		return huffman;
+	}
+
+	Huffman fixedDistances()
+	{
+		unsigned char lengths[30];
+		std::fill(lengths, lengths + 30, 5);
+		Huffman huffman;
+		buildHuffman(huffman, lengths, 30);
+		return huffman;
+	}
+
+	int decodeSymbol(BitReader& reader, const Huffman& huffman)
+	{
+		int code{ 0 };
+		int first{ 0 };
+		int index{ 0 };
+		for (int len{ 1 }; len < 16; ++len) {
+			code |= reader.bits(1);
+			int count{ huffman.counts[len] };
+			if (code - count < first) {
+				return huffman.symbols[index + (code - first)];
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+		reader.m_failed = true;
+		return -1;
+	}
+
+	constexpr unsigned short c_lengthBase[29]{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr unsigned char c_lengthExtra[29]{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr unsigned short c_distanceBase[30]{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr unsigned char c_distanceExtra[30]{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	bool inflateBlock(BitReader& reader, std::vector<unsigned char>& out, const Huffman& lengths, const Huffman& distances)
+	{
+		while (!reader.m_failed) {
+			int symbol{ decodeSymbol(reader, lengths) };
+			if (symbol < 0) {
+				return false;
+			}
+			if (symbol < 256) {
+				out.push_back(static_cast<unsigned char>(symbol));
+				continue;
+			}
+			if (symbol == 256) {
+				return true;
+			}
+
+			symbol -= 257;
+			if (symbol >= 29) {
+				return false;
+			}
+			size_t length{ c_lengthBase[symbol] + reader.bits(c_lengthExtra[symbol]) };
+			int distanceSymbol{ decodeSymbol(reader, distances) };
+			if (distanceSymbol < 0 || distanceSymbol >= 30) {
+				return false;
+			}
+			size_t distance{ c_distanceBase[distanceSymbol] + reader.bits(c_distanceExtra[distanceSymbol]) };
+			if (distance > out.size()) {
+				return false;
+			}
+			// copying byte by byte on purpose: the source and destination of a match may overlap
+			size_t from{ out.size() - distance };
+			for (size_t i{ 0 }; i < length; ++i) {
+				out.push_back(out[from + i]);
+			}
+		}
+		return false;
+	}
+
+	// inflates a zlib stream (2 byte header, deflate blocks, adler32 we don't bother checking)
+	bool inflateZlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+	{
+		if (in.size() < 2 || (in[0] & 0x0F) != 8) {
+			return false;
+		}
+		BitReader reader{ in.data() + 2, in.size() - 2 };
+
+		bool last{ false };
+		while (!last) {
+			last = reader.bits(1);
+			unsigned int type{ reader.bits(2) };
+
+			if (type == 0) {
+				reader.alignToByte();
+				unsigned int length{ reader.bits(16) };
+				unsigned int complement{ reader.bits(16) };
+				if ((length ^ 0xFFFF) != complement) {
+					return false;
+				}
+				for (unsigned int i{ 0 }; i < length && !reader.m_failed; ++i) {
+					out.push_back(static_cast<unsigned char>(reader.bits(8)));
+				}
+			}
+			else if (type == 1) {
+				// built once, on whichever thread gets here first: the thumbnail baker inflates posters on several at a time
+				static const Huffman lengths{ fixedLengths() };
+				static const Huffman distances{ fixedDistances() };
+				if (!inflateBlock(reader, out, lengths, distances)) {
+					return false;
+				}
+			}
+			else if (type == 2) {
+				unsigned int literalCount{ reader.bits(5) + 257 };
+				unsigned int distanceCount{ reader.bits(5) + 1 };
+				unsigned int codeLengthCount{ reader.bits(4) + 4 };
+
+				static const unsigned char order[19]{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+				unsigned char codeLengths[19]{};
+				for (unsigned int i{ 0 }; i < codeLengthCount; ++i) {
+					codeLengths[order[i]] = static_cast<unsigned char>(reader.bits(3));
+				}
+				Huffman codeLengthHuffman;
+				buildHuffman(codeLengthHuffman, codeLengths, 19);
+
+				unsigned char lengths[320]{};
+				unsigned int n{ 0 };
+				while (n < literalCount + distanceCount && !reader.m_failed) {
+					int symbol{ decodeSymbol(reader, codeLengthHuffman) };
+					if (symbol < 0) {
+						return false;
+					}
+					if (symbol < 16) {
+						lengths[n++] = static_cast<unsigned char>(symbol);
+						continue;
+					}
+					unsigned char repeated{ 0 };
+					unsigned int times{ 0 };
+					if (symbol == 16) {
+						if (n == 0) {
+							return false;
+						}
+						repeated = lengths[n - 1];
+						times = 3 + reader.bits(2);
+					}
+					else if (symbol == 17) {
+						times = 3 + reader.bits(3);
+					}
+					else {
+						times = 11 + reader.bits(7);
+					}
+					if (n + times > literalCount + distanceCount) {
+						return false;
+					}
+					std::fill(lengths + n, lengths + n + times, repeated);
+					n += times;
+				}
+
+				Huffman literalHuffman;
+				Huffman distanceHuffman;
+				buildHuffman(literalHuffman, lengths, literalCount);
+				buildHuffman(distanceHuffman, lengths + literalCount, distanceCount);
+				if (!inflateBlock(reader, out, literalHuffman, distanceHuffman)) {
+					return false;
+				}
+			}
+			else {
+				return false;
+			}
+			if (reader.m_failed) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	unsigned int readBigEndian(const unsigned char* data)
+	{
+		return (static_cast<unsigned int>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+	}
+
+	void writeBigEndian(std::vector<unsigned char>& out, unsigned int value)
+	{
+		out.push_back(static_cast<unsigned char>(value >> 24));
+		out.push_back(static_cast<unsigned char>(value >> 16));
+		out.push_back(static_cast<unsigned char>(value >> 8));
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	// the CRC of every byte, worked out at compile time
+	constexpr std::array<unsigned int, 256> c_crcTable{ [] {
+		std::array<unsigned int, 256> table{};
+		for (unsigned int i{ 0 }; i < 256; ++i) {
+			unsigned int c{ i };
+			for (int k{ 0 }; k < 8; ++k) {
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table[i] = c;
+		}
+		return table;
+	}() };
+
+	unsigned int crc32(const unsigned char* data, size_t size)
+	{
+		unsigned int crc{ 0xFFFFFFFFu };
+		for (size_t i{ 0 }; i < size; ++i) {
+			crc = c_crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	void writeChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+	{
+		writeBigEndian(out, static_cast<unsigned int>(data.size()));
+		size_t start{ out.size() };
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		writeBigEndian(out, crc32(out.data() + start, out.size() - start));
+	}
+
+	unsigned char paeth(int a, int b, int c)
+	{
+		int p{ a + b - c };
+		int pa{ std::abs(p - a) };
+		int pb{ std::abs(p - b) };
+		int pc{ std::abs(p - c) };
+		if (pa <= pb && pa <= pc) {
+			return static_cast<unsigned char>(a);
+		}
+		return static_cast<unsigned char>(pb <= pc ? b : c);
+	}
+
+	const unsigned char c_signature[8]{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+}
+
+bool decodePng(const std::vector<unsigned char>& file, Image& image)
+{
+	if (file.size() < 8 || std::memcmp(file.data(), c_signature, 8) != 0) {
+		return false;
+	}
+
+	unsigned int width{ 0 };
+	unsigned int height{ 0 };
+	unsigned char colourType{ 0 };
+	std::vector<unsigned char> palette;
+	std::vector<unsigned char> compressed;
+
+	// walking through the chunks, keeping what we need: the header, the palette and the (concatenated) image data
+	size_t pos{ 8 };
+	while (pos + 12 <= file.size()) {
+		unsigned int length{ readBigEndian(&file[pos]) };
+		const unsigned char* type{ &file[pos + 4] };
+		const unsigned char* data{ &file[pos + 8] };
+		if (pos + 12 + length > file.size()) {
+			return false;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0) {
+			width = readBigEndian(data);
+			height = readBigEndian(data + 4);
+			colourType = data[9];
+			// 8 bits per channel, no interlacing
+			if (data[8] != 8 || data[12] != 0) {
+				return false;
+			}
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0) {
+			palette.assign(data, data + length);
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), data, data + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		pos += 12 + length;
+	}
+
+	unsigned int channels{ 0 };
+	switch (colourType) {
+	case 0: channels = 1; break;	// greyscale
+	case 2: channels = 3; break;	// RGB
+	case 3: channels = 1; break;	// palette
+	case 4: channels = 2; break;	// greyscale + alpha
+	case 6: channels = 4; break;	// RGBA
+	default: return false;
+	}
+	if (width == 0 || height == 0 || (colourType == 3 && palette.empty())) {
+		return false;
+	}
+
+	std::vector<unsigned char> raw;
+	raw.reserve(static_cast<size_t>(width * channels + 1) * height);
+	if (!inflateZlib(compressed, raw)) {
+		return false;
+	}
+	size_t stride{ static_cast<size_t>(width) * channels };
+	if (raw.size() < (stride + 1) * height) {
+		return false;
+	}
+
+	// undoing the per-scanline filters in place
+	std::vector<unsigned char> previous(stride, 0);
+	for (unsigned int y{ 0 }; y < height; ++y) {
+		unsigned char filter{ raw[y * (stride + 1)] };
+		unsigned char* line{ &raw[y * (stride + 1) + 1] };
+		for (size_t x{ 0 }; x < stride; ++x) {
+			int a{ x >= channels ? line[x - channels] : 0 };
+			int b{ previous[x] };
+			int c{ x >= channels ? previous[x - channels] : 0 };
+			switch (filter) {
+			case 0: break;
+			case 1: line[x] = static_cast<unsigned char>(line[x] + a); break;
+			case 2: line[x] = static_cast<unsigned char>(line[x] + b); break;
+			case 3: line[x] = static_cast<unsigned char>(line[x] + (a + b) / 2); break;
+			case 4: line[x] = static_cast<unsigned char>(line[x] + paeth(a, b, c)); break;
+			default: return false;
+			}
+		}
+		std::memcpy(previous.data(), line, stride);
+	}
+
+	// converting everything to RGBA
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 4);
+	for (unsigned int y{ 0 }; y < height; ++y) {
+		const unsigned char* line{ &raw[y * (stride + 1) + 1] };
+		unsigned char* out{ &image.pixels[static_cast<size_t>(y) * width * 4] };
+		for (unsigned int x{ 0 }; x < width; ++x, out += 4) {
+			const unsigned char* in{ line + x * channels };
+			switch (colourType) {
+			case 0: out[0] = out[1] = out[2] = in[0]; out[3] = 255; break;
+			case 2: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255; break;
+			case 4: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break;
+			case 6: std::memcpy(out, in, 4); break;
+			case 3:
+				if (static_cast<size_t>(in[0]) * 3 + 2 >= palette.size()) {
+					return false;
+				}
+				out[0] = palette[in[0] * 3];
+				out[1] = palette[in[0] * 3 + 1];
+				out[2] = palette[in[0] * 3 + 2];
+				out[3] = 255;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+std::vector<unsigned char> encodePng(const Image& image)
+{
+	std::vector<unsigned char> out(c_signature, c_signature + 8);
+
+	std::vector<unsigned char> header;
+	writeBigEndian(header, image.width);
+	writeBigEndian(header, image.height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });		// 8 bits, RGBA, deflate, standard filters, no interlacing
+	writeChunk(out, "IHDR", header);
+
+	// the raw scanlines, each prefixed with filter type 0 (none)
+	size_t stride{ static_cast<size_t>(image.width) * 4 };
+	std::vector<unsigned char> raw;
+	raw.reserve((stride + 1) * image.height);
+	for (unsigned int y{ 0 }; y < image.height; ++y) {
+		raw.push_back(0);
+		raw.insert(raw.end(), image.pixels.begin() + y * stride, image.pixels.begin() + (y + 1) * stride);
+	}
+
+	// zlib stream made of stored (uncompressed) deflate blocks of at most 65535 bytes
+	std::vector<unsigned char> zlib{ 0x78, 0x01 };
+	size_t pos{ 0 };
+	do {
+		size_t length{ std::min<size_t>(raw.size() - pos, 65535) };
+		zlib.push_back(pos + length == raw.size() ? 1 : 0);
+		zlib.push_back(static_cast<unsigned char>(length));
+		zlib.push_back(static_cast<unsigned char>(length >> 8));
+		zlib.push_back(static_cast<unsigned char>(~length));
+		zlib.push_back(static_cast<unsigned char>(~length >> 8));
+		zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+		pos += length;
+	} while (pos < raw.size());
+
+	unsigned int a{ 1 };
+	unsigned int b{ 0 };
+	for (const auto byte : raw) {
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	writeBigEndian(zlib, (b << 16) | a);
+	writeChunk(out, "IDAT", zlib);
+
+	writeChunk(out, "IEND", {});
+	return out;
+}
+
+Image downsampleImage(const Image& source, unsigned int width, unsigned int height)
+{
+	Image result;
+	result.width = width;
+	result.height = height;
+	result.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+	for (unsigned int y{ 0 }; y < height; ++y) {
+		unsigned int y0{ static_cast<unsigned int>(static_cast<unsigned long long>(y) * source.height / height) };
+		unsigned int y1{ std::max(y0 + 1, static_cast<unsigned int>(static_cast<unsigned long long>(y + 1) * source.height / height)) };
+		for (unsigned int x{ 0 }; x < width; ++x) {
+			unsigned int x0{ static_cast<unsigned int>(static_cast<unsigned long long>(x) * source.width / width) };
+			unsigned int x1{ std::max(x0 + 1, static_cast<unsigned int>(static_cast<unsigned long long>(x + 1) * source.width / width)) };
+
+			unsigned long long sum[4]{};
+			for (unsigned int sy{ y0 }; sy < y1; ++sy) {
+				const unsigned char* in{ &source.pixels[(static_cast<size_t>(sy) * source.width + x0) * 4] };
+				for (unsigned int sx{ x0 }; sx < x1; ++sx, in += 4) {
+					sum[0] += in[0];
+					sum[1] += in[1];
+					sum[2] += in[2];
+					sum[3] += in[3];
+				}
+			}
+			unsigned long long count{ static_cast<unsigned long long>(y1 - y0) * (x1 - x0) };
+			unsigned char* out{ &result.pixels[(static_cast<size_t>(y) * width + x) * 4] };
+			for (int c{ 0 }; c < 4; ++c) {
+				out[c] = static_cast<unsigned char>(sum[c] / count);
+			}
+		}
+	}
+	return result;
+}
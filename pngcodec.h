@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <string>
+
+/* pngcodec.h: A small, self-contained PNG decoder/encoder, used to bake poster thumbnails (see ThumbnailCache). SGG does
+ * its own decoding when drawing, so this is only needed offline and covers what our assets actually use: 8 bits per
+ * channel, non-interlaced, greyscale/RGB/palette with or without alpha. The encoder always writes RGBA and does not
+ * compress (stored deflate blocks), since the thumbnails it writes are tiny anyway. */
+
+// Image: an 8 bit RGBA bitmap, rows top to bottom
+struct Image {
+	unsigned int width{ 0 };
+	unsigned int height{ 0 };
+	std::vector<unsigned char> pixels;		// width * height * 4 bytes
+};
+
+// decodes the contents of a PNG file into an RGBA image. Returns false on anything malformed or unsupported.
+bool decodePng(const std::vector<unsigned char>& file, Image& image);
+
+// encodes an RGBA image into the contents of a PNG file
+std::vector<unsigned char> encodePng(const Image& image);
+
+// downsamples an image to the given size, averaging every source pixel that falls in each destination pixel (box filter)
+Image downsampleImage(const Image& source, unsigned int width, unsigned int height);
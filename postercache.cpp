@@ -0,0 +1,173 @@
+#include "postercache.h"
+#include "global.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+PosterCache* PosterCache::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new PosterCache();
+	}
+	return s_instance;
+}
+
+void PosterCache::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+PosterCache::PosterCache()
+{
+	// the scheduler has to outlive us, so it is created before we are
+	TaskScheduler::getInstance();
+}
+
+PosterCache::~PosterCache()
+{
+	// the tasks still queued or running refer to us, so we have to wait for them
+	std::unique_lock<std::mutex> lock{ m_mutex };
+	m_drained.wait(lock, [this] { return m_inFlight == 0; });
+}
+
+void PosterCache::loadRequested(const std::string& poster)
+{
+	// the actual file access happens without holding the lock, so the UI thread never waits on the disk
+	unsigned int width{ 0 };
+	unsigned int height{ 0 };
+	bool loaded{ false };
+	{
+		PROFILE_SCOPE("PosterCache::loadPoster");
+		loaded = loadPoster(poster, width, height);
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	if (--m_inFlight == 0) {
+		m_drained.notify_all();
+	}
+	auto iter{ m_entries.find(poster) };
+	if (iter == m_entries.end()) {
+		return;
+	}
+	PosterEntry& entry{ iter->second };
+	if (!loaded) {
+		entry.state = PosterState::FAILED;
+		return;
+	}
+	entry.state = PosterState::READY;
+	entry.width = width;
+	entry.height = height;
+	entry.bytes = static_cast<size_t>(width) * height * 4;
+	m_lru.push_front(poster);
+	entry.lruPosition = m_lru.begin();
+	entry.listed = true;
+	m_usedBytes += entry.bytes;
+	evict();
+
+	m_posterReady = true;
+}
+
+bool PosterCache::loadPoster(const std::string& poster, unsigned int& width, unsigned int& height)
+{
+	std::ifstream file{ ASSET_PATH + poster, std::ios::binary };
+	if (!file) {
+		return false;
+	}
+	std::vector<unsigned char> data{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+	// a PNG starts with an 8 byte signature, followed by the IHDR chunk: 4 bytes length, "IHDR", then the big-endian width/height
+	static const unsigned char signature[8]{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if (data.size() < 24 || !std::equal(std::begin(signature), std::end(signature), data.begin()) ||
+		!std::equal(data.begin() + 12, data.begin() + 16, "IHDR")) {
+		return false;
+	}
+	width = (data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+	height = (data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+	return true;
+}
+
+void PosterCache::evict()
+{
+	while (m_usedBytes > m_budget && !m_lru.empty()) {
+		auto iter{ m_entries.find(m_lru.back()) };
+
+		// everything left is visible right now; going over budget is better than drawing placeholders for visible films
+		if (iter->second.lastUsedFrame == m_frame) {
+			break;
+		}
+		m_usedBytes -= iter->second.bytes;
+		m_lru.pop_back();
+
+		// SGG still has the texture of a poster that was drawn, so forgetting it would only mean loading it all over again
+		if (iter->second.drawn) {
+			iter->second.listed = false;
+		}
+		else {
+			m_entries.erase(iter);
+		}
+	}
+}
+
+void PosterCache::beginFrame()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	++m_frame;
+}
+
+bool PosterCache::touch(const std::string& poster)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto iter{ m_entries.find(poster) };
+	if (iter == m_entries.end()) {
+		m_entries[poster].lastUsedFrame = m_frame;
+		++m_inFlight;
+		TaskScheduler::getInstance()->submit([this, poster] { loadRequested(poster); });
+		return false;
+	}
+
+	PosterEntry& entry{ iter->second };
+	entry.lastUsedFrame = m_frame;
+	if (entry.state != PosterState::READY) {
+		return false;
+	}
+
+	// moving the poster to the front of the LRU list, or back into it if it was evicted since it was last drawn
+	if (entry.listed) {
+		m_lru.splice(m_lru.begin(), m_lru, entry.lruPosition);
+	}
+	else {
+		m_lru.push_front(poster);
+		entry.lruPosition = m_lru.begin();
+		entry.listed = true;
+		m_usedBytes += entry.bytes;
+		evict();
+	}
+	entry.drawn = true;
+	return true;
+}
+
+void PosterCache::setBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_budget = bytes;
+	evict();
+}
+
+bool PosterCache::consumePosterReady()
+{
+	return m_posterReady.exchange(false);
+}
+
+size_t PosterCache::getUsedBytes()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_usedBytes;
+}
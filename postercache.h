@@ -0,0 +1,94 @@
+#pragma once
+#include "global.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/* PosterCache: Instead of preloading every PNG of our assets folder before the first frame, posters are loaded on demand
+ * as bulk tasks on the TaskScheduler's workers. Until a poster is ready, films draw a placeholder in its place.
+ *
+ * Ready posters live in an LRU list, bounded by a byte budget (what the decoded bitmap would take, width * height * 4).
+ * Every poster a film draws in the current frame is "touched": it moves to the front of the list and cannot be evicted
+ * during this frame. Posters that have scrolled out of the visible grid drift towards the back and are the first to go.
+ *
+ * SGG only lets us name a bitmap, not hand it pixels, so the decoding and the upload still happen inside SGG, on the UI
+ * thread, the first time a ready poster is drawn. What the workers do is everything before that: reading the file (so
+ * SGG's own read hits the OS file cache), validating its header and working out its dimensions and memory cost.
+ *
+ * SGG has no way to unload a bitmap either, so the budget only bounds what the cache itself keeps track of. A poster that
+ * has already been drawn stays ready when it is evicted, since SGG's texture of it is still there: it only leaves the LRU
+ * list (and the budget) until it is touched again, and is drawn right away, without a placeholder or a reload. A poster
+ * evicted before it was ever drawn is forgotten, and loaded again if it is needed. What keeps SGG's textures small is
+ * drawing the baked thumbnails instead of the full posters (see ThumbnailCache). */
+
+enum class PosterState { LOADING, READY, FAILED };
+
+class PosterCache {
+private:
+	struct PosterEntry {
+		PosterState state{ PosterState::LOADING };
+		unsigned int width{ 0 };
+		unsigned int height{ 0 };
+		size_t bytes{ 0 };						// the memory cost of the decoded poster
+		unsigned long long lastUsedFrame{ 0 };	// the last frame this poster was touched in
+		bool drawn{ false };					// touch() has let it be drawn, so SGG has a texture of it
+		bool listed{ false };					// in m_lru, with its bytes counted in m_usedBytes
+		std::list<std::string>::iterator lruPosition;
+	};
+
+	static inline PosterCache* s_instance{ nullptr };
+
+	// m_mutex: Guards everything below that is shared between the UI thread and the workers
+	std::mutex m_mutex;
+	std::condition_variable m_drained;			// signalled when the last poster task in flight finishes
+
+	std::unordered_map<std::string, PosterEntry> m_entries;
+	std::list<std::string> m_lru;				// front is the most recently used poster
+	unsigned int m_inFlight{ 0 };				// poster tasks submitted to the scheduler that haven't finished yet
+
+	size_t m_budget{ POSTER_CACHE_BUDGET };
+	size_t m_usedBytes{ 0 };
+	unsigned long long m_frame{ 1 };
+
+	// m_posterReady: Set by the workers whenever a poster becomes ready, so FilmUI knows it has to redraw
+	std::atomic<bool> m_posterReady{ false };
+
+	// The task a worker runs for every requested poster
+	void loadRequested(const std::string& poster);
+
+	// Reads the PNG file and fills in the dimensions of the poster. Returns false if the file is missing or not a PNG.
+	static bool loadPoster(const std::string& poster, unsigned int& width, unsigned int& height);
+
+	// Evicts least recently used posters until we are within budget (which frees our entries, not SGG's textures, and keeps
+	// the entries of posters already drawn). Never evicts a poster touched in the current frame. Expects m_mutex to be held.
+	void evict();
+
+	PosterCache();
+
+public:
+	static PosterCache* getInstance();
+	static void releaseInstance();
+
+	~PosterCache();
+
+	// Called once per frame before drawing; posters touched from now on count as visible in this frame
+	void beginFrame();
+
+	/* Called by every film that draws its poster. Returns true if the poster is ready to be drawn. If it is not, its
+	 * loading is requested (if it hasn't been already) and the caller should draw a placeholder instead. */
+	bool touch(const std::string& poster);
+
+	// Changes the byte budget of the cache, evicting right away if we are now over it
+	void setBudget(size_t bytes);
+
+	// Returns true (once) if any poster has become ready since the last call
+	bool consumePosterReady();
+
+	size_t getUsedBytes();
+	size_t getBudget() const				{ return m_budget; }
+};
@@ -0,0 +1,271 @@
+#include "profiler.h"
+#include "global.h"
+#include "util.h"
+#include "renderqueue.h"
+#include "inputmanager.h"
+#include "graphics.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+	// the "phase" every frame's total wall time is recorded under
+	const char* const c_framePhase{ "Frame" };
+
+	// a small, stable id per thread for the trace viewer, in the order the threads were first seen
+	unsigned int threadIndex()
+	{
+		static std::atomic<unsigned int> s_nextThread{ 0 };
+		thread_local unsigned int t_thread{ s_nextThread++ };
+		return t_thread;
+	}
+
+	std::string escapeJson(const char* text)
+	{
+		std::string escaped;
+		for (; *text; ++text) {
+			if (*text == '"' || *text == '\\') {
+				escaped += '\\';
+			}
+			escaped += *text;
+		}
+		return escaped;
+	}
+}
+
+Profiler* Profiler::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new Profiler();
+	}
+	return s_instance;
+}
+
+void Profiler::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+Profiler::Profiler()
+{
+	m_events.resize(PROFILER_TRACE_EVENTS);
+	phaseId(c_framePhase);
+}
+
+// must be called with m_mutex held
+unsigned int Profiler::phaseId(const char* name)
+{
+	auto iter{ m_phaseIds.find(name) };
+	if (iter != m_phaseIds.end()) {
+		return iter->second;
+	}
+
+	// a new pointer, but maybe the same name as a phase we already have (e.g. the same literal in another translation unit)
+	auto [named, inserted] { m_phaseNames.emplace(name, static_cast<unsigned int>(m_phases.size())) };
+	if (inserted) {
+		Phase phase;
+		phase.name = name;
+		phase.history.reserve(PROFILER_HISTORY);
+		m_phases.push_back(std::move(phase));
+	}
+	m_phaseIds.emplace(name, named->second);
+	return named->second;
+}
+
+unsigned int Profiler::bucketOf(float ms)
+{
+	float microseconds{ ms * 1000.0f };
+	if (microseconds < 1.0f) {
+		return 0;
+	}
+	return std::min(static_cast<unsigned int>(std::log2(microseconds)), c_buckets - 1);
+}
+
+// must be called with m_mutex held. Moves the totals of the current frame into the history of every phase that ran in it.
+void Profiler::closeFrame()
+{
+	for (auto& phase : m_phases) {
+		if (phase.frameCalls == 0) {
+			continue;
+		}
+
+		// replacing the oldest sample once the ring is full, keeping the histogram in step with it
+		if (phase.history.size() < PROFILER_HISTORY) {
+			phase.history.push_back(phase.frameTotal);
+		}
+		else {
+			--phase.histogram[bucketOf(phase.history[phase.historyNext])];
+			phase.history[phase.historyNext] = phase.frameTotal;
+		}
+		++phase.histogram[bucketOf(phase.frameTotal)];
+		phase.historyNext = (phase.historyNext + 1) % PROFILER_HISTORY;
+
+		phase.lastCalls = phase.frameCalls;
+		phase.frameTotal = 0.0f;
+		phase.frameCalls = 0;
+	}
+}
+
+void Profiler::nextFrame()
+{
+	// F2 toggles the overlay, F3 writes out the trace. Acting on the press only, not for as long as the key is held.
+	InputManager* input{ InputManager::getInstance() };
+	if (input->wasKeyPressed(graphics::SCANCODE_F2)) {
+		m_overlayVisible = !m_overlayVisible;
+	}
+	if (input->wasKeyPressed(graphics::SCANCODE_F3)) {
+		dumpTrace(PROFILER_TRACE_FILE);
+	}
+
+	// the previous frame lasted from its nextFrame() until this one, SGG's own work (and the vsync wait) included
+	Clock::time_point now{ Clock::now() };
+	record(c_framePhase, m_frameStart, now);
+	m_frameStart = now;
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	closeFrame();
+}
+
+void Profiler::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	Phase& phase{ m_phases[phaseId(name)] };
+	phase.frameTotal += std::chrono::duration<float, std::milli>(end - start).count();
+	++phase.frameCalls;
+
+	TraceEvent& event{ m_events[m_eventsNext] };
+	event.name = name;
+	event.start = std::chrono::duration_cast<std::chrono::microseconds>(start - m_origin).count();
+	event.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	event.thread = threadIndex();
+	if (++m_eventsNext == m_events.size()) {
+		m_eventsNext = 0;
+		m_eventsWrapped = true;
+	}
+}
+
+void Profiler::drawOverlay()
+{
+	if (!m_overlayVisible) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	const float left{ 10.0f };
+	const float top{ 15.0f };
+	const float rowHeight{ 14.0f };
+	const float histogramLeft{ 400.0f };
+	const float barWidth{ 6.0f };
+	const float width{ histogramLeft + c_buckets * barWidth };
+	const float height{ (m_phases.size() + 4) * rowHeight };
+
+	RenderQueue::getInstance()->nextLayer();
+	graphics::Brush brush;
+	brush.outline_opacity = 0.0f;
+	SETCOLOUR(brush.fill_color, 0.0f, 0.0f, 0.0f);
+	brush.fill_opacity = 0.75f;
+	queueRect(width / 2.0f, top - rowHeight + height / 2.0f, width, height, brush);
+
+	setFont("Montserrat-Medium.ttf");
+	SETCOLOUR(brush.fill_color, 1.0f, 1.0f, 1.0f);
+	brush.fill_opacity = 1.0f;
+
+	// columns: name, calls in the last frame, then last/average/p95/max over the history in ms, then the histogram
+	const float columns[]{ left, 200.0f, 240.0f, 280.0f, 320.0f, 360.0f };
+	const char* headers[]{ "phase (ms)", "calls", "last", "avg", "p95", "max" };
+	for (unsigned int i{ 0 }; i < 6; ++i) {
+		queueText(columns[i], top, 11, headers[i], brush);
+	}
+	queueText(histogramLeft, top, 11, "1us .. 131ms", brush);
+
+	std::vector<float> sorted;
+	char text[32];
+	float y{ top + rowHeight };
+	for (const auto& phase : m_phases) {
+		if (phase.history.empty()) {
+			continue;
+		}
+
+		sorted = phase.history;
+		std::sort(sorted.begin(), sorted.end());
+		float average{ 0.0f };
+		for (const auto sample : sorted) {
+			average += sample;
+		}
+		average /= sorted.size();
+		float last{ phase.history[(phase.historyNext + phase.history.size() - 1) % phase.history.size()] };
+		float p95{ sorted[static_cast<size_t>(0.95f * (sorted.size() - 1))] };
+		const float values[]{ last, average, p95, sorted.back() };
+
+		queueText(columns[0], y, 11, phase.name, brush);
+		std::snprintf(text, sizeof(text), "%u", phase.lastCalls);
+		queueText(columns[1], y, 11, text, brush);
+		for (unsigned int i{ 0 }; i < 4; ++i) {
+			std::snprintf(text, sizeof(text), "%.3f", values[i]);
+			queueText(columns[i + 2], y, 11, text, brush);
+		}
+
+		// the histogram, as bars scaled to the fullest bucket
+		unsigned int fullest{ *std::max_element(std::begin(phase.histogram), std::end(phase.histogram)) };
+		for (unsigned int i{ 0 }; i < c_buckets && fullest; ++i) {
+			float barHeight{ (rowHeight - 3.0f) * phase.histogram[i] / fullest };
+			if (barHeight > 0.0f) {
+				queueRect(histogramLeft + (i + 0.5f) * barWidth, y - barHeight / 2.0f, barWidth - 1.0f, barHeight, brush);
+			}
+		}
+		y += rowHeight;
+	}
+
+	// the scheduler's row: totals, what is queued right now, and how much of the time since the last frame its workers sat idle
+	SchedulerStats scheduler{ TaskScheduler::getInstance()->getStats() };
+	Clock::time_point now{ Clock::now() };
+	float elapsed{ std::chrono::duration<float, std::micro>(now - m_lastSchedulerTime).count() * scheduler.workers };
+	float idle{ elapsed > 0.0f ? 100.0f * (scheduler.idleMicroseconds - m_lastScheduler.idleMicroseconds) / elapsed : 0.0f };
+	m_lastScheduler = scheduler;
+	m_lastSchedulerTime = now;
+
+	char schedulerText[160];
+	std::snprintf(schedulerText, sizeof(schedulerText), "scheduler: %u workers, %llu tasks, %llu steals, %zu queued (%zu urgent), %.0f%% idle",
+		scheduler.workers, scheduler.tasks, scheduler.steals, scheduler.queued, scheduler.urgentQueued, std::min(idle, 100.0f));
+	queueText(columns[0], y, 11, schedulerText, brush);
+
+	// the render queue's row, as of the last frame it flushed: what sorting and merging saved
+	const RenderQueue* queue{ RenderQueue::getInstance() };
+	char queueStats[160];
+	std::snprintf(queueStats, sizeof(queueStats), "render queue: %u commands, %u merged, %u state changes (%u unsorted)",
+		queue->getSubmittedCommands(), queue->getMergedCommands(), queue->getStateChangesAfter(), queue->getStateChangesBefore());
+	queueText(columns[0], y + rowHeight, 11, queueStats, brush);
+}
+
+bool Profiler::dumpTrace(const std::string& path) const
+{
+	std::ofstream out{ path };
+	if (!out) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	// oldest event first: once the ring has wrapped, the oldest one is the next to be overwritten
+	size_t count{ m_eventsWrapped ? m_events.size() : m_eventsNext };
+	size_t first{ m_eventsWrapped ? m_eventsNext : 0 };
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (size_t i{ 0 }; i < count; ++i) {
+		const TraceEvent& event{ m_events[(first + i) % m_events.size()] };
+		out << (i ? ",\n" : "\n") << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"FilmGUI\",\"ph\":\"X\",\"ts\":"
+			<< event.start << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":" << event.thread << "}";
+	}
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "global.h"
+#include "taskscheduler.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+
+/* Profiler: Scoped timers for finding out where our frame time goes. Put PROFILE_SCOPE("Class::function") at the top of
+ * a function, and every call to it is timed from that point until the end of the scope. The timings are
+ * gathered into phases (one per name): the Profiler keeps the per-frame total of every phase over the last
+ * PROFILER_HISTORY frames it ran in, along with a rolling histogram of them, which is shown on an on-screen overlay (F2).
+ * Every single call is also kept as a trace event, the last PROFILER_TRACE_EVENTS of which can be written out as Chrome
+ * trace_event JSON (F3), to be opened in chrome://tracing or Perfetto.
+ *
+ * Profiling is switched on at compile time by defining FILMGUI_PROFILE. Without it, the macros expand to nothing and
+ * FilmUI never touches the Profiler, so a normal build pays nothing for the instrumentation.
+ *
+ * The names passed to PROFILE_SCOPE must be string literals (or anything else that outlives the Profiler), since only
+ * the pointer is stored. */
+
+#ifdef FILMGUI_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__){ name }
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+class Profiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	// number of log2 buckets in a phase's histogram: bucket i holds frames that spent [2^i, 2^(i+1)) microseconds in it
+	static constexpr unsigned int c_buckets{ 18 };
+
+	struct Phase {
+		const char* name;
+		float frameTotal{ 0.0f };					// ms spent in this phase so far in the current frame
+		unsigned int frameCalls{ 0 };				// calls so far in the current frame
+		unsigned int lastCalls{ 0 };				// calls in the last frame the phase ran in
+		std::vector<float> history;					// ring buffer of per-frame totals, in ms
+		unsigned int historyNext{ 0 };
+		unsigned int histogram[c_buckets]{};		// rolling: always describes exactly the frames in history
+	};
+
+	struct TraceEvent {
+		const char* name;
+		long long start;		// microseconds since the Profiler was created
+		long long duration;		// microseconds
+		unsigned int thread;
+	};
+
+	static inline Profiler* s_instance{ nullptr };
+
+	mutable std::mutex m_mutex;			// mutable, so that dumpTrace() can lock it while other threads keep recording
+	Clock::time_point m_origin{ Clock::now() };
+	Clock::time_point m_frameStart{ m_origin };
+
+	std::vector<Phase> m_phases;
+	std::unordered_map<const char*, unsigned int> m_phaseIds;		// by pointer, the fast path
+	std::unordered_map<std::string, unsigned int> m_phaseNames;		// by contents, for the same name in another translation unit
+
+	// ring buffer of the most recent trace events
+	std::vector<TraceEvent> m_events;
+	size_t m_eventsNext{ 0 };
+	bool m_eventsWrapped{ false };
+
+	bool m_overlayVisible{ false };
+
+	// the scheduler's statistics as of the last time the overlay was drawn, to work out its idle time since
+	SchedulerStats m_lastScheduler;
+	Clock::time_point m_lastSchedulerTime{ m_origin };
+
+	unsigned int phaseId(const char* name);
+	void closeFrame();
+
+	static unsigned int bucketOf(float ms);
+
+	Profiler();
+
+public:
+	static Profiler* getInstance();
+	static void releaseInstance();
+
+	// Called once at the very start of every frame, after InputManager::capture(): closes the statistics of the previous frame, handles the hotkeys
+	void nextFrame();
+
+	// Called by ProfileScope when a scope ends. Safe to call from any thread.
+	void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+	// Queues the overlay on a layer of its own, on top of everything else
+	void drawOverlay();
+
+	// Writes the buffered trace events to a Chrome trace_event JSON file. Returns false if the file couldn't be written.
+	bool dumpTrace(const std::string& path) const;
+
+	bool isOverlayVisible() const							{ return m_overlayVisible; }
+	void setOverlayVisible(bool visible)					{ m_overlayVisible = visible; }
+};
+
+// ProfileScope: Times its own lifetime. Only meant to be created through the PROFILE_SCOPE macro.
+class ProfileScope {
+private:
+	const char* m_name;
+	Profiler::Clock::time_point m_start;
+
+public:
+	explicit ProfileScope(const char* name) :
+		m_name{ name },
+		m_start{ Profiler::Clock::now() }
+	{}
+
+	~ProfileScope()											{ Profiler::getInstance()->record(m_name, m_start, Profiler::Clock::now()); }
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
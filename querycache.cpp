@@ -0,0 +1,137 @@
+#include "querycache.h"
+
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+namespace {
+	// FNV-1a, like the thumbnail cache's content hash
+	size_t hashBytes(size_t hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes{ static_cast<const unsigned char*>(data) };
+		for (size_t i{ 0 }; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void appendText(std::string& text, std::string_view part)
+	{
+		text.append(part);
+		text.push_back('\0');			// can't be typed, so "ab" + "c" never collides with "a" + "bc"
+	}
+}
+
+bool QuerySignature::operator==(const QuerySignature& other) const
+{
+	return hash == other.hash && active == other.active && genres == other.genres && excludedGenres == other.excludedGenres && fromYear == other.fromYear &&
+		toYear == other.toYear && excludedYears == other.excludedYears && text == other.text;
+}
+
+QuerySignature QuerySignature::of(const FilterPlan& plan)
+{
+	QuerySignature signature;
+	signature.active = plan.active;
+	if (plan.active & FilterPlan::GENRE) {
+		signature.genres = plan.genres;
+		signature.excludedGenres = plan.excludedGenres;
+	}
+	if (plan.active & FilterPlan::YEAR) {
+		signature.fromYear = plan.fromYear;
+		signature.toYear = plan.toYear;
+		std::copy(plan.excludedYears.begin(), plan.excludedYears.begin() + plan.excludedYearCount, signature.excludedYears.begin());
+	}
+	/* every text, after a character saying where it's looked for and whether it's excluded. Each has to hold whatever
+	 * order they were typed in (and whichever went into the plan's views rather than its terms), so they are laid out
+	 * sorted, which makes "drama -war" and "-war drama", or "title:a title:b" and "title:b title:a", one search. */
+	std::array<std::pair<char, std::string_view>, 4 + FILTER_MAX_TERMS> texts;
+	size_t textCount{ 0 };
+	for (const auto& [predicate, text] : { std::pair{ FilterPlan::TITLE, plan.title }, std::pair{ FilterPlan::DIRECTOR, plan.director },
+		std::pair{ FilterPlan::ACTOR, plan.actor }, std::pair{ FilterPlan::ANY_TEXT, plan.anyText } }) {
+		if (plan.active & predicate) {
+			texts[textCount++] = { static_cast<char>(predicate), text };
+		}
+	}
+	if (plan.active & FilterPlan::TERMS) {
+		for (unsigned int term{ 0 }; term < plan.termCount; ++term) {
+			const char kind{ static_cast<char>(plan.terms[term].predicate | (plan.terms[term].excluded ? 0x80 : 0)) };
+			texts[textCount++] = { kind, plan.terms[term].text };
+		}
+	}
+	std::sort(texts.begin(), texts.begin() + textCount);
+	for (size_t text{ 0 }; text < textCount; ++text) {
+		signature.text.push_back(texts[text].first);
+		appendText(signature.text, texts[text].second);
+	}
+
+	size_t hash{ 14695981039346656037ull };
+	hash = hashBytes(hash, &signature.active, sizeof(signature.active));
+	hash = hashBytes(hash, &signature.genres, sizeof(signature.genres));
+	hash = hashBytes(hash, &signature.excludedGenres, sizeof(signature.excludedGenres));
+	hash = hashBytes(hash, &signature.fromYear, sizeof(signature.fromYear));
+	hash = hashBytes(hash, &signature.toYear, sizeof(signature.toYear));
+	hash = hashBytes(hash, signature.excludedYears.data(), sizeof(signature.excludedYears));
+	signature.hash = hashBytes(hash, signature.text.data(), signature.text.size());
+	return signature;
+}
+
+void QueryCache::checkVersion(unsigned long long catalogVersion)
+{
+	if (catalogVersion != m_catalogVersion) {
+		clear();
+		m_catalogVersion = catalogVersion;
+	}
+}
+
+void QueryCache::evict()
+{
+	while (m_usedBytes > m_budget && !m_lru.empty()) {
+		m_usedBytes -= m_lru.back().bytes;
+		m_results.erase(m_lru.back().signature);
+		m_lru.pop_back();
+	}
+}
+
+bool QueryCache::lookup(const QuerySignature& signature, unsigned long long catalogVersion, FilmBitmap& selection)
+{
+	checkVersion(catalogVersion);
+	auto iter{ m_results.find(signature) };
+	if (iter == m_results.end()) {
+		return false;
+	}
+
+	// moving the result to the front of the LRU list
+	m_lru.splice(m_lru.begin(), m_lru, iter->second);
+	selection = iter->second->selection;
+	return true;
+}
+
+void QueryCache::insert(const QuerySignature& signature, unsigned long long catalogVersion, const FilmBitmap& selection)
+{
+	checkVersion(catalogVersion);
+	const size_t bytes{ selection.wordCount() * sizeof(std::uint64_t) + signature.text.size() + sizeof(CachedResult) };
+	if (bytes > m_budget) {
+		return;
+	}
+
+	auto iter{ m_results.find(signature) };
+	if (iter != m_results.end()) {
+		m_usedBytes -= iter->second->bytes;
+		m_lru.erase(iter->second);
+		m_results.erase(iter);
+	}
+
+	m_lru.push_front({ signature, selection, bytes });
+	m_results.emplace(signature, m_lru.begin());
+	m_usedBytes += bytes;
+	evict();
+}
+
+void QueryCache::clear()
+{
+	m_lru.clear();
+	m_results.clear();
+	m_usedBytes = 0;
+}
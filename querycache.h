@@ -0,0 +1,74 @@
+#pragma once
+#include "global.h"
+#include "filterplan.h"
+#include "filmbitmap.h"
+
+#include <string>
+#include <array>
+#include <list>
+#include <unordered_map>
+
+/* QueryCache: The results of recent searches, so that repeating a search (applying the same filters again after going
+ * back to the search screen, or retyping what was in the textfield) costs a hash lookup instead of a pass over the
+ * catalog.
+ *
+ * Results are keyed on a QuerySignature: a FilterPlan reduced to what actually decides which films it selects. Fields
+ * of inactive predicates are dropped and the active ones are laid out in a fixed order, so two plans that select the
+ * same films in the same way always have the same signature, however their widgets got there.
+ *
+ * Like the PosterCache, the cache is an LRU list bounded by a byte budget (the size of the result bitmaps). It remembers
+ * the version of the catalog its results came from, and empties itself the first time it is used with another one. */
+
+// QuerySignature: The canonical form of a FilterPlan, with its hash worked out once
+struct QuerySignature {
+	unsigned int active{ 0 };
+	unsigned short genres{ 0 };
+	unsigned short excludedGenres{ 0 };
+	unsigned int fromYear{ 0 };
+	unsigned int toYear{ 0 };
+	std::array<FilterPlan::YearRange, FILTER_MAX_TERMS> excludedYears{};	// in order, as the plan keeps them; unused ones stay 0
+	std::string text;				// the texts of the active text predicates and the terms, sorted, each followed by a separator
+	size_t hash{ 0 };
+
+	bool operator==(const QuerySignature& other) const;
+
+	static QuerySignature of(const FilterPlan& plan);
+};
+
+struct QuerySignatureHash {
+	size_t operator()(const QuerySignature& signature) const		{ return signature.hash; }
+};
+
+class QueryCache {
+private:
+	struct CachedResult {
+		QuerySignature signature;
+		FilmBitmap selection;
+		size_t bytes{ 0 };
+	};
+
+	std::list<CachedResult> m_lru;		// front is the most recently used result
+	std::unordered_map<QuerySignature, std::list<CachedResult>::iterator, QuerySignatureHash> m_results;
+
+	size_t m_budget{ QUERY_CACHE_BUDGET };
+	size_t m_usedBytes{ 0 };
+	unsigned long long m_catalogVersion{ 0 };
+
+	// drops everything if the results are of another version of the catalog
+	void checkVersion(unsigned long long catalogVersion);
+
+	// evicts least recently used results until we are within budget
+	void evict();
+
+public:
+	// If the results of the search are cached, copies them into selection and returns true
+	bool lookup(const QuerySignature& signature, unsigned long long catalogVersion, FilmBitmap& selection);
+
+	// Caches the results of a search, unless they alone would be over budget
+	void insert(const QuerySignature& signature, unsigned long long catalogVersion, const FilmBitmap& selection);
+
+	void clear();
+
+	size_t getUsedBytes() const							{ return m_usedBytes; }
+	size_t getBudget() const							{ return m_budget; }
+};
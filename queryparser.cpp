@@ -0,0 +1,172 @@
+#include "queryparser.h"
+#include "profiler.h"
+
+#include <array>
+#include <charconv>
+
+namespace {
+	enum class QueryField { TEXT, TITLE, DIRECTOR, ACTOR, GENRE, YEAR };
+
+	// Token: one term of a query, as views into it
+	struct Token {
+		QueryField field{ QueryField::TEXT };
+		std::string_view value;
+		bool negated{ false };
+		bool quoted{ false };
+	};
+
+	struct FieldName {
+		std::string_view name;
+		QueryField field;
+	};
+	constexpr std::array<FieldName, 6> c_fields{ { { "title", QueryField::TITLE }, { "director", QueryField::DIRECTOR },
+		{ "actor", QueryField::ACTOR }, { "cast", QueryField::ACTOR }, { "genre", QueryField::GENRE }, { "year", QueryField::YEAR } } };
+
+	// in the order of the Genre enum, lowercase like the query
+	constexpr std::array<std::string_view, 10> c_genreNames{ "adventure", "animation", "comedy", "crime", "documentary",
+		"drama", "mystery", "romance", "thriller", "war" };
+
+	bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	// reads the term at position (after any spaces) into token, moving position past it; false once there are none left
+	bool nextToken(std::string_view query, size_t& position, Token& token)
+	{
+		while (position < query.size() && isSpace(query[position])) {
+			++position;
+		}
+		if (position == query.size()) {
+			return false;
+		}
+
+		token = {};
+		if (query[position] == '-') {
+			token.negated = true;
+			++position;
+		}
+
+		// a field is a name we know followed by a colon; anything else before a colon is part of a word
+		size_t colon{ position };
+		while (colon < query.size() && query[colon] >= 'a' && query[colon] <= 'z') {
+			++colon;
+		}
+		if (colon < query.size() && query[colon] == ':') {
+			const std::string_view name{ query.substr(position, colon - position) };
+			for (const FieldName& field : c_fields) {
+				if (field.name == name) {
+					token.field = field.field;
+					position = colon + 1;
+					break;
+				}
+			}
+		}
+
+		if (position < query.size() && query[position] == '"') {
+			token.quoted = true;
+			const size_t close{ std::min(query.find('"', position + 1), query.size()) };
+			token.value = query.substr(position + 1, close - position - 1);
+			position = std::min(close + 1, query.size());
+		}
+		else {
+			size_t end{ position };
+			while (end < query.size() && !isSpace(query[end])) {
+				++end;
+			}
+			token.value = query.substr(position, end - position);
+			position = end;
+		}
+		return true;
+	}
+
+	// the first genre whose name starts with the text
+	bool findGenre(std::string_view text, Genre& genre)
+	{
+		if (text.empty()) {
+			return false;
+		}
+		for (size_t index{ 0 }; index < c_genreNames.size(); ++index) {
+			if (c_genreNames[index].starts_with(text)) {
+				genre = static_cast<Genre>(index);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// a year, all of the text being digits
+	bool parseYear(std::string_view text, unsigned int& year)
+	{
+		const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), year) };
+		return !text.empty() && error == std::errc{} && end == text.data() + text.size();
+	}
+
+	// "1990", "1990..2005", "1990.." or "..2005", the years a film has to have come out in, or with negated, must not have
+	void addYears(std::string_view text, bool negated, FilterPlan& plan)
+	{
+		unsigned int from{ 0 };
+		unsigned int to{ ~0u };
+		const size_t dots{ text.find("..") };
+		if (dots == std::string_view::npos) {
+			if (!parseYear(text, from)) {
+				return;
+			}
+			to = from;
+		}
+		else {
+			const std::string_view first{ text.substr(0, dots) };
+			const std::string_view last{ text.substr(dots + 2) };
+			const bool hasFrom{ parseYear(first, from) };
+			const bool hasTo{ parseYear(last, to) };
+			if (!(hasFrom || first.empty()) || !(hasTo || last.empty()) || !(hasFrom || hasTo)) {
+				return;
+			}
+		}
+		negated ? plan.excludeYears(from, to) : plan.restrictYears(from, to);
+	}
+}
+
+void parseQuery(std::string_view query, FilterPlan& plan)
+{
+	PROFILE_SCOPE("parseQuery");
+	size_t position{ 0 };
+	Token token;
+	while (nextToken(query, position, token)) {
+		Genre genre;
+		switch (token.field) {
+		case QueryField::TITLE:
+			token.negated ? plan.excludeText(FilterPlan::TITLE, token.value) : plan.matchTitle(token.value);
+			break;
+		case QueryField::DIRECTOR:
+			token.negated ? plan.excludeText(FilterPlan::DIRECTOR, token.value) : plan.matchDirector(token.value);
+			break;
+		case QueryField::ACTOR:
+			token.negated ? plan.excludeText(FilterPlan::ACTOR, token.value) : plan.matchActor(token.value);
+			break;
+		case QueryField::GENRE:
+			if (findGenre(token.value, genre)) {
+				token.negated ? plan.excludeGenre(genre) : plan.requireGenre(genre);
+			}
+			break;
+		case QueryField::YEAR:
+			addYears(token.value, token.negated, plan);
+			break;
+		default:
+			token.negated ? plan.excludeText(FilterPlan::ANY_TEXT, token.value) : plan.matchAnyText(token.value);
+			break;
+		}
+	}
+}
+
+bool isPlainQuery(std::string_view query)
+{
+	size_t position{ 0 };
+	Token token;
+	while (nextToken(query, position, token)) {
+		if (token.field != QueryField::TEXT || token.negated || token.quoted) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "filterplan.h"
+
+#include <string_view>
+
+/* The query language of the main menu textfield. A query is a list of terms, separated by spaces, all of which a film
+ * has to match:
+ *
+ *   spirited               a word: the title, director or cast contains it
+ *   "spirited away"        a phrase, spaces and all (a missing closing quote runs to the end of the query)
+ *   title:spirited         only the title contains it; director:, actor: (or cast:) likewise
+ *   genre:animation        the film is of the genre (the start of its name is enough, e.g. genre:anim)
+ *   year:1990..2005        the film came out between those years; year:1990, year:1990.. and year:..2005 work too
+ *   -war                   a leading - turns any term around: the film must *not* match it (-year:1990..1999 too)
+ *
+ * Field values can be quoted too (director:"hayao miyazaki"). A word with a colon after anything but one of the fields
+ * above is just a word, so titles like "star wars: episode iv" can still be typed as they are.
+ *
+ * Queries are compiled straight into a FilterPlan: the texts of the plan are views into the query, the genres and years
+ * are parsed in place, and nothing is allocated, so the query is parsed anew on every keystroke. What the query can't
+ * make sense of (an unknown genre, a year that isn't a number) is left out of the plan. Texts past the first
+ * FILTER_MAX_TERMS beyond one of each kind are dropped, like any other plan's, and so are excluded years past the first
+ * FILTER_MAX_TERMS separate ranges. */
+
+// Adds everything the query asks for to the plan. The query must be lowercase, and outlive the plan.
+void parseQuery(std::string_view query, FilterPlan& plan);
+
+// Whether the query is all words, which is when typing more at its end can only ever narrow its results down
+bool isPlainQuery(std::string_view query);
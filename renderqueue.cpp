@@ -0,0 +1,262 @@
+#include "renderqueue.h"
+#include "profiler.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>	// for std::stable_sort
+#include <climits>
+
+RenderQueue* RenderQueue::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new RenderQueue();
+	}
+	return s_instance;
+}
+
+void RenderQueue::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+void RenderQueue::beginFrame()
+{
+	// clear() keeps the capacity, so after the first few frames queueing a command no longer allocates
+	m_commands.clear();
+	m_textArena.clear();
+	m_currentLayer = 0;
+}
+
+void RenderQueue::nextLayer()
+{
+	++m_currentLayer;
+}
+
+unsigned int RenderQueue::internTexture(const std::string& texture)
+{
+	auto iter{ m_textureIds.find(texture) };
+	if (iter != m_textureIds.end()) {
+		return iter->second;
+	}
+	unsigned int id{ static_cast<unsigned int>(m_textureNames.size()) };
+	m_textureNames.push_back(texture);
+	m_textureIds.emplace(texture, id);
+	return id;
+}
+
+unsigned int RenderQueue::internFont(const std::string& font)
+{
+	auto iter{ m_fontIds.find(font) };
+	if (iter != m_fontIds.end()) {
+		return iter->second;
+	}
+	unsigned int id{ static_cast<unsigned int>(m_fontNames.size()) };
+	m_fontNames.push_back(font);
+	m_fontIds.emplace(font, id);
+	return id;
+}
+
+void RenderQueue::push(RenderCommandType type, float a, float b, float c, float d, const graphics::Brush& brush)
+{
+	RenderCommand command;
+	command.type = type;
+	command.layer = m_currentLayer;
+
+	// text only uses the fill parameters of a brush, so a texture left over on the brush is irrelevant for it.
+	// Likewise, the current font is irrelevant for shapes.
+	command.texture = (type == RenderCommandType::TEXT) ? 0 : internTexture(brush.texture);
+	command.font = (type == RenderCommandType::TEXT) ? m_currentFont : 0;
+
+	command.params[0] = a;
+	command.params[1] = b;
+	command.params[2] = c;
+	command.params[3] = d;
+	command.textOffset = 0;
+	command.textLength = 0;
+
+	std::copy(std::begin(brush.fill_color), std::end(brush.fill_color), command.brush.fill_color);
+	std::copy(std::begin(brush.fill_secondary_color), std::end(brush.fill_secondary_color), command.brush.fill_secondary_color);
+	std::copy(std::begin(brush.outline_color), std::end(brush.outline_color), command.brush.outline_color);
+	command.brush.fill_opacity = brush.fill_opacity;
+	command.brush.fill_secondary_opacity = brush.fill_secondary_opacity;
+	command.brush.outline_opacity = brush.outline_opacity;
+	command.brush.outline_width = brush.outline_width;
+	command.brush.gradient_dir_u = brush.gradient_dir_u;
+	command.brush.gradient_dir_v = brush.gradient_dir_v;
+	command.brush.gradient = brush.gradient;
+
+	m_commands.push_back(command);
+}
+
+void RenderQueue::drawRect(float center_x, float center_y, float width, float height, const graphics::Brush& brush)
+{
+	push(RenderCommandType::RECT, center_x, center_y, width, height, brush);
+}
+
+void RenderQueue::drawLine(float x1, float y1, float x2, float y2, const graphics::Brush& brush)
+{
+	push(RenderCommandType::LINE, x1, y1, x2, y2, brush);
+}
+
+void RenderQueue::drawText(float pos_x, float pos_y, float size, std::string_view text, const graphics::Brush& brush)
+{
+	push(RenderCommandType::TEXT, pos_x, pos_y, size, 0.0f, brush);
+	m_commands.back().textOffset = m_textArena.size();
+	m_commands.back().textLength = text.size();
+	m_textArena.append(text);
+}
+
+// setFont does not reach SGG directly anymore: it only marks the font all the following text commands will be drawn with
+void RenderQueue::setFont(const std::string& font)
+{
+	m_currentFont = internFont(font);
+}
+
+unsigned long long RenderQueue::sortKey(const RenderCommand& command) const
+{
+	unsigned long long kind{ 0 };
+	if (command.type == RenderCommandType::TEXT) {
+		kind = 2;
+	}
+	else if (command.texture != 0) {
+		kind = 1;
+	}
+
+	// 20 bits of layer, 2 bits of kind, 21 bits each for the texture and the font
+	return (static_cast<unsigned long long>(command.layer) << 44) | (kind << 42) |
+		(static_cast<unsigned long long>(command.texture & 0x1FFFFF) << 21) | (command.font & 0x1FFFFF);
+}
+
+bool RenderQueue::isDuplicate(const RenderCommand& first, const RenderCommand& second) const
+{
+	if (first.type != second.type || first.layer != second.layer || first.texture != second.texture || first.font != second.font) {
+		return false;
+	}
+	if (!std::equal(std::begin(first.params), std::end(first.params), std::begin(second.params))) {
+		return false;
+	}
+	if (!(first.brush == second.brush)) {
+		return false;
+	}
+
+	/* drawing a command twice only gives the same pixels as drawing it once if nothing of what is under it shows through:
+	 * not with a translucent fill or outline, nor the antialiased edges of text and lines, nor a texture's alpha */
+	const BrushState& brush{ first.brush };
+	const bool opaque{ brush.fill_opacity >= 1.0f && (!brush.gradient || brush.fill_secondary_opacity >= 1.0f) &&
+		(brush.outline_opacity <= 0.0f || brush.outline_opacity >= 1.0f) };
+	if (first.type != RenderCommandType::RECT || first.texture != 0 || !opaque) {
+		return false;
+	}
+	return std::string_view{ m_textArena }.substr(first.textOffset, first.textLength) ==
+		std::string_view{ m_textArena }.substr(second.textOffset, second.textLength);
+}
+
+unsigned int RenderQueue::countStateChanges(const std::vector<unsigned int>& order) const
+{
+	unsigned int changes{ 0 };
+	unsigned int texture{ UINT_MAX };
+	unsigned int font{ UINT_MAX };
+
+	for (const auto index : order) {
+		const RenderCommand& command{ m_commands[index] };
+		if (command.type == RenderCommandType::TEXT) {
+			if (command.font != font) {
+				font = command.font;
+				++changes;
+			}
+		}
+		else if (command.texture != texture) {
+			texture = command.texture;
+			++changes;
+		}
+	}
+	return changes;
+}
+
+void RenderQueue::execute(const RenderCommand& command)
+{
+	std::copy(std::begin(command.brush.fill_color), std::end(command.brush.fill_color), m_scratchBrush.fill_color);
+	std::copy(std::begin(command.brush.fill_secondary_color), std::end(command.brush.fill_secondary_color), m_scratchBrush.fill_secondary_color);
+	std::copy(std::begin(command.brush.outline_color), std::end(command.brush.outline_color), m_scratchBrush.outline_color);
+	m_scratchBrush.fill_opacity = command.brush.fill_opacity;
+	m_scratchBrush.fill_secondary_opacity = command.brush.fill_secondary_opacity;
+	m_scratchBrush.outline_opacity = command.brush.outline_opacity;
+	m_scratchBrush.outline_width = command.brush.outline_width;
+	m_scratchBrush.gradient_dir_u = command.brush.gradient_dir_u;
+	m_scratchBrush.gradient_dir_v = command.brush.gradient_dir_v;
+	m_scratchBrush.gradient = command.brush.gradient;
+
+	const float* params{ command.params };
+	switch (command.type) {
+	case RenderCommandType::RECT:
+		graphics::drawRect(params[0], params[1], params[2], params[3], m_scratchBrush);
+		break;
+	case RenderCommandType::LINE:
+		graphics::drawLine(params[0], params[1], params[2], params[3], m_scratchBrush);
+		break;
+	case RenderCommandType::TEXT:
+		m_scratchText.assign(m_textArena, command.textOffset, command.textLength);
+		graphics::drawText(params[0], params[1], params[2], m_scratchText, m_scratchBrush);
+		break;
+	}
+}
+
+void RenderQueue::flush()
+{
+	PROFILE_SCOPE("RenderQueue::flush");
+	m_submittedCommands = static_cast<unsigned int>(m_commands.size());
+
+	m_order.resize(m_commands.size());
+	for (unsigned int i{ 0 }; i < m_order.size(); ++i) {
+		m_order[i] = i;
+	}
+	m_stateChangesBefore = countStateChanges(m_order);
+
+	// stable, so that commands with the same key keep the order they were submitted in
+	std::stable_sort(m_order.begin(), m_order.end(), [this](unsigned int a, unsigned int b) {
+		return sortKey(m_commands[a]) < sortKey(m_commands[b]);
+	});
+
+	// merging: after sorting, an opaque command identical to the one right before it would only draw the same pixels
+	// again, so dropping it entirely (see isDuplicate())
+	auto last{ std::unique(m_order.begin(), m_order.end(), [this](unsigned int a, unsigned int b) {
+		return isDuplicate(m_commands[a], m_commands[b]);
+	}) };
+	m_mergedCommands = static_cast<unsigned int>(m_order.end() - last);
+	m_order.erase(last, m_order.end());
+
+	submit();
+}
+
+void RenderQueue::replay()
+{
+	PROFILE_SCOPE("RenderQueue::replay");
+	submit();
+}
+
+void RenderQueue::submit()
+{
+	m_stateChangesAfter = 0;
+	unsigned int boundTexture{ UINT_MAX };
+	for (const auto index : m_order) {
+		const RenderCommand& command{ m_commands[index] };
+
+		if (command.type == RenderCommandType::TEXT) {
+			if (command.font != m_boundFont) {
+				graphics::setFont(m_fontNames[command.font]);
+				m_boundFont = command.font;
+				++m_stateChangesAfter;
+			}
+		}
+		else if (command.texture != boundTexture) {
+			m_scratchBrush.texture = m_textureNames[command.texture];
+			boundTexture = command.texture;
+			++m_stateChangesAfter;
+		}
+		execute(command);
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "global.h"
+#include "graphics.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+/* RenderQueue: Instead of drawing immediately through graphics::drawRect/drawText, every draw function in our project
+ * appends a command to this queue. Once per frame, FilmUI flushes the queue: the commands are sorted by layer, texture
+ * and font, identical opaque rectangles are merged, and only then are they handed over to SGG. That way, we only switch fonts and
+ * textures when we actually have to, instead of every time a widget or a film decides to (re)set them.
+ *
+ * Sorting rules, within the same layer: untextured shapes first, then textured shapes (grouped by texture), then text
+ * (grouped by font). Submission order is kept for everything else. If something has to be drawn on top of something
+ * that would otherwise be sorted after it, the caller has to open a new layer through nextLayer(). */
+
+enum class RenderCommandType { RECT, LINE, TEXT };
+
+class RenderQueue {
+private:
+	// BrushState: everything a graphics::Brush holds apart from its texture, which is interned separately
+	struct BrushState {
+		float fill_color[3];
+		float fill_secondary_color[3];
+		float fill_opacity;
+		float fill_secondary_opacity;
+		float outline_color[3];
+		float outline_opacity;
+		float outline_width;
+		float gradient_dir_u;
+		float gradient_dir_v;
+		bool gradient;
+
+		bool operator==(const BrushState& other) const = default;
+	};
+
+	// A single recorded draw call
+	struct RenderCommand {
+		RenderCommandType type;
+		unsigned int layer;
+		unsigned int texture;		// interned texture id, 0 means no texture
+		unsigned int font;			// interned font id, only meaningful for text commands
+		float params[4];			// rect: centre x/y, width, height. line: x1, y1, x2, y2. text: x, y, size
+		size_t textOffset;			// where the text of a text command starts in m_textArena
+		size_t textLength;
+		BrushState brush;
+	};
+
+	// Our class will be a singleton, just like FilmUI
+	static inline RenderQueue* s_instance{ nullptr };
+
+	std::vector<RenderCommand> m_commands;
+	std::vector<unsigned int> m_order;		// the order the commands will be flushed in, rebuilt on every flush
+
+	// m_textArena: all the text of the current frame, back to back, so we don't allocate a string per text command
+	std::string m_textArena;
+
+	// interned texture/font names. Id 0 is reserved for "no texture"/"no font".
+	std::vector<std::string> m_textureNames{ "" };
+	std::unordered_map<std::string, unsigned int> m_textureIds{ { "", 0 } };
+	std::vector<std::string> m_fontNames{ "" };
+	std::unordered_map<std::string, unsigned int> m_fontIds{ { "", 0 } };
+
+	unsigned int m_currentLayer{ 0 };
+	unsigned int m_currentFont{ 0 };		// the font the draw functions have last asked for
+	unsigned int m_boundFont{ 0 };			// the font SGG actually has active right now
+
+	// reused on every flush, so drawing a command never allocates
+	graphics::Brush m_scratchBrush;
+	std::string m_scratchText;
+
+	// Per-frame counters. "Before" is the number of font/texture switches the commands would have needed in submission
+	// order (the way we used to draw), "after" is the number of switches we actually performed after sorting and merging.
+	unsigned int m_stateChangesBefore{ 0 };
+	unsigned int m_stateChangesAfter{ 0 };
+	unsigned int m_submittedCommands{ 0 };
+	unsigned int m_mergedCommands{ 0 };
+
+	unsigned int internTexture(const std::string& texture);
+	unsigned int internFont(const std::string& font);
+
+	void push(RenderCommandType type, float a, float b, float c, float d, const graphics::Brush& brush);
+
+	// sortKey: layer, then kind (untextured shape, textured shape, text), then texture, then font
+	unsigned long long sortKey(const RenderCommand& command) const;
+
+	// returns true if the commands are the same opaque, untextured rectangle, which drawn again would produce the exact
+	// same result
+	bool isDuplicate(const RenderCommand& first, const RenderCommand& second) const;
+
+	// counts the font/texture switches needed to draw m_commands in the order given
+	unsigned int countStateChanges(const std::vector<unsigned int>& order) const;
+
+	void execute(const RenderCommand& command);
+
+	// submit: hands the commands over to SGG in the order of m_order, switching fonts/textures only when needed
+	void submit();
+
+	RenderQueue() = default;
+
+public:
+	// To get the currently active instance of RenderQueue
+	static RenderQueue* getInstance();
+
+	// To release the currently active instance of RenderQueue
+	static void releaseInstance();
+
+	// Called at the start of every frame. Clears the commands of the previous frame.
+	void beginFrame();
+
+	// Everything submitted after a call to nextLayer() is guaranteed to be drawn on top of everything submitted before it.
+	void nextLayer();
+
+	// The queued equivalents of graphics::drawRect, graphics::drawLine, graphics::drawText and graphics::setFont
+	void drawRect(float center_x, float center_y, float width, float height, const graphics::Brush& brush);
+	void drawLine(float x1, float y1, float x2, float y2, const graphics::Brush& brush);
+	void drawText(float pos_x, float pos_y, float size, std::string_view text, const graphics::Brush& brush);
+	void setFont(const std::string& font);
+
+	// Sorts, merges and draws everything queued since beginFrame().
+	void flush();
+
+	// Draws the already sorted and merged commands of the last flush() again. Used when nothing in the scene has changed
+	// since the previous frame, so that we don't have to run any draw functions at all.
+	void replay();
+
+	unsigned int getStateChangesBefore() const		{ return m_stateChangesBefore; }
+	unsigned int getStateChangesAfter() const		{ return m_stateChangesAfter; }
+	unsigned int getSubmittedCommands() const		{ return m_submittedCommands; }
+	unsigned int getMergedCommands() const			{ return m_mergedCommands; }
+};
+
+/* queueRect/queueLine/queueText: Used by all our draw functions in place of graphics::drawRect/drawLine/drawText. Not
+ * named drawRect etc. because argument-dependent lookup on graphics::Brush would make those calls ambiguous. */
+inline void queueRect(float center_x, float center_y, float width, float height, const graphics::Brush& brush)
+{
+	RenderQueue::getInstance()->drawRect(center_x, center_y, width, height, brush);
+}
+
+inline void queueLine(float x1, float y1, float x2, float y2, const graphics::Brush& brush)
+{
+	RenderQueue::getInstance()->drawLine(x1, y1, x2, y2, brush);
+}
+
+inline void queueText(float pos_x, float pos_y, float size, std::string_view text, const graphics::Brush& brush)
+{
+	RenderQueue::getInstance()->drawText(pos_x, pos_y, size, text, brush);
+}
@@ -0,0 +1,51 @@
+#include "resultcursor.h"
+#include "profiler.h"
+
+#include <bit>
+
+void ResultCursor::reset(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& base)
+{
+	m_plan.assign(plan);
+	m_bound = m_plan.bind();
+	m_catalog = catalog;
+	m_base = &base;
+	if (m_scratch.size() != base.size()) {
+		m_scratch.resize(base.size());
+	}
+	m_nextWord = 0;
+	m_word = 0;
+	m_pending = 0;
+}
+
+bool ResultCursor::next(FilmId& id)
+{
+	while (!m_pending) {
+		if (!m_base || m_nextWord >= m_base->wordCount()) {
+			return false;
+		}
+		runFilter(m_bound, m_catalog, *m_base, m_scratch, m_nextWord, m_nextWord + 1);
+		m_word = m_nextWord++;
+		m_pending = m_scratch.word(m_word);
+	}
+
+	id = static_cast<FilmId>(m_word * 64 + std::countr_zero(m_pending));
+	m_pending &= m_pending - 1;
+	return true;
+}
+
+size_t ResultCursor::pull(std::vector<FilmId>& ids, size_t count)
+{
+	PROFILE_SCOPE("ResultCursor::pull");
+	size_t pulled{ 0 };
+	FilmId id{ 0 };
+	while (pulled < count && next(id)) {
+		ids.push_back(id);
+		++pulled;
+	}
+	return pulled;
+}
+
+bool ResultCursor::exhausted() const
+{
+	return !m_pending && (!m_base || m_nextWord >= m_base->wordCount());
+}
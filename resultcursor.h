@@ -0,0 +1,43 @@
+#pragma once
+#include "filterplan.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+
+#include <vector>
+#include <cstdint>
+
+/* ResultCursor: The results of a search as a stream, in FilmId order, that only does as much filtering as it is asked
+ * for. Each pull runs the plan's filter kernel over the next word of the films to search through (64 films) until it has
+ * found enough matches, and stops there; the next pull carries on where the last one left off.
+ *
+ * So filling a page of results costs what it takes to find that page's films, however many films match in total:
+ * FilmUI fills the visible page right away, pulls more when the user pages on, and leaves counting all the matches to
+ * the SearchWorker in the background.
+ *
+ * The cursor keeps a pointer to the films it searches through, so they must stay as they are until the next reset(). */
+
+class ResultCursor {
+private:
+	OwnedFilterPlan m_plan;
+	FilterPlan m_bound;							// m_plan, pointing at its own text
+	CatalogView m_catalog;
+	const FilmBitmap* m_base{ nullptr };
+
+	FilmBitmap m_scratch;						// only the word being looked at is ever filled in
+	size_t m_nextWord{ 0 };						// the next word of m_base to filter
+	size_t m_word{ 0 };							// the word m_pending came from
+	std::uint64_t m_pending{ 0 };				// the matches of m_word not handed out yet
+
+public:
+	// Starts a new stream: the films of base that pass the plan
+	void reset(const FilterPlan& plan, const CatalogView& catalog, const FilmBitmap& base);
+
+	// Takes the next match. Returns false once there are none left.
+	bool next(FilmId& id);
+
+	// Appends up to count of the next matches to ids. Returns how many it appended.
+	size_t pull(std::vector<FilmId>& ids, size_t count);
+
+	// true once every film has been looked at and handed out
+	bool exhausted() const;
+};
@@ -0,0 +1,329 @@
+#include "resultorder.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <cctype>
+#include <string>
+#include <utility>
+
+namespace {
+	std::uint64_t packKey(std::uint64_t primary, FilmId id)
+	{
+		return (primary << 32) | id;
+	}
+
+	// how well a text field matches one of the texts searched for: best at the very start, then at the start of a word
+	unsigned int matchScore(std::string_view field, std::string_view text, unsigned int atStart, unsigned int atWord, unsigned int anywhere)
+	{
+		if (text.empty()) {
+			return 0;
+		}
+		size_t at{ field.find(text) };
+		if (at == std::string_view::npos) {
+			return 0;
+		}
+		if (at == 0) {
+			return atStart;
+		}
+		return field[at - 1] == ' ' ? atWord : anywhere;
+	}
+
+	/* The relevance of a film to the texts of a plan: a title match counts the most, then the director, then the cast,
+	 * where it depends on the role of the best cast member matched (see roleWeight()): the leads count more than the
+	 * supporting cast, who count more than the extras. Only ever compared between the results of one search. */
+	unsigned int relevance(const FilterPlan& plan, const CatalogView& catalog, FilmId id)
+	{
+		const std::string_view title{ catalog.titles[id] };
+		const std::string_view director{ catalog.directors[id] };
+		const std::span<const Credit> cast{ catalog.credits.subspan(catalog.castOffsets[id], catalog.castOffsets[id + 1] - catalog.castOffsets[id]) };
+
+		// what one text is worth, where the predicate looks for it
+		auto scoreText{ [&](unsigned int predicate, std::string_view text) {
+			unsigned int score{ 0 };
+			if (predicate & (FilterPlan::TITLE | FilterPlan::ANY_TEXT)) {
+				score += matchScore(title, text, 12, 8, 4);
+			}
+			if (predicate & (FilterPlan::DIRECTOR | FilterPlan::ANY_TEXT)) {
+				score += matchScore(director, text, 6, 5, 3);
+			}
+			if ((predicate & (FilterPlan::ACTOR | FilterPlan::ANY_TEXT)) && !text.empty()) {
+				unsigned int best{ 0 };
+				for (const Credit& credit : cast) {
+					if (catalog.people[credit.person].find(text) != std::string::npos) {
+						best = std::max(best, roleWeight(credit.role));
+					}
+				}
+				score += best;
+			}
+			return score;
+		} };
+
+		// the terms a film must not match have nothing to add
+		unsigned int score{ scoreText(FilterPlan::TITLE, plan.title) + scoreText(FilterPlan::DIRECTOR, plan.director) +
+			scoreText(FilterPlan::ACTOR, plan.actor) + scoreText(FilterPlan::ANY_TEXT, plan.anyText) };
+		for (unsigned int term{ 0 }; term < plan.termCount; ++term) {
+			if (!plan.terms[term].excluded) {
+				score += scoreText(plan.terms[term].predicate, plan.terms[term].text);
+			}
+		}
+		return score;
+	}
+}
+
+const char* orderName(ResultOrder order)
+{
+	switch (order) {
+	case ResultOrder::YEAR:			return "year";
+	case ResultOrder::DIRECTOR:		return "director";
+	case ResultOrder::RELEVANCE:	return "relevance";
+	default:						return "title";
+	}
+}
+
+std::string collationKey(std::string_view text, bool dropArticle)
+{
+	std::string key;
+	key.reserve(text.size());
+	for (const char c : text) {
+		unsigned char byte{ static_cast<unsigned char>(c) };
+		if (byte >= 0x80 || std::isalnum(byte)) {
+			key.push_back(static_cast<char>(byte >= 0x80 ? byte : std::tolower(byte)));
+		}
+		else if (std::isspace(byte) && !key.empty() && key.back() != ' ') {
+			key.push_back(' ');
+		}
+	}
+	if (!key.empty() && key.back() == ' ') {
+		key.pop_back();
+	}
+
+	if (dropArticle) {
+		for (const std::string_view article : { "the ", "a ", "an " }) {
+			if (key.size() > article.size() && key.compare(0, article.size(), article) == 0) {
+				key.erase(0, article.size());
+				break;
+			}
+		}
+	}
+	return key;
+}
+
+void buildSortKeys(std::span<const unsigned int> years, std::span<const std::string> directors,
+	std::vector<std::uint64_t>& yearKeys, std::vector<std::uint64_t>& directorKeys)
+{
+	const size_t count{ years.size() };
+	yearKeys.resize(count);
+	for (size_t id{ 0 }; id < count; ++id) {
+		yearKeys[id] = packKey(years[id], static_cast<FilmId>(id));
+	}
+
+	// a director's key is their rank among all the directors, so films by the same director share it
+	std::vector<std::string> collated(count);
+	std::vector<FilmId> byDirector(count);
+	for (size_t id{ 0 }; id < count; ++id) {
+		collated[id] = collationKey(directors[id], false);
+		byDirector[id] = static_cast<FilmId>(id);
+	}
+	std::sort(byDirector.begin(), byDirector.end(), [&collated](FilmId a, FilmId b) { return collated[a] < collated[b]; });
+
+	directorKeys.resize(count);
+	std::uint64_t rank{ 0 };
+	for (size_t i{ 0 }; i < count; ++i) {
+		if (i > 0 && collated[byDirector[i]] != collated[byDirector[i - 1]]) {
+			++rank;
+		}
+		directorKeys[byDirector[i]] = packKey(rank, byDirector[i]);
+	}
+}
+
+void updateSortKeys(std::span<const std::uint64_t> previousDirectorKeys, std::span<const std::string> previousDirectors,
+	const FilmRemap& remap, std::span<const unsigned int> years, std::span<const std::string> directors,
+	std::vector<std::uint64_t>& yearKeys, std::vector<std::uint64_t>& directorKeys)
+{
+	const size_t count{ remap.size() };
+	yearKeys.resize(count);
+	for (size_t id{ 0 }; id < count; ++id) {
+		yearKeys[id] = packKey(years[id], static_cast<FilmId>(id));
+	}
+
+	// the ranks the old directors had, in order, each with one of their films to collate when looking an added one up
+	std::vector<std::pair<std::uint32_t, FilmId>> ranks;
+	ranks.reserve(previousDirectorKeys.size());
+	for (size_t id{ 0 }; id < previousDirectorKeys.size(); ++id) {
+		ranks.emplace_back(static_cast<std::uint32_t>(previousDirectorKeys[id] >> 32), static_cast<FilmId>(id));
+	}
+	std::sort(ranks.begin(), ranks.end());
+	ranks.erase(std::unique(ranks.begin(), ranks.end(), [](const auto& a, const auto& b) { return a.first == b.first; }), ranks.end());
+
+	/* every added film's director: either one of the old ones (at the index of their rank), or new, to be slotted in
+	 * before the old one at that index. New directors are numbered in collation order, so that the old ranks and the
+	 * new directors merge into one sequence: old index i goes to i plus the new directors before it. */
+	struct Lookup {
+		std::string collated;
+		size_t index;						// among the old ranks
+		bool found;
+	};
+	std::vector<Lookup> lookups;
+	lookups.reserve(remap.added.size());
+	for (const FilmId id : remap.added) {
+		std::string collated{ collationKey(directors[id], false) };
+		auto at{ std::partition_point(ranks.begin(), ranks.end(), [&](const auto& rank) {
+			return collationKey(previousDirectors[rank.second], false) < collated;
+		}) };
+		const size_t index{ static_cast<size_t>(at - ranks.begin()) };
+		const bool found{ at != ranks.end() && collationKey(previousDirectors[at->second], false) == collated };
+		lookups.push_back({ std::move(collated), index, found });
+	}
+	std::vector<std::pair<size_t, std::string>> newDirectors;
+	for (const Lookup& lookup : lookups) {
+		if (!lookup.found) {
+			newDirectors.emplace_back(lookup.index, lookup.collated);
+		}
+	}
+	std::sort(newDirectors.begin(), newDirectors.end());
+	newDirectors.erase(std::unique(newDirectors.begin(), newDirectors.end()), newDirectors.end());
+
+	std::vector<std::uint64_t> oldRanks(ranks.size());
+	for (size_t index{ 0 }, inserted{ 0 }; index < ranks.size(); ++index) {
+		while (inserted < newDirectors.size() && newDirectors[inserted].first <= index) {
+			++inserted;
+		}
+		oldRanks[index] = index + inserted;
+	}
+
+	directorKeys.resize(count);
+	for (size_t id{ 0 }; id < count; ++id) {
+		if (!remap.isAdded(static_cast<FilmId>(id))) {
+			const std::uint32_t rank{ static_cast<std::uint32_t>(previousDirectorKeys[remap.newToOld[id]] >> 32) };
+			auto at{ std::lower_bound(ranks.begin(), ranks.end(), std::make_pair(rank, FilmId{ 0 })) };
+			directorKeys[id] = packKey(oldRanks[at - ranks.begin()], static_cast<FilmId>(id));
+		}
+	}
+	for (size_t added{ 0 }; added < remap.added.size(); ++added) {
+		const Lookup& lookup{ lookups[added] };
+		std::uint64_t rank;
+		if (lookup.found) {
+			rank = oldRanks[lookup.index];
+		}
+		else {
+			const std::pair<size_t, std::string> key{ lookup.index, lookup.collated };
+			rank = lookup.index + static_cast<size_t>(std::lower_bound(newDirectors.begin(), newDirectors.end(), key) - newDirectors.begin());
+		}
+		directorKeys[remap.added[added]] = packKey(rank, remap.added[added]);
+	}
+}
+
+void radixSort(std::vector<std::uint64_t>::iterator first, std::vector<std::uint64_t>::iterator last, std::vector<std::uint64_t>& scratch)
+{
+	const size_t count{ static_cast<size_t>(last - first) };
+	if (count < 2) {
+		return;
+	}
+	if (scratch.size() < count) {
+		scratch.resize(count);
+	}
+
+	// only the bytes that differ between keys need a pass. For years and ranks next to ids, that's 4 or 5 of the 8.
+	std::uint64_t allSet{ ~0ull };
+	std::uint64_t anySet{ 0 };
+	for (auto key{ first }; key != last; ++key) {
+		allSet &= *key;
+		anySet |= *key;
+	}
+	const std::uint64_t varying{ allSet ^ anySet };
+	std::array<unsigned int, 8> shifts{};
+	unsigned int passes{ 0 };
+	for (unsigned int byte{ 0 }; byte < 8; ++byte) {
+		if ((varying >> (byte * 8)) & 0xFF) {
+			shifts[passes++] = byte * 8;
+		}
+	}
+	if (!passes) {
+		return;
+	}
+
+	// the histogram of the first byte to sort on; each pass then counts the next byte while it moves the keys
+	std::uint64_t* from{ &*first };
+	std::uint64_t* to{ scratch.data() };
+	std::array<size_t, 256> histogram{};
+	std::array<size_t, 256> nextHistogram{};
+	for (size_t i{ 0 }; i < count; ++i) {
+		++histogram[(from[i] >> shifts[0]) & 0xFF];
+	}
+
+	for (unsigned int pass{ 0 }; pass < passes; ++pass) {
+		const unsigned int shift{ shifts[pass] };
+		const unsigned int nextShift{ pass + 1 < passes ? shifts[pass + 1] : 0 };
+		std::exclusive_scan(histogram.begin(), histogram.end(), histogram.begin(), size_t{ 0 });
+		nextHistogram.fill(0);
+		for (size_t i{ 0 }; i < count; ++i) {
+			const std::uint64_t key{ from[i] };
+			to[histogram[(key >> shift) & 0xFF]++] = key;
+			++nextHistogram[(key >> nextShift) & 0xFF];
+		}
+		histogram = nextHistogram;
+		std::swap(from, to);
+	}
+
+	// after an odd number of passes, the sorted keys are in the scratch buffer
+	if (from != &*first) {
+		std::copy(from, from + count, first);
+	}
+}
+
+void ResultSorter::reset(const FilmBitmap& results, ResultOrder order, const CatalogView& catalog, const FilterPlan& plan)
+{
+	PROFILE_SCOPE("ResultSorter::reset");
+	m_keys.clear();
+	m_keys.reserve(results.count());
+	m_sorted = 0;
+
+	switch (order) {
+	case ResultOrder::YEAR:
+		results.forEach([this, &catalog](FilmId id) { m_keys.push_back(catalog.yearKeys[id]); });
+		break;
+	case ResultOrder::DIRECTOR:
+		results.forEach([this, &catalog](FilmId id) { m_keys.push_back(catalog.directorKeys[id]); });
+		break;
+	case ResultOrder::RELEVANCE:
+		/* the most relevant first, so the key is how far the score is from the best possible one. Scoring means looking
+		 * for the texts again, so the keys are worked out on the scheduler's workers, starting from the ids. */
+		results.forEach([this](FilmId id) { m_keys.push_back(id); });
+		TaskScheduler::getInstance()->parallelFor(0, m_keys.size(), FILTER_PARTITION_FILMS, [this, &catalog, &plan](size_t first, size_t last) {
+			for (size_t i{ first }; i < last; ++i) {
+				FilmId id{ static_cast<FilmId>(m_keys[i]) };
+				m_keys[i] = packKey(0xFFFF - std::min(relevance(plan, catalog, id), 0xFFFFu), id);
+			}
+		}, TaskPriority::URGENT);
+		break;
+	default:
+		// the title order is the order of the ids, which is the order forEach() goes in
+		results.forEach([this](FilmId id) { m_keys.push_back(id); });
+		m_sorted = m_keys.size();
+		break;
+	}
+}
+
+void ResultSorter::take(std::vector<FilmId>& ids, size_t count)
+{
+	PROFILE_SCOPE("ResultSorter::take");
+	count = std::min(count, m_keys.size());
+	if (count > m_sorted) {
+		// the keys before m_sorted are already the smallest ones, in order, so only the rest needs looking at
+		if (count * RESULT_SORT_PARTIAL < m_keys.size()) {
+			std::partial_sort(m_keys.begin() + m_sorted, m_keys.begin() + count, m_keys.end());
+			m_sorted = count;
+		}
+		else {
+			radixSort(m_keys.begin() + m_sorted, m_keys.end(), m_scratch);
+			m_sorted = m_keys.size();
+		}
+	}
+
+	for (size_t i{ ids.size() }; i < count; ++i) {
+		ids.push_back(static_cast<FilmId>(m_keys[i] & 0xFFFFFFFFu));
+	}
+}
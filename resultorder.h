@@ -0,0 +1,70 @@
+#pragma once
+#include "filterplan.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filmremap.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+/* The orders results can be shown in. Every order boils down to one 64 bit key per film: what the films are sorted on
+ * in the high 32 bits, the FilmId in the low 32. FilmIds are handed out in title order (see FilmCatalog::build()), so
+ * films that tie on the high bits end up in title order, no two keys are ever equal, and sorting the keys alone sorts the
+ * films; the ids come back out of the low bits.
+ *
+ * The year and director keys are worked out once, when the catalog is built, and carried over when it is updated. The title key is the FilmId itself, which
+ * is why the title order needs no sorting at all and can be streamed straight out of a ResultCursor. Relevance depends
+ * on what was searched for, so its keys are worked out per search. */
+
+enum class ResultOrder : unsigned char { TITLE, YEAR, DIRECTOR, RELEVANCE };
+
+// what the order is called in the UI ("title", "year"...)
+const char* orderName(ResultOrder order);
+
+/* The form of a title or name we sort on: lowercase, with punctuation dropped and runs of spaces squeezed into one, and,
+ * for titles, without a leading "the", "a" or "an". Bytes outside ASCII are kept as they are, so accented letters still
+ * sort after the plain ones instead of getting mixed up with punctuation. */
+std::string collationKey(std::string_view text, bool dropArticle);
+
+// Works out the year and director key columns of a catalog from its year and (lowercase) director columns
+void buildSortKeys(std::span<const unsigned int> years, std::span<const std::string> directors,
+	std::vector<std::uint64_t>& yearKeys, std::vector<std::uint64_t>& directorKeys);
+
+/* The same, for a catalog that was updated (by remap) from one with the given director keys and column. The films that
+ * stay keep their director's rank, shifted past the directors that are new; only the directors of the added films are
+ * collated, and looked up among the old ones by a binary search. */
+void updateSortKeys(std::span<const std::uint64_t> previousDirectorKeys, std::span<const std::string> previousDirectors,
+	const FilmRemap& remap, std::span<const unsigned int> years, std::span<const std::string> directors,
+	std::vector<std::uint64_t>& yearKeys, std::vector<std::uint64_t>& directorKeys);
+
+/* ResultSorter: Hands out a set of results in one of the orders, sorting only as much of them as has been asked for. The
+ * first pages come from a partial sort (std::partial_sort) of only the keys they need; once more than a 1/RESULT_SORT_PARTIAL
+ * of the results has been asked for, the rest are radix sorted in one go (an LSD radix sort on bytes, skipping the
+ * bytes that are the same in every key, which for years and ranks are most of them). */
+class ResultSorter {
+private:
+	std::vector<std::uint64_t> m_keys;
+	std::vector<std::uint64_t> m_scratch;
+	size_t m_sorted{ 0 };						// the first m_sorted keys are in their final place
+
+public:
+	// Takes the films of results and their keys in the given order. The plan is only looked at for RELEVANCE.
+	void reset(const FilmBitmap& results, ResultOrder order, const CatalogView& catalog, const FilterPlan& plan);
+
+	// Appends the films of the sorted results to ids, from ids.size() up to count (or the end of the results)
+	void take(std::vector<FilmId>& ids, size_t count);
+
+	// Sorts all the keys with the given sort instead, for the benchmark to compare against
+	template <typename Sort>
+	void sortWith(Sort sort) {
+		sort(m_keys.begin() + m_sorted, m_keys.end());
+		m_sorted = m_keys.size();
+	}
+
+	size_t size() const										{ return m_keys.size(); }
+};
+
+// Sorts 64 bit keys in place, least significant byte first. scratch is resized as needed and can be reused between calls.
+void radixSort(std::vector<std::uint64_t>::iterator first, std::vector<std::uint64_t>::iterator last, std::vector<std::uint64_t>& scratch);
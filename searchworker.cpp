@@ -0,0 +1,139 @@
+#include "searchworker.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <chrono>
+
+SearchWorker::~SearchWorker()
+{
+	stop();
+}
+
+void SearchWorker::start()
+{
+	m_thread = std::thread{ &SearchWorker::workerLoop, this };
+}
+
+void SearchWorker::stop()
+{
+	if (!m_thread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stopping = true;
+	}
+	++m_generation;			// so a running search gives up at its next chunk
+	m_wakeUp.notify_one();
+	m_thread.join();
+}
+
+void SearchWorker::submit(const FilterPlan& plan, const FilmBitmap& base, const CatalogRef& catalog)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_waiting.assign(plan);
+		m_waiting.base = base;				// the waiting query's bitmap is reused from one search to the next
+		m_waiting.catalog = catalog;
+		m_waiting.generation = ++m_generation;
+		m_hasWaiting = true;
+	}
+	m_wakeUp.notify_one();
+}
+
+void SearchWorker::cancel()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_hasWaiting = false;
+	m_received = ++m_generation;
+}
+
+bool SearchWorker::takeResult(FilmBitmap& selection)
+{
+	bool taken{ false };
+	SearchResult result;
+	while (m_results.pop(result)) {
+		if (result.generation == m_generation.load()) {
+			selection.swap(result.selection);
+			m_received = result.generation;
+			taken = true;
+		}
+
+		// either way, the bitmap we're left holding can be filled in again. If the worker has all the bitmaps it can take, it is simply freed.
+		m_recycled.push(std::move(result.selection));
+	}
+	return taken;
+}
+
+bool SearchWorker::isBusy() const
+{
+	return m_received != m_generation.load();
+}
+
+float SearchWorker::getProgress() const
+{
+	size_t total{ m_progressTotal.load() };
+	return total ? std::min(1.0f, static_cast<float>(m_progress.load()) / total) : 0.0f;
+}
+
+void SearchWorker::workerLoop()
+{
+	SearchQuery query;
+	FilmBitmap spare;			// the bitmap of the last superseded search, for the next one
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_wakeUp.wait(lock, [this] { return m_stopping || m_hasWaiting; });
+			if (m_stopping) {
+				return;
+			}
+			// swapping rather than copying, so that both queries keep the memory they have for the next time
+			std::swap(query, m_waiting);
+			m_hasWaiting = false;
+		}
+
+		PROFILE_SCOPE("SearchWorker::search");
+		const FilterPlan plan{ query.bind() };
+		const CatalogView catalog{ query.catalog->view() };
+
+		SearchResult result;
+		result.generation = query.generation;
+		if (spare.size()) {
+			result.selection.swap(spare);
+		}
+		else {
+			m_recycled.pop(result.selection);
+		}
+		if (result.selection.size() != query.base.size()) {
+			result.selection.resize(query.base.size());
+		}
+
+		/* running the search a partition at a time on the scheduler's priority lane, so it gets the workers ahead of any bulk
+		 * work. Once it has been superseded, the partitions that haven't started yet are skipped. */
+		m_progressTotal = query.base.size();
+		m_progress = 0;
+		TaskScheduler::getInstance()->parallelFor(0, query.base.wordCount(), filterPartitionWords(), [&](size_t firstWord, size_t lastWord) {
+			if (m_generation.load() != query.generation) {
+				return;
+			}
+			runFilter(plan, catalog, query.base, result.selection, firstWord, lastWord);
+			m_progress += (lastWord - firstWord) * 64;
+		}, TaskPriority::URGENT);
+		query.catalog = {};				// so a catalog that has been reloaded since can go, without waiting for the next search
+		if (m_generation.load() != query.generation) {
+			spare.swap(result.selection);
+			continue;
+		}
+
+		// the UI thread takes results every frame, so the queue being full can only last a moment
+		while (!m_results.push(std::move(result))) {
+			if (m_generation.load() != query.generation) {
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "global.h"
+#include "filterplan.h"
+#include "catalogstore.h"
+#include "filmbitmap.h"
+#include "spscqueue.h"
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/* SearchWorker: Runs searches on a thread of its own, so that a slow search on a large catalog never holds up a frame.
+ * FilmUI submits a FilterPlan along with the films to search through, and the version of the catalog they are films of,
+ * and keeps drawing the results it already has until the new ones are in. The search holds a reference to that version
+ * (see CatalogStore) until it is done, so the catalog can be reloaded while it runs. The filter itself is split into
+ * partitions (see runFilterParallel()) that the worker runs on the TaskScheduler's priority lane, together with
+ * whichever of the scheduler's workers are free.
+ *
+ * Only the most recent search matters: submitting one supersedes whatever was waiting, and a search that is already
+ * running skips the partitions it hasn't started yet once it has been superseded. (So while typing, the worker is only
+ * ever busy with what has been typed so far, never with a backlog of every letter.)
+ *
+ * Results come back through a lock-free SpscQueue, which FilmUI polls once per frame; whatever isn't the result of the
+ * latest search is dropped on arrival. The bitmaps of the results FilmUI is done with go back to the worker through a
+ * second queue, to be filled in again, so once both sides have warmed up searching allocates nothing. */
+
+class SearchWorker {
+private:
+	// SearchQuery: The plan owns its text, since the widgets it came from may change it while the search runs
+	struct SearchQuery : OwnedFilterPlan {
+		FilmBitmap base;						// the films to search through
+		CatalogRef catalog;						// of the catalog they are films of
+		unsigned long long generation{ 0 };
+	};
+
+	struct SearchResult {
+		unsigned long long generation{ 0 };
+		FilmBitmap selection;
+	};
+
+	// m_mutex: Guards the waiting query, which the UI thread writes and the worker takes
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	SearchQuery m_waiting;
+	bool m_hasWaiting{ false };
+	bool m_stopping{ false };
+
+	// m_generation: The latest search submitted (or cancelled). The worker compares its own search's against it.
+	std::atomic<unsigned long long> m_generation{ 0 };
+
+	// m_progress: How many films of the running search have been looked at, out of m_progressTotal
+	std::atomic<size_t> m_progress{ 0 };
+	std::atomic<size_t> m_progressTotal{ 0 };
+
+	SpscQueue<SearchResult, 8> m_results;		// worker -> UI
+	SpscQueue<FilmBitmap, 8> m_recycled;		// UI -> worker, bitmaps to reuse
+
+	// m_received: The generation of the last result FilmUI took (UI thread only)
+	unsigned long long m_received{ 0 };
+
+	std::thread m_thread;
+
+	void workerLoop();
+
+public:
+	SearchWorker() = default;
+	~SearchWorker();
+
+	SearchWorker(const SearchWorker&) = delete;
+	SearchWorker& operator=(const SearchWorker&) = delete;
+
+	// Starts the worker thread
+	void start();
+
+	// Stops and joins the worker thread. Called by the destructor, if it hasn't been already.
+	void stop();
+
+	// Searches the films selected in base (of the given catalog) for the ones that pass the plan. Supersedes any search
+	// still waiting or running.
+	void submit(const FilterPlan& plan, const FilmBitmap& base, const CatalogRef& catalog);
+
+	// Drops any search still waiting or running, for when the selection is about to be set without searching
+	void cancel();
+
+	// If the result of the latest search has arrived, swaps it into selection and returns true
+	bool takeResult(FilmBitmap& selection);
+
+	// true from submit() until its result has been taken (or the search has been cancelled)
+	bool isBusy() const;
+
+	// how far along the running search is, from 0 to 1
+	float getProgress() const;
+};
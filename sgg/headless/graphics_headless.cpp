@@ -0,0 +1,658 @@
+#include "graphics.h"
+#include "headless.h"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+
+/* graphics_headless.cpp: A drop-in replacement for sgg.lib that needs no window, GPU or audio device. See headless.h. */
+
+namespace
+{
+	// one scripted input event
+	struct ScriptEvent {
+		enum class Type { MOVE, PRESS, RELEASE, KEY_DOWN, KEY_UP, QUIT } type;
+		float x{ 0.0f };
+		float y{ 0.0f };
+		int value{ 0 };		// the mouse button (0 left, 1 middle, 2 right) or the scancode
+	};
+
+	struct HeadlessState {
+		int windowWidth{ 0 };
+		int windowHeight{ 0 };
+		float canvasWidth{ 0.0f };
+		float canvasHeight{ 0.0f };
+		graphics::scale_mode_t scaleMode{ graphics::CANVAS_SCALE_WINDOW };
+
+		std::function<void()> drawFunction;
+		std::function<void(float)> updateFunction;
+		std::function<void(int, int)> resizeFunction;
+		const void* userData{ nullptr };
+
+		unsigned int frameLimit{ 600 };
+		unsigned int frame{ 0 };
+		float deltaTime{ 1000.0f / 60.0f };
+		float globalTime{ 0.0f };
+		bool stopping{ false };
+
+		// input: the current state, and the state at the start of the previous frame to derive the edges from
+		bool buttons[3]{};
+		bool previousButtons[3]{};
+		int mouseX{ 0 };
+		int mouseY{ 0 };
+		int previousMouseX{ 0 };
+		int previousMouseY{ 0 };
+		std::array<bool, 512> keys{};
+		graphics::MouseState mouse{};
+		std::multimap<unsigned int, ScriptEvent> script;
+
+		// recording
+		std::vector<unsigned char> buffer;
+		std::vector<std::string> strings;
+		std::unordered_map<std::string, unsigned int> stringIds;
+		std::string recordPath;
+
+		double updateDrawMilliseconds{ 0.0 };
+	};
+
+	HeadlessState& state()
+	{
+		static HeadlessState s_state;
+		return s_state;
+	}
+
+	unsigned int intern(const std::string& text)
+	{
+		HeadlessState& s{ state() };
+		auto iter{ s.stringIds.find(text) };
+		if (iter != s.stringIds.end()) {
+			return iter->second;
+		}
+		unsigned int id{ static_cast<unsigned int>(s.strings.size()) };
+		s.strings.push_back(text);
+		s.stringIds.emplace(text, id);
+		return id;
+	}
+
+	void putOp(graphics::headless::CommandOp op)
+	{
+		state().buffer.push_back(static_cast<unsigned char>(op));
+	}
+
+	void putFloat(float value)
+	{
+		unsigned char bytes[sizeof(float)];
+		std::memcpy(bytes, &value, sizeof(float));
+		state().buffer.insert(state().buffer.end(), bytes, bytes + sizeof(float));
+	}
+
+	void putUInt(unsigned int value)
+	{
+		unsigned char bytes[sizeof(unsigned int)];
+		std::memcpy(bytes, &value, sizeof(unsigned int));
+		state().buffer.insert(state().buffer.end(), bytes, bytes + sizeof(unsigned int));
+	}
+
+	// a brush is stored as: fill rgba, outline rgba, outline width, gradient flag, texture string id
+	void putBrush(const graphics::Brush& brush)
+	{
+		for (const float value : { brush.fill_color[0], brush.fill_color[1], brush.fill_color[2], brush.fill_opacity,
+			brush.outline_color[0], brush.outline_color[1], brush.outline_color[2], brush.outline_opacity, brush.outline_width }) {
+			putFloat(value);
+		}
+		state().buffer.push_back(brush.gradient ? 1 : 0);
+		putUInt(intern(brush.texture));
+	}
+
+	// the scale and offsets that map canvas units to window pixels, according to the canvas scale mode
+	void canvasTransform(float& scaleX, float& scaleY, float& offsetX, float& offsetY)
+	{
+		HeadlessState& s{ state() };
+		scaleX = scaleY = 1.0f;
+		offsetX = offsetY = 0.0f;
+		if (s.canvasWidth <= 0.0f || s.canvasHeight <= 0.0f) {
+			return;
+		}
+		if (s.scaleMode == graphics::CANVAS_SCALE_STRETCH) {
+			scaleX = s.windowWidth / s.canvasWidth;
+			scaleY = s.windowHeight / s.canvasHeight;
+		}
+		else if (s.scaleMode == graphics::CANVAS_SCALE_FIT) {
+			scaleX = scaleY = std::min(s.windowWidth / s.canvasWidth, s.windowHeight / s.canvasHeight);
+			offsetX = (s.windowWidth - s.canvasWidth * scaleX) / 2.0f;
+			offsetY = (s.windowHeight - s.canvasHeight * scaleY) / 2.0f;
+		}
+	}
+
+	int parseKey(const std::string& name)
+	{
+		if (name.size() == 1 && std::isalpha(static_cast<unsigned char>(name[0]))) {
+			return graphics::SCANCODE_A + (std::toupper(static_cast<unsigned char>(name[0])) - 'A');
+		}
+		if (name.size() == 1 && std::isdigit(static_cast<unsigned char>(name[0]))) {
+			return name[0] == '0' ? graphics::SCANCODE_0 : graphics::SCANCODE_1 + (name[0] - '1');
+		}
+		static const std::unordered_map<std::string, int> names{
+			{ "RETURN", graphics::SCANCODE_RETURN }, { "ESCAPE", graphics::SCANCODE_ESCAPE },
+			{ "BACKSPACE", graphics::SCANCODE_BACKSPACE }, { "TAB", graphics::SCANCODE_TAB },
+			{ "SPACE", graphics::SCANCODE_SPACE }, { "MINUS", graphics::SCANCODE_MINUS },
+			{ "SEMICOLON", graphics::SCANCODE_SEMICOLON }, { "APOSTROPHE", graphics::SCANCODE_APOSTROPHE },
+			{ "COMMA", graphics::SCANCODE_COMMA }, { "PERIOD", graphics::SCANCODE_PERIOD },
+			{ "F1", graphics::SCANCODE_F1 }, { "F2", graphics::SCANCODE_F2 }, { "F3", graphics::SCANCODE_F3 },
+			{ "F4", graphics::SCANCODE_F4 }, { "F5", graphics::SCANCODE_F5 }, { "F6", graphics::SCANCODE_F6 },
+			{ "HOME", graphics::SCANCODE_HOME }, { "END", graphics::SCANCODE_END }, { "DELETE", graphics::SCANCODE_DELETE },
+			{ "PAGEUP", graphics::SCANCODE_PAGEUP }, { "PAGEDOWN", graphics::SCANCODE_PAGEDOWN },
+			{ "LEFT", graphics::SCANCODE_LEFT }, { "RIGHT", graphics::SCANCODE_RIGHT },
+			{ "UP", graphics::SCANCODE_UP }, { "DOWN", graphics::SCANCODE_DOWN },
+			{ "LCTRL", graphics::SCANCODE_LCTRL }, { "RCTRL", graphics::SCANCODE_RCTRL },
+			{ "LSHIFT", graphics::SCANCODE_LSHIFT }, { "RSHIFT", graphics::SCANCODE_RSHIFT },
+		};
+		auto iter{ names.find(name) };
+		if (iter != names.end()) {
+			return iter->second;
+		}
+		char* end{ nullptr };
+		long value{ std::strtol(name.c_str(), &end, 10) };
+		return (end && *end == '\0' && value > 0 && value < 512) ? static_cast<int>(value) : -1;
+	}
+
+	int parseButton(const std::string& name)
+	{
+		if (name == "left") return 0;
+		if (name == "middle") return 1;
+		if (name == "right") return 2;
+		return -1;
+	}
+
+	// applies the scripted events of the current frame, then works out the mouse state the application will see
+	void applyInput()
+	{
+		HeadlessState& s{ state() };
+		s.previousMouseX = s.mouseX;
+		s.previousMouseY = s.mouseY;
+		std::copy(std::begin(s.buttons), std::end(s.buttons), s.previousButtons);
+
+		auto range{ s.script.equal_range(s.frame) };
+		for (auto iter{ range.first }; iter != range.second; ++iter) {
+			const ScriptEvent& event{ iter->second };
+			switch (event.type) {
+			case ScriptEvent::Type::MOVE: {
+				float scaleX, scaleY, offsetX, offsetY;
+				canvasTransform(scaleX, scaleY, offsetX, offsetY);
+				s.mouseX = static_cast<int>(event.x * scaleX + offsetX + 0.5f);
+				s.mouseY = static_cast<int>(event.y * scaleY + offsetY + 0.5f);
+				break;
+			}
+			case ScriptEvent::Type::PRESS: s.buttons[event.value] = true; break;
+			case ScriptEvent::Type::RELEASE: s.buttons[event.value] = false; break;
+			case ScriptEvent::Type::KEY_DOWN: s.keys[event.value] = true; break;
+			case ScriptEvent::Type::KEY_UP: s.keys[event.value] = false; break;
+			case ScriptEvent::Type::QUIT: s.stopping = true; break;
+			}
+		}
+
+		graphics::MouseState& mouse{ s.mouse };
+		mouse.button_left_pressed = s.buttons[0] && !s.previousButtons[0];
+		mouse.button_middle_pressed = s.buttons[1] && !s.previousButtons[1];
+		mouse.button_right_pressed = s.buttons[2] && !s.previousButtons[2];
+		mouse.button_left_released = !s.buttons[0] && s.previousButtons[0];
+		mouse.button_middle_released = !s.buttons[1] && s.previousButtons[1];
+		mouse.button_right_released = !s.buttons[2] && s.previousButtons[2];
+		mouse.button_left_down = s.buttons[0];
+		mouse.button_middle_down = s.buttons[1];
+		mouse.button_right_down = s.buttons[2];
+		mouse.dragging = s.buttons[0] && (s.mouseX != s.previousMouseX || s.mouseY != s.previousMouseY);
+		mouse.cur_pos_x = s.mouseX;
+		mouse.cur_pos_y = s.mouseY;
+		mouse.prev_pos_x = s.previousMouseX;
+		mouse.prev_pos_y = s.previousMouseY;
+	}
+
+	// readers for dumpCommands()
+	float getFloat(const std::vector<unsigned char>& buffer, size_t& pos)
+	{
+		float value;
+		std::memcpy(&value, &buffer[pos], sizeof(float));
+		pos += sizeof(float);
+		return value;
+	}
+
+	unsigned int getUInt(const std::vector<unsigned char>& buffer, size_t& pos)
+	{
+		unsigned int value;
+		std::memcpy(&value, &buffer[pos], sizeof(unsigned int));
+		pos += sizeof(unsigned int);
+		return value;
+	}
+
+	void dumpFloats(std::ostringstream& out, const std::vector<unsigned char>& buffer, size_t& pos, int count)
+	{
+		char text[32];
+		for (int i{ 0 }; i < count; ++i) {
+			std::snprintf(text, sizeof(text), " %.3f", getFloat(buffer, pos));
+			out << text;
+		}
+	}
+
+	void dumpBrush(std::ostringstream& out, const std::vector<unsigned char>& buffer, size_t& pos)
+	{
+		out << " fill";
+		dumpFloats(out, buffer, pos, 4);
+		out << " outline";
+		dumpFloats(out, buffer, pos, 5);
+		out << (buffer[pos++] ? " gradient" : "");
+		const std::string& texture{ state().strings[getUInt(buffer, pos)] };
+		if (!texture.empty()) {
+			out << " texture \"" << texture << "\"";
+		}
+	}
+}
+
+namespace graphics
+{
+	void createWindow(int width, int height, std::string /*title*/)
+	{
+		HeadlessState& s{ state() };
+		s.windowWidth = width;
+		s.windowHeight = height;
+		s.canvasWidth = static_cast<float>(width);
+		s.canvasHeight = static_cast<float>(height);
+
+		if (const char* frames{ std::getenv("FILMGUI_HEADLESS_FRAMES") }) {
+			s.frameLimit = static_cast<unsigned int>(std::strtoul(frames, nullptr, 10));
+		}
+		if (const char* dt{ std::getenv("FILMGUI_HEADLESS_DT") }) {
+			s.deltaTime = std::strtof(dt, nullptr);
+		}
+		if (const char* record{ std::getenv("FILMGUI_HEADLESS_RECORD") }) {
+			s.recordPath = record;
+		}
+		if (const char* script{ std::getenv("FILMGUI_HEADLESS_SCRIPT") }) {
+			if (!headless::loadScript(script)) {
+				std::cerr << "headless: could not load input script " << script << std::endl;
+			}
+		}
+	}
+
+	void setWindowBackground(Brush /*style*/)
+	{
+	}
+
+	void destroyWindow()
+	{
+		HeadlessState& s{ state() };
+		if (!s.recordPath.empty()) {
+			std::ofstream record{ s.recordPath };
+			record << headless::dumpCommands();
+		}
+		std::cerr << "headless: " << s.frame << " frames, " << s.buffer.size() << " bytes of commands, "
+			<< (s.frame ? s.updateDrawMilliseconds / s.frame : 0.0) << " ms per frame in update + draw" << std::endl;
+	}
+
+	void startMessageLoop()
+	{
+		HeadlessState& s{ state() };
+		s.stopping = false;
+		while (!s.stopping && s.frame < s.frameLimit) {
+			applyInput();
+			if (s.stopping) {
+				break;
+			}
+
+			putOp(headless::CommandOp::FRAME);
+			putUInt(s.frame);
+
+			auto start{ std::chrono::steady_clock::now() };
+			if (s.updateFunction) {
+				s.updateFunction(s.deltaTime);
+			}
+			if (s.drawFunction) {
+				s.drawFunction();
+			}
+			s.updateDrawMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			s.globalTime += s.deltaTime;
+			++s.frame;
+		}
+	}
+
+	void stopMessageLoop()
+	{
+		state().stopping = true;
+	}
+
+	void setCanvasSize(float w, float h)
+	{
+		state().canvasWidth = w;
+		state().canvasHeight = h;
+	}
+
+	void setCanvasScaleMode(scale_mode_t sm)
+	{
+		state().scaleMode = sm;
+	}
+
+	void setFullScreen(bool /*fs*/)
+	{
+	}
+
+	float windowToCanvasX(float x, bool clamped)
+	{
+		float scaleX, scaleY, offsetX, offsetY;
+		canvasTransform(scaleX, scaleY, offsetX, offsetY);
+		float result{ (x - offsetX) / scaleX };
+		return clamped ? std::clamp(result, 0.0f, state().canvasWidth) : result;
+	}
+
+	float windowToCanvasY(float y, bool clamped)
+	{
+		float scaleX, scaleY, offsetX, offsetY;
+		canvasTransform(scaleX, scaleY, offsetX, offsetY);
+		float result{ (y - offsetY) / scaleY };
+		return clamped ? std::clamp(result, 0.0f, state().canvasHeight) : result;
+	}
+
+	void setUserData(const void* user_data)
+	{
+		state().userData = user_data;
+	}
+
+	void* getUserData()
+	{
+		return const_cast<void*>(state().userData);
+	}
+
+	void setDrawFunction(std::function<void()> draw)
+	{
+		state().drawFunction = draw;
+	}
+
+	void setUpdateFunction(std::function<void(float)> update)
+	{
+		state().updateFunction = update;
+	}
+
+	void setResizeFunction(std::function<void(int, int)> resize)
+	{
+		state().resizeFunction = resize;
+	}
+
+	void getMouseState(MouseState& ms)
+	{
+		ms = state().mouse;
+	}
+
+	bool getKeyState(scancode_t key)
+	{
+		return key >= 0 && key < static_cast<int>(state().keys.size()) && state().keys[key];
+	}
+
+	float getDeltaTime()
+	{
+		return state().deltaTime;
+	}
+
+	float getGlobalTime()
+	{
+		return state().globalTime;
+	}
+
+	void drawRect(float center_x, float center_y, float width, float height, const Brush& brush)
+	{
+		putOp(headless::CommandOp::RECT);
+		for (const float value : { center_x, center_y, width, height }) {
+			putFloat(value);
+		}
+		putBrush(brush);
+	}
+
+	void drawLine(float x1, float y1, float x2, float y2, const Brush& brush)
+	{
+		putOp(headless::CommandOp::LINE);
+		for (const float value : { x1, y1, x2, y2 }) {
+			putFloat(value);
+		}
+		putBrush(brush);
+	}
+
+	void drawDisk(float cx, float cy, float radius, const Brush& brush)
+	{
+		putOp(headless::CommandOp::DISK);
+		for (const float value : { cx, cy, radius }) {
+			putFloat(value);
+		}
+		putBrush(brush);
+	}
+
+	void drawSector(float cx, float cy, float radius1, float radius2, float start_angle, float end_angle, const Brush& brush)
+	{
+		putOp(headless::CommandOp::SECTOR);
+		for (const float value : { cx, cy, radius1, radius2, start_angle, end_angle }) {
+			putFloat(value);
+		}
+		putBrush(brush);
+	}
+
+	bool setFont(std::string fontname)
+	{
+		putOp(headless::CommandOp::SET_FONT);
+		putUInt(intern(fontname));
+		return std::filesystem::exists(fontname);
+	}
+
+	void drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush)
+	{
+		putOp(headless::CommandOp::TEXT);
+		for (const float value : { pos_x, pos_y, size }) {
+			putFloat(value);
+		}
+		putUInt(intern(text));
+		putBrush(brush);
+	}
+
+	void setOrientation(float angle)
+	{
+		putOp(headless::CommandOp::SET_ORIENTATION);
+		putFloat(angle);
+	}
+
+	void setScale(float sx, float sy)
+	{
+		putOp(headless::CommandOp::SET_SCALE);
+		putFloat(sx);
+		putFloat(sy);
+	}
+
+	void resetPose()
+	{
+		putOp(headless::CommandOp::RESET_POSE);
+	}
+
+	std::vector<std::string> preloadBitmaps(std::string dir)
+	{
+		// there is nothing to upload, so "preloading" only reports which bitmaps there are
+		std::vector<std::string> bitmaps;
+		std::error_code error;
+		for (const auto& file : std::filesystem::directory_iterator{ dir, error }) {
+			std::string extension{ file.path().extension().string() };
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			if (file.is_regular_file() && extension == ".png") {
+				bitmaps.push_back(file.path().string());
+			}
+		}
+		return bitmaps;
+	}
+
+	void playSound(std::string soundfile, float volume, bool /*looping*/)
+	{
+		putOp(headless::CommandOp::PLAY_SOUND);
+		putUInt(intern(soundfile));
+		putFloat(volume);
+	}
+
+	void playMusic(std::string /*soundfile*/, float /*volume*/, bool /*looping*/, int /*fade_time*/)
+	{
+	}
+
+	void stopMusic(int /*fade_time*/)
+	{
+	}
+
+	namespace headless
+	{
+		bool loadScript(const std::string& path)
+		{
+			std::ifstream script{ path };
+			if (!script) {
+				return false;
+			}
+
+			std::string line;
+			while (std::getline(script, line)) {
+				std::istringstream tokenizer(line);
+				unsigned int frame;
+				std::string command;
+				if (line.empty() || line[0] == '#' || !(tokenizer >> frame >> command)) {
+					continue;
+				}
+
+				ScriptEvent event{};
+				std::string argument;
+				if (command == "move") {
+					event.type = ScriptEvent::Type::MOVE;
+					if (!(tokenizer >> event.x >> event.y)) {
+						return false;
+					}
+				}
+				else if (command == "press" || command == "release") {
+					event.type = command == "press" ? ScriptEvent::Type::PRESS : ScriptEvent::Type::RELEASE;
+					tokenizer >> argument;
+					event.value = parseButton(argument);
+				}
+				else if (command == "keydown" || command == "keyup") {
+					event.type = command == "keydown" ? ScriptEvent::Type::KEY_DOWN : ScriptEvent::Type::KEY_UP;
+					tokenizer >> argument;
+					event.value = parseKey(argument);
+				}
+				else if (command == "quit") {
+					event.type = ScriptEvent::Type::QUIT;
+				}
+				else {
+					return false;
+				}
+				if (event.value < 0) {
+					return false;
+				}
+				state().script.emplace(frame, event);
+			}
+			return true;
+		}
+
+		void setFrameLimit(unsigned int frames)
+		{
+			state().frameLimit = frames;
+		}
+
+		void setFixedDeltaTime(float ms)
+		{
+			state().deltaTime = ms;
+		}
+
+		const std::vector<unsigned char>& getCommandBuffer()
+		{
+			return state().buffer;
+		}
+
+		const std::vector<std::string>& getStrings()
+		{
+			return state().strings;
+		}
+
+		void clearCommandBuffer()
+		{
+			state().buffer.clear();
+		}
+
+		unsigned int getFrameCount()
+		{
+			return state().frame;
+		}
+
+		std::string dumpCommands()
+		{
+			const std::vector<unsigned char>& buffer{ state().buffer };
+			const std::vector<std::string>& strings{ state().strings };
+			std::ostringstream out;
+
+			size_t pos{ 0 };
+			while (pos < buffer.size()) {
+				CommandOp op{ static_cast<CommandOp>(buffer[pos++]) };
+				switch (op) {
+				case CommandOp::FRAME:
+					out << "FRAME " << getUInt(buffer, pos);
+					break;
+				case CommandOp::RECT:
+					out << "RECT";
+					dumpFloats(out, buffer, pos, 4);
+					dumpBrush(out, buffer, pos);
+					break;
+				case CommandOp::LINE:
+					out << "LINE";
+					dumpFloats(out, buffer, pos, 4);
+					dumpBrush(out, buffer, pos);
+					break;
+				case CommandOp::DISK:
+					out << "DISK";
+					dumpFloats(out, buffer, pos, 3);
+					dumpBrush(out, buffer, pos);
+					break;
+				case CommandOp::SECTOR:
+					out << "SECTOR";
+					dumpFloats(out, buffer, pos, 6);
+					dumpBrush(out, buffer, pos);
+					break;
+				case CommandOp::TEXT: {
+					out << "TEXT";
+					dumpFloats(out, buffer, pos, 3);
+					out << " \"" << strings[getUInt(buffer, pos)] << "\"";
+					dumpBrush(out, buffer, pos);
+					break;
+				}
+				case CommandOp::SET_FONT:
+					out << "SET_FONT \"" << strings[getUInt(buffer, pos)] << "\"";
+					break;
+				case CommandOp::SET_ORIENTATION:
+					out << "SET_ORIENTATION";
+					dumpFloats(out, buffer, pos, 1);
+					break;
+				case CommandOp::SET_SCALE:
+					out << "SET_SCALE";
+					dumpFloats(out, buffer, pos, 2);
+					break;
+				case CommandOp::RESET_POSE:
+					out << "RESET_POSE";
+					break;
+				case CommandOp::PLAY_SOUND:
+					out << "PLAY_SOUND \"" << strings[getUInt(buffer, pos)] << "\"";
+					dumpFloats(out, buffer, pos, 1);
+					break;
+				}
+				out << '\n';
+			}
+			return out.str();
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "graphics.h"
+
+#include <string>
+#include <vector>
+
+/** \file headless.h Extra API of the headless SGG backend (graphics_headless.cpp).
+
+	The headless backend implements the graphics namespace without a window, a GPU or an audio device, so that the
+	application's update/draw loop can run on machines without a display (e.g. Linux build hosts) for benchmarks and
+	regression tests. Instead of rasterising, every draw call is appended to a compact binary command buffer, which can
+	be dumped as text and diffed between runs. Mouse and keyboard input come from a script instead of a device.
+
+	The backend is configured through environment variables read in createWindow():
+	- FILMGUI_HEADLESS_FRAMES: how many frames startMessageLoop() runs before returning (default 600).
+	- FILMGUI_HEADLESS_DT: the fixed frame time in milliseconds reported by getDeltaTime() (default 16.667).
+	- FILMGUI_HEADLESS_SCRIPT: an input script to play back (see loadScript()).
+	- FILMGUI_HEADLESS_RECORD: a file to write the text dump of every recorded command to, on destroyWindow().
+*/
+namespace graphics
+{
+	namespace headless
+	{
+		/** The operations stored in the command buffer. Every entry is one opcode byte followed by its payload. */
+		enum class CommandOp : unsigned char {
+			FRAME = 0,		///< marks the start of a frame. Payload: frame number.
+			RECT,			///< payload: centre x/y, width, height, brush
+			LINE,			///< payload: x1, y1, x2, y2, brush
+			DISK,			///< payload: centre x/y, radius, brush
+			SECTOR,			///< payload: centre x/y, radius1, radius2, start/end angle, brush
+			TEXT,			///< payload: x, y, size, string id, brush
+			SET_FONT,		///< payload: string id
+			SET_ORIENTATION,///< payload: angle
+			SET_SCALE,		///< payload: sx, sy
+			RESET_POSE,		///< no payload
+			PLAY_SOUND		///< payload: string id, volume
+		};
+
+		/** Loads an input script. Every non-empty line that does not start with '#' is one event:
+
+			\code
+			<frame> move <x> <y>            // moves the mouse, in canvas units
+			<frame> press <left|middle|right>
+			<frame> release <left|middle|right>
+			<frame> keydown <key>           // key: a letter, a digit, a SCANCODE_ name without the prefix, or a number
+			<frame> keyup <key>
+			<frame> quit                    // stops the message loop
+			\endcode
+
+			Events are applied at the start of the frame they name, before the update callback runs.
+			\return false if the file could not be read or contains a malformed line.
+		*/
+		bool loadScript(const std::string& path);
+
+		/** Sets how many frames startMessageLoop() runs for. */
+		void setFrameLimit(unsigned int frames);
+
+		/** Sets the fixed frame time reported by getDeltaTime(), in milliseconds. */
+		void setFixedDeltaTime(float ms);
+
+		/** The raw command buffer recorded so far. */
+		const std::vector<unsigned char>& getCommandBuffer();
+
+		/** The strings (texts, fonts, textures, sounds) the command buffer refers to by id. */
+		const std::vector<std::string>& getStrings();
+
+		/** Clears the command buffer (but not the string table, so ids stay valid). */
+		void clearCommandBuffer();
+
+		/** Decodes the command buffer into text, one command per line. */
+		std::string dumpCommands();
+
+		/** The number of frames the message loop has run so far. */
+		unsigned int getFrameCount();
+	}
+}
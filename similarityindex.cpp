@@ -0,0 +1,348 @@
+#include "similarityindex.h"
+#include "filmcatalog.h"
+#include "personindex.h"
+#include "profiler.h"
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMILARITY_SSE2
+#endif
+
+namespace {
+	static_assert(SIMILARITY_DIMENSIONS % 16 == 0, "the SSE2 dot product works through 16 dimensions at a time");
+
+	using Vector = std::array<float, SIMILARITY_DIMENSIONS>;
+	using Query = std::array<std::int16_t, SIMILARITY_DIMENSIONS>;
+
+	// the kinds of features, so that, say, the genre with the same number as a decade doesn't hash to the same place
+	enum class Feature : std::uint64_t { GENRE = 1, DIRECTOR, ACTOR, DECADE, WORD };
+
+	std::uint64_t mix(std::uint64_t value)
+	{
+		// splitmix64's finaliser: every bit of the value affects every bit of the hash
+		value ^= value >> 30;
+		value *= 0xBF58476D1CE4E5B9ull;
+		value ^= value >> 27;
+		value *= 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	std::uint64_t hashText(std::string_view text)
+	{
+		std::uint64_t hash{ 0xCBF29CE484222325ull };
+		for (const char c : text) {
+			hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	// adds a feature to a vector: its hash picks the dimension, and one more bit of it whether it adds or takes away
+	void add(Vector& vector, Feature feature, std::uint64_t value, float weight)
+	{
+		std::uint64_t hash{ mix(value * 31 + static_cast<std::uint64_t>(feature)) };
+		vector[hash % SIMILARITY_DIMENSIONS] += (hash >> 63) ? -weight : weight;
+	}
+
+	// words that say nothing about what a film is like
+	bool isStopWord(std::string_view word)
+	{
+		static constexpr std::array<std::string_view, 24> c_stopWords{ "about", "after", "also", "been", "before", "from",
+			"have", "into", "just", "more", "only", "over", "same", "some", "than", "that", "their", "them", "then", "they",
+			"this", "when", "while", "with" };
+		return std::find(c_stopWords.begin(), c_stopWords.end(), word) != c_stopWords.end();
+	}
+
+	// the words of a description worth a feature: lowercase, at least 4 letters long, each once
+	void addWords(Vector& vector, std::string_view description)
+	{
+		std::vector<std::uint64_t> words;
+		std::string word;
+		for (size_t i{ 0 }; i <= description.size(); ++i) {
+			unsigned char c{ static_cast<unsigned char>(i < description.size() ? description[i] : ' ') };
+			if (std::isalpha(c)) {
+				word.push_back(static_cast<char>(std::tolower(c)));
+				continue;
+			}
+			if (word.size() >= 4 && !isStopWord(word)) {
+				words.push_back(hashText(word));
+			}
+			word.clear();
+		}
+		std::sort(words.begin(), words.end());
+		words.erase(std::unique(words.begin(), words.end()), words.end());
+		if (words.size() > SIMILARITY_MAX_WORDS) {
+			words.resize(SIMILARITY_MAX_WORDS);
+		}
+		for (const std::uint64_t hash : words) {
+			add(vector, Feature::WORD, hash, 0.35f);
+		}
+	}
+
+	int dotScalar(const std::int8_t* vector, const std::int16_t* query)
+	{
+		int sum{ 0 };
+		for (unsigned int i{ 0 }; i < SIMILARITY_DIMENSIONS; ++i) {
+			sum += vector[i] * query[i];
+		}
+		return sum;
+	}
+
+	int dotSimd(const std::int8_t* vector, const std::int16_t* query)
+	{
+#ifdef SIMILARITY_SSE2
+		/* 16 bytes of the vector at a time: sign extended to two halves of 8 shorts (unpacking each byte with a byte of
+		 * its sign), each multiplied with the matching shorts of the query and summed in pairs into 4 ints (madd) */
+		const __m128i zero{ _mm_setzero_si128() };
+		__m128i sum{ zero };
+		for (unsigned int i{ 0 }; i < SIMILARITY_DIMENSIONS; i += 16) {
+			const __m128i bytes{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector + i)) };
+			const __m128i sign{ _mm_cmpgt_epi8(zero, bytes) };
+			const __m128i low{ _mm_unpacklo_epi8(bytes, sign) };
+			const __m128i high{ _mm_unpackhi_epi8(bytes, sign) };
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(low, _mm_loadu_si128(reinterpret_cast<const __m128i*>(query + i))));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(high, _mm_loadu_si128(reinterpret_cast<const __m128i*>(query + i + 8))));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(sum);
+#else
+		return dotScalar(vector, query);
+#endif
+	}
+
+	// works out the vector of one film of a catalog into stored
+	void vectorise(const CatalogView& catalog, size_t id, std::string_view description, std::int8_t* stored)
+	{
+		Vector vector{};
+		for (unsigned int genre{ 0 }; genre < 16; ++genre) {
+			if (catalog.genres[id] & (1u << genre)) {
+				add(vector, Feature::GENRE, genre, 1.0f);
+			}
+		}
+		if (!catalog.directors[id].empty()) {
+			add(vector, Feature::DIRECTOR, hashText(catalog.directors[id]), 1.5f);
+		}
+
+		// by name rather than PersonId, so that a film's vector is the same however the people were numbered
+		const unsigned int castEnd{ std::min(catalog.castOffsets[id] + SIMILARITY_TOP_BILLED, catalog.castOffsets[id + 1]) };
+		for (unsigned int credit{ catalog.castOffsets[id] }; credit < castEnd; ++credit) {
+			add(vector, Feature::ACTOR, hashText(catalog.people[catalog.credits[credit].person]), 0.4f * roleWeight(catalog.credits[credit].role));
+		}
+		const std::uint64_t decade{ catalog.years[id] / 10 };
+		add(vector, Feature::DECADE, decade, 1.0f);
+		add(vector, Feature::DECADE, decade - 1, 0.5f);
+		add(vector, Feature::DECADE, decade + 1, 0.5f);
+		addWords(vector, description);
+
+		// normalised, so that the dot product is the cosine of the angle between two films, and scaled to fit in a byte
+		float length{ 0.0f };
+		for (const float value : vector) {
+			length += value * value;
+		}
+		const float scale{ length > 0.0f ? 127.0f / std::sqrt(length) : 0.0f };
+		for (unsigned int i{ 0 }; i < SIMILARITY_DIMENSIONS; ++i) {
+			stored[i] = static_cast<std::int8_t>(std::clamp(std::lround(vector[i] * scale), -127l, 127l));
+		}
+	}
+
+	// a scored film, the better of two being the one with the higher score, or in a tie, the one first in title order
+	struct Scored {
+		int score;
+		FilmId id;
+	};
+	bool better(const Scored& a, const Scored& b)
+	{
+		return a.score != b.score ? a.score > b.score : a.id < b.id;
+	}
+}
+
+void SimilarityIndex::build(const CatalogView& catalog, std::span<const std::string_view> descriptions)
+{
+	PROFILE_SCOPE("SimilarityIndex::build");
+	const size_t count{ catalog.size() };
+	m_vectors.assign(count * SIMILARITY_DIMENSIONS, 0);
+	TaskScheduler::getInstance()->parallelFor(0, count, CATALOG_BUILD_GRAIN, [&](size_t first, size_t last) {
+		for (size_t id{ first }; id < last; ++id) {
+			vectorise(catalog, id, id < descriptions.size() ? descriptions[id] : std::string_view{}, &m_vectors[id * SIMILARITY_DIMENSIONS]);
+		}
+	});
+	precomputeNeighbours();
+}
+
+void SimilarityIndex::update(const SimilarityIndex& previous, const FilmRemap& remap, const CatalogView& catalog,
+	std::span<const std::string_view> descriptions)
+{
+	PROFILE_SCOPE("SimilarityIndex::update");
+	const size_t count{ remap.size() };
+	std::vector<size_t> addedIndex(count, 0);
+	for (size_t index{ 0 }; index < remap.added.size(); ++index) {
+		addedIndex[remap.added[index]] = index;
+	}
+
+	// the films that stay keep their vectors; only the added ones are worked out
+	m_vectors.assign(count * SIMILARITY_DIMENSIONS, 0);
+	TaskScheduler::getInstance()->parallelFor(0, count, CATALOG_BUILD_GRAIN, [&](size_t first, size_t last) {
+		for (size_t id{ first }; id < last; ++id) {
+			std::int8_t* stored{ &m_vectors[id * SIMILARITY_DIMENSIONS] };
+			if (remap.isAdded(static_cast<FilmId>(id))) {
+				vectorise(catalog, id, addedIndex[id] < descriptions.size() ? descriptions[addedIndex[id]] : std::string_view{}, stored);
+			}
+			else {
+				const auto from{ previous.m_vectors.begin() + static_cast<size_t>(remap.newToOld[id]) * SIMILARITY_DIMENSIONS };
+				std::copy(from, from + SIMILARITY_DIMENSIONS, stored);
+			}
+		}
+	});
+
+	if (!previous.hasNeighbours()) {
+		precomputeNeighbours();
+		return;
+	}
+	m_neighbours.clear();
+	m_neighbourCounts.clear();
+	if (count > SIMILARITY_PRECOMPUTE_FILMS) {
+		return;
+	}
+
+	/* A film that stays, whose closest films all stay too, can only have had them pushed out by one of the added films:
+	 * the films it was closer to than to any other old film still are. So only its old closest films and the added ones
+	 * need scoring against it. The added films, and the films that lost one of their closest, are scored against all. */
+	std::vector<FilmId> neighbours(count * SIMILAR_FILMS, 0);
+	std::vector<unsigned char> neighbourCounts(count, 0);
+	TaskScheduler::getInstance()->parallelFor(0, count, 64, [&](size_t first, size_t last) {
+		std::vector<FilmId> similar;
+		std::vector<Scored> candidates;
+		alignas(16) Query query;
+		for (size_t id{ first }; id < last; ++id) {
+			bool rescore{ remap.isAdded(static_cast<FilmId>(id)) };
+			const FilmId old{ remap.newToOld[id] };
+			const size_t oldFirst{ static_cast<size_t>(old) * SIMILAR_FILMS };
+			for (size_t neighbour{ 0 }; !rescore && neighbour < previous.m_neighbourCounts[old]; ++neighbour) {
+				rescore = remap.oldToNew[previous.m_neighbours[oldFirst + neighbour]] == c_noFilm;
+			}
+
+			if (rescore) {
+				score(static_cast<FilmId>(id), SIMILAR_FILMS, similar);
+			}
+			else {
+				const std::int8_t* vector{ &m_vectors[id * SIMILARITY_DIMENSIONS] };
+				for (unsigned int i{ 0 }; i < SIMILARITY_DIMENSIONS; ++i) {
+					query[i] = vector[i];
+				}
+				candidates.clear();
+				auto candidate{ [&](FilmId other) {
+					candidates.push_back({ dotSimd(&m_vectors[static_cast<size_t>(other) * SIMILARITY_DIMENSIONS], query.data()), other });
+				} };
+				for (size_t neighbour{ 0 }; neighbour < previous.m_neighbourCounts[old]; ++neighbour) {
+					candidate(remap.oldToNew[previous.m_neighbours[oldFirst + neighbour]]);
+				}
+				for (const FilmId added : remap.added) {
+					candidate(added);
+				}
+				const size_t kept{ std::min<size_t>(SIMILAR_FILMS, candidates.size()) };
+				std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(), better);
+				similar.clear();
+				for (size_t i{ 0 }; i < kept; ++i) {
+					similar.push_back(candidates[i].id);
+				}
+			}
+			std::copy(similar.begin(), similar.end(), neighbours.begin() + id * SIMILAR_FILMS);
+			neighbourCounts[id] = static_cast<unsigned char>(similar.size());
+		}
+	});
+	m_neighbours = std::move(neighbours);
+	m_neighbourCounts = std::move(neighbourCounts);
+}
+
+void SimilarityIndex::precomputeNeighbours()
+{
+	// small enough catalogs get every film's closest ones worked out now, which is one exact scoring per film
+	m_neighbours.clear();
+	m_neighbourCounts.clear();
+	const size_t count{ size() };
+	if (count > SIMILARITY_PRECOMPUTE_FILMS) {
+		return;
+	}
+	std::vector<FilmId> neighbours(count * SIMILAR_FILMS, 0);
+	std::vector<unsigned char> neighbourCounts(count, 0);
+	TaskScheduler::getInstance()->parallelFor(0, count, 64, [&](size_t first, size_t last) {
+		std::vector<FilmId> similar;
+		for (size_t id{ first }; id < last; ++id) {
+			score(static_cast<FilmId>(id), SIMILAR_FILMS, similar);
+			std::copy(similar.begin(), similar.end(), neighbours.begin() + id * SIMILAR_FILMS);
+			neighbourCounts[id] = static_cast<unsigned char>(similar.size());
+		}
+	});
+	m_neighbours = std::move(neighbours);
+	m_neighbourCounts = std::move(neighbourCounts);
+}
+
+template <typename Dot>
+void SimilarityIndex::scoreWith(Dot dot, FilmId film, size_t count, std::vector<FilmId>& similar) const
+{
+	similar.clear();
+	const size_t films{ size() };
+	if (film >= films || !count) {
+		return;
+	}
+
+	// the film's vector widened to shorts once, for the madd
+	alignas(16) Query query;
+	const std::int8_t* vector{ &m_vectors[static_cast<size_t>(film) * SIMILARITY_DIMENSIONS] };
+	for (unsigned int i{ 0 }; i < SIMILARITY_DIMENSIONS; ++i) {
+		query[i] = vector[i];
+	}
+
+	// a heap of the best count so far, with the worst of them on top, which is all a new film has to beat to get in
+	std::vector<Scored> best;
+	best.reserve(count + 1);
+	const std::int8_t* other{ m_vectors.data() };
+	for (size_t id{ 0 }; id < films; ++id, other += SIMILARITY_DIMENSIONS) {
+		if (id == film) {
+			continue;
+		}
+		const Scored scored{ dot(other, query.data()), static_cast<FilmId>(id) };
+		if (best.size() < count) {
+			best.push_back(scored);
+			std::push_heap(best.begin(), best.end(), better);
+		}
+		else if (better(scored, best.front())) {
+			std::pop_heap(best.begin(), best.end(), better);
+			best.back() = scored;
+			std::push_heap(best.begin(), best.end(), better);
+		}
+	}
+	std::sort_heap(best.begin(), best.end(), better);
+	for (const Scored& scored : best) {
+		similar.push_back(scored.id);
+	}
+}
+
+void SimilarityIndex::similarTo(FilmId film, size_t count, std::vector<FilmId>& similar) const
+{
+	PROFILE_SCOPE("SimilarityIndex::similarTo");
+	if (hasNeighbours() && count <= SIMILAR_FILMS && film < m_neighbourCounts.size()) {
+		const auto first{ m_neighbours.begin() + static_cast<size_t>(film) * SIMILAR_FILMS };
+		similar.assign(first, first + std::min<size_t>(count, m_neighbourCounts[film]));
+		return;
+	}
+	score(film, count, similar);
+}
+
+void SimilarityIndex::score(FilmId film, size_t count, std::vector<FilmId>& similar) const
+{
+	scoreWith([](const std::int8_t* vector, const std::int16_t* query) { return dotSimd(vector, query); }, film, count, similar);
+}
+
+void SimilarityIndex::scoreScalar(FilmId film, size_t count, std::vector<FilmId>& similar) const
+{
+	scoreWith([](const std::int8_t* vector, const std::int16_t* query) { return dotScalar(vector, query); }, film, count, similar);
+}
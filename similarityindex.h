@@ -0,0 +1,59 @@
+#pragma once
+#include "filmbitmap.h"
+#include "global.h"
+#include "filmremap.h"
+
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+/* SimilarityIndex: For the "More like this" strip, every film boiled down to a feature vector, so that how alike two
+ * films are is the dot product of their vectors.
+ *
+ * A film's features are its genres, its director, its top billed cast (the leads counting the most), its decade (and,
+ * by half, the decades either side), and the words of its description. They are hashed into SIMILARITY_DIMENSIONS
+ * dimensions, each with a sign of its own so that collisions cancel out rather than add up, normalised, and stored as
+ * signed bytes, all the films' one after the other in one array: 64 bytes a film, a million films in 64MB.
+ *
+ * Finding the films most like one means scoring all the others against it, keeping the best in a heap of as many as
+ * are wanted. The dot products are done 16 bytes at a time with SSE2 (which every x64 CPU has), with a plain loop to
+ * fall back on anywhere else. For catalogs of up to SIMILARITY_PRECOMPUTE_FILMS films, the SIMILAR_FILMS closest of
+ * every film are worked out on the scheduler's workers when the index is built, so asking for them costs nothing.
+ * When the catalog is updated, the films that stay keep their vectors, and only the closest films that the films that
+ * came or went can have changed are worked out again. */
+
+struct CatalogView;
+
+class SimilarityIndex {
+private:
+	std::vector<std::int8_t> m_vectors;				// SIMILARITY_DIMENSIONS per film, by FilmId
+	std::vector<FilmId> m_neighbours;				// SIMILAR_FILMS per film, if precomputed (otherwise empty)
+	std::vector<unsigned char> m_neighbourCounts;	// how many of each film's SIMILAR_FILMS slots are used
+
+	// scores every film against one with the given dot product, keeping the count best
+	template <typename Dot>
+	void scoreWith(Dot dot, FilmId film, size_t count, std::vector<FilmId>& similar) const;
+
+	// works out the SIMILAR_FILMS closest of every film, if there are few enough films for that (and forgets them otherwise)
+	void precomputeNeighbours();
+
+public:
+	// (Re)builds the vectors from the columns of a catalog and the descriptions of its films (by FilmId)
+	void build(const CatalogView& catalog, std::span<const std::string_view> descriptions);
+
+	// Builds the index of an updated catalog from the one of the catalog it was updated from, given the descriptions of
+	// the added films (in the order of remap.added)
+	void update(const SimilarityIndex& previous, const FilmRemap& remap, const CatalogView& catalog,
+		std::span<const std::string_view> descriptions);
+
+	// The count films most like the given one (it not included), the most alike first; precomputed, if they were
+	void similarTo(FilmId film, size_t count, std::vector<FilmId>& similar) const;
+
+	// Scores every film against the given one right now, with the SIMD dot product or the plain one (for the benchmark)
+	void score(FilmId film, size_t count, std::vector<FilmId>& similar) const;
+	void scoreScalar(FilmId film, size_t count, std::vector<FilmId>& similar) const;
+
+	bool hasNeighbours() const						{ return !m_neighbours.empty(); }
+	size_t size() const								{ return m_vectors.size() / SIMILARITY_DIMENSIONS; }
+};
@@ -1,8 +1,9 @@
 #pragma once
 #include "widget.h"
 #include "film.h"
+#include "filmcatalog.h"
+#include "filterplan.h"
 
-#include <unordered_set>
 
 /*
  * A slider will be one of 2 types - a lower bound slider (disregards all the values lower than it's currently at), and an upper bound slider
@@ -40,18 +41,16 @@ public:
 	Slider(const float pos_x, const float pos_y, const float width, const float height, const unsigned int minValue,
 		const unsigned int maxValue, const SliderUseage useage);
 
-	void draw() override;
-	void update() override;
+	void draw();
+	// dragging the slider moves it along its line, as long as the drag started on it
+	void onEvent(const InputEvent& event);
 
 	// fetches the value (year in our case) the current location of the slider represents
 	unsigned int getCurrentValue() const;
 
-	// both sliders active in the search screen will be filtering the results no matter what, therefore making canFilter return true always
-	bool canFilter() const override;
-
-	// The lower bound slider will discard the films with a release date prior to its current value, and likewise for the upper bound slider.
-	virtual void filter(std::unordered_set<class Film*>& currFilms) const override;
+	// adds this slider's bound to the year range of a search
+	void addToPlan(FilterPlan& plan) const;
 
 	// a slider is rectangular, therefore its contains will utilise our "rectangularContains" helper function.
-	bool contains(const float x, const float y) const override;
+	bool contains(const float x, const float y) const;
 };
\ No newline at end of file
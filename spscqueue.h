@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/* SpscQueue: A fixed-size, lock-free queue between exactly one producer thread and exactly one consumer thread. Neither
+ * side ever waits on the other: push() fails when the queue is full and pop() when it is empty, and it is up to the
+ * caller what to do then. Items are moved in and out, so a queue of objects that own memory hands that memory over
+ * without copying it.
+ *
+ * The producer only ever writes m_tail and the consumer only ever writes m_head; each publishes its progress with a
+ * release store that the other side reads with an acquire load, which is what makes the item itself visible. The two
+ * indices live on separate cache lines, so the threads don't keep stealing the line from each other. One slot is always
+ * left empty, to tell a full queue from an empty one, so the queue holds at most Capacity - 1 items. */
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+private:
+	static_assert(Capacity >= 2, "an SpscQueue needs room for at least one item");
+
+	std::array<T, Capacity> m_items;
+	alignas(64) std::atomic<size_t> m_head{ 0 };		// the next item to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_tail{ 0 };		// the next slot to push into, written by the producer
+
+public:
+	// Producer only. Returns false (leaving the item alone) if the queue is full.
+	bool push(T&& item) {
+		const size_t tail{ m_tail.load(std::memory_order_relaxed) };
+		const size_t next{ (tail + 1) % Capacity };
+		if (next == m_head.load(std::memory_order_acquire)) {
+			return false;
+		}
+		m_items[tail] = std::move(item);
+		m_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Returns false if the queue is empty.
+	bool pop(T& item) {
+		const size_t head{ m_head.load(std::memory_order_relaxed) };
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = std::move(m_items[head]);
+		m_head.store((head + 1) % Capacity, std::memory_order_release);
+		return true;
+	}
+};
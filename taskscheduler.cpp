@@ -0,0 +1,196 @@
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+	// the index of the worker the current thread is, or -1 for any thread outside the pool
+	thread_local int t_workerIndex{ -1 };
+}
+
+TaskScheduler* TaskScheduler::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new TaskScheduler();
+	}
+	return s_instance;
+}
+
+void TaskScheduler::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+TaskScheduler::TaskScheduler()
+{
+	// leaving a core for the UI thread
+	unsigned int workerCount{ std::thread::hardware_concurrency() };
+	workerCount = std::clamp(workerCount > 1 ? workerCount - 1 : 1u, 1u, SCHEDULER_MAX_WORKERS);
+
+	for (unsigned int i{ 0 }; i < workerCount; ++i) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	for (unsigned int i{ 0 }; i < workerCount; ++i) {
+		m_threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stopping = true;
+	}
+	m_wakeUp.notify_all();
+	for (auto& thread : m_threads) {
+		thread.join();
+	}
+}
+
+void TaskScheduler::submit(Task task, TaskPriority priority)
+{
+	if (priority == TaskPriority::URGENT) {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_urgent.push_back(std::move(task));
+		++m_urgentQueued;
+		++m_queued;
+	}
+	else {
+		unsigned int index{ t_workerIndex >= 0 ? static_cast<unsigned int>(t_workerIndex) : m_nextWorker++ % getWorkerCount() };
+		Worker& worker{ *m_workers[index] };
+
+		/* counted under m_mutex, so a worker that has just found nothing to do can't miss it and go to sleep, and before
+		 * the task is in the deque, so a thief taking it right away can't count it out before it has been counted in */
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			++m_queued;
+		}
+		std::lock_guard<std::mutex> lock{ worker.mutex };
+		worker.tasks.push_back(std::move(task));
+	}
+	m_wakeUp.notify_one();
+}
+
+bool TaskScheduler::findTask(unsigned int index, Task& task)
+{
+	if (m_urgentQueued.load() > 0) {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		if (!m_urgent.empty()) {
+			task = std::move(m_urgent.front());
+			m_urgent.pop_front();
+			--m_urgentQueued;
+			--m_queued;
+			return true;
+		}
+	}
+
+	// our own deque, newest first
+	{
+		Worker& worker{ *m_workers[index] };
+		std::lock_guard<std::mutex> lock{ worker.mutex };
+		if (!worker.tasks.empty()) {
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			--m_queued;
+			return true;
+		}
+	}
+
+	// stealing the oldest task of someone else, starting with our neighbour so the thieves don't all pick on the same worker
+	for (unsigned int offset{ 1 }; offset < getWorkerCount(); ++offset) {
+		Worker& victim{ *m_workers[(index + offset) % getWorkerCount()] };
+		std::lock_guard<std::mutex> lock{ victim.mutex };
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			--m_queued;
+			++m_workers[index]->steals;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::workerLoop(unsigned int index)
+{
+	t_workerIndex = static_cast<int>(index);
+	Worker& worker{ *m_workers[index] };
+
+	while (true) {
+		Task task;
+		if (findTask(index, task)) {
+			task();
+			++worker.executed;
+			continue;
+		}
+
+		auto idleStart{ std::chrono::steady_clock::now() };
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_wakeUp.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+			if (m_stopping) {
+				return;
+			}
+		}
+		auto idle{ std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - idleStart) };
+		worker.idleMicroseconds += static_cast<unsigned long long>(idle.count());
+	}
+}
+
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body,
+	TaskPriority priority)
+{
+	if (begin >= end) {
+		return;
+	}
+	grain = std::max<size_t>(grain, 1);
+	const size_t ranges{ (end - begin + grain - 1) / grain };
+
+	// ParallelFor: shared with the helper tasks, which may only get to run after we've returned, so it can't live on our stack
+	struct ParallelFor {
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	auto state{ std::make_shared<ParallelFor>() };
+
+	// everyone, us included, keeps claiming the next range until there are none left
+	auto work{ [state, begin, end, grain, ranges, &body]() {
+		for (size_t range{ state->next++ }; range < ranges; range = state->next++) {
+			size_t first{ begin + range * grain };
+			body(first, std::min(first + grain, end));
+			if (++state->done == ranges) {
+				std::lock_guard<std::mutex> lock{ state->mutex };
+				state->finished.notify_all();
+			}
+		}
+	} };
+
+	// body is only referenced by helpers that claim a range, and every range is done before we return, so that is safe
+	const size_t helpers{ std::min<size_t>(ranges - 1, getWorkerCount()) };
+	for (size_t i{ 0 }; i < helpers; ++i) {
+		submit(work, priority);
+	}
+	work();
+
+	std::unique_lock<std::mutex> lock{ state->mutex };
+	state->finished.wait(lock, [&state, ranges] { return state->done.load() == ranges; });
+}
+
+SchedulerStats TaskScheduler::getStats() const
+{
+	SchedulerStats stats;
+	stats.workers = getWorkerCount();
+	for (const auto& worker : m_workers) {
+		stats.tasks += worker->executed.load();
+		stats.steals += worker->steals.load();
+		stats.idleMicroseconds += worker->idleMicroseconds.load();
+	}
+	stats.urgentQueued = m_urgentQueued.load();
+	stats.queued = m_queued.load() - std::min(stats.urgentQueued, m_queued.load());
+	return stats;
+}
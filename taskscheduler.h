@@ -0,0 +1,94 @@
+#pragma once
+#include "global.h"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/* TaskScheduler: The one pool of worker threads everything in the background shares (poster loading, thumbnail baking,
+ * building the catalog, large filter passes), instead of every subsystem spawning threads of its own.
+ *
+ * Every worker has a deque of its own. A task submitted from a worker goes on that worker's deque, which it works
+ * through newest first (the data the task needs is most likely still in its cache); tasks submitted from any other
+ * thread are dealt out to the workers in turn. A worker that runs out of tasks steals the oldest task of another
+ * worker, so a burst of tasks on one deque spreads out over the whole pool.
+ *
+ * Next to the deques there is a priority lane, for work someone is waiting on right now (a search the user just typed).
+ * Workers always look at the lane before their own deque, so an urgent task starts as soon as any worker finishes the
+ * task it is on. Bulk work doesn't get interrupted halfway; it is meant to come in small enough tasks (see parallelFor's
+ * grain) that there is never long to wait for a worker to free up.
+ *
+ * The scheduler keeps statistics (tasks run, steals, queued tasks, time spent idle), which the profiler overlay shows. */
+
+enum class TaskPriority { URGENT, BULK };
+
+// SchedulerStats: Totals since the scheduler started, apart from the queue depths, which are as of now
+struct SchedulerStats {
+	unsigned int workers{ 0 };
+	unsigned long long tasks{ 0 };
+	unsigned long long steals{ 0 };
+	unsigned long long idleMicroseconds{ 0 };		// summed over all workers
+	size_t queued{ 0 };								// waiting in the workers' deques
+	size_t urgentQueued{ 0 };						// waiting in the priority lane
+};
+
+class TaskScheduler {
+public:
+	using Task = std::function<void()>;
+
+private:
+	struct Worker {
+		std::mutex mutex;							// guards tasks; the owner takes from the back, thieves from the front
+		std::deque<Task> tasks;
+		std::atomic<unsigned long long> executed{ 0 };
+		std::atomic<unsigned long long> steals{ 0 };
+		std::atomic<unsigned long long> idleMicroseconds{ 0 };
+	};
+
+	static inline TaskScheduler* s_instance{ nullptr };
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+
+	// m_mutex: Guards the priority lane, and is what idle workers sleep on
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	std::deque<Task> m_urgent;
+	bool m_stopping{ false };
+
+	std::atomic<size_t> m_queued{ 0 };				// tasks waiting anywhere, urgent ones included
+	std::atomic<size_t> m_urgentQueued{ 0 };
+	std::atomic<unsigned int> m_nextWorker{ 0 };	// where the next task from outside the pool goes
+
+	// the loop every worker thread runs until the scheduler is released
+	void workerLoop(unsigned int index);
+
+	// finds the next task for a worker: the priority lane first, then its own deque, then the others'
+	bool findTask(unsigned int index, Task& task);
+
+	TaskScheduler();
+
+public:
+	static TaskScheduler* getInstance();
+	static void releaseInstance();
+
+	~TaskScheduler();
+
+	// Queues a task to run on one of the workers
+	void submit(Task task, TaskPriority priority = TaskPriority::BULK);
+
+	/* Calls body(first, last) over [begin, end), split into ranges of grain ids, on as many workers as are free, and
+	 * returns once all of them are done. The calling thread works through ranges too, so parallelFor can be called from
+	 * anywhere, a worker included, and always makes progress even if every worker is busy. */
+	void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body,
+		TaskPriority priority = TaskPriority::BULK);
+
+	unsigned int getWorkerCount() const					{ return static_cast<unsigned int>(m_workers.size()); }
+
+	SchedulerStats getStats() const;
+};
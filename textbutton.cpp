@@ -1,4 +1,5 @@
 #include "textbutton.h"
+#include "profiler.h"
 #include <string>
 
 
@@ -17,6 +18,7 @@ TextButton::~TextButton()
 
 void TextButton::draw()
 {
+	PROFILE_SCOPE("TextButton::draw");
 	m_brush.fill_opacity = 1.0f;
 
 	// For Apply/Clear Filters, we want a dark grey background with white letters. For Advanced Search, we will not be using a
@@ -25,7 +27,7 @@ void TextButton::draw()
 		m_brush.outline_opacity = 0.5f * m_highlighted;
 		SETCOLOUR(m_brush.outline_color, 0.6f, 0.6f, 0.6f);
 		SETCOLOUR(m_brush.fill_color, 0.25f, 0.25f, 0.25f);
-		graphics::drawRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
+		queueRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
 	}
 
 	// Now, drawing the text:
@@ -40,16 +42,16 @@ void TextButton::draw()
 
 	// slight adjustment to the printing so the text is centered as should be for Clear Filters:
 	if (m_useage == TextButtonUseage::CLEAR_FILTERS) {
-		graphics::drawText(m_pos_x - m_width / 2.35f, m_pos_y + m_height / 4.0f, m_height * 0.66f, m_text, m_brush);
+		queueText(m_pos_x - m_width / 2.35f, m_pos_y + m_height / 4.0f, m_height * 0.66f, m_text, m_brush);
 	}
 	else {
-		graphics::drawText(m_pos_x - m_width / 2.1f, m_pos_y + m_height / 4.0f, m_height * 0.66f, m_text, m_brush);
+		queueText(m_pos_x - m_width / 2.1f, m_pos_y + m_height / 4.0f, m_height * 0.66f, m_text, m_brush);
 	}
 
 	// underlining the text in case the background is transparent
 	if (m_useage == TextButtonUseage::ADVANCED_SEARCH || m_useage == TextButtonUseage::OTHER) {
 		m_brush.outline_opacity = 1.0f;
 		SETCOLOUR(m_brush.outline_color, 0.0f, 0.0f, 0.0f);
-		graphics::drawLine(m_pos_x - m_width / 2.1f, m_pos_y + m_height / 3.0f, m_pos_x + m_width / 2.0f, m_pos_y + m_height / 3.0f, m_brush);
+		queueLine(m_pos_x - m_width / 2.1f, m_pos_y + m_height / 3.0f, m_pos_x + m_width / 2.0f, m_pos_y + m_height / 3.0f, m_brush);
 	}
 }
\ No newline at end of file
@@ -10,8 +10,7 @@
 
 enum class TextButtonUseage { ADVANCED_SEARCH, APPLY_FILTERS, CLEAR_FILTERS, OTHER };
 
-// making TextButton virtual public, because we might construct a class that derives from both TextButton and TextureButton
-class TextButton : virtual public Button {
+class TextButton : public Button {
 private:
 	// m_useage: the variable used to store a TextButton's function. Private, as our subclasses have no purpose knowing this
 	const TextButtonUseage m_useage;
@@ -21,7 +20,7 @@ protected:
 
 public:
 	TextButton(const float pos_x, const float pos_y, const float width, const float height, const std::string& text, const TextButtonUseage useage);
-	virtual ~TextButton();
+	~TextButton();
 
-	virtual void draw() override;
+	void draw();
 };
\ No newline at end of file
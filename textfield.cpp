@@ -1,23 +1,30 @@
 #include "textfield.h"
+#include "profiler.h"
 #include "widget.h"
+#include "clipboard.h"
+#include "queryparser.h"
 
 #include <string>
+#include <string_view>
 #include <algorithm>	// for std::transform
+#include <cctype>		// for ::tolower
 
 
-/* offsetString: Implementing a custom condition based on the size of the text we're printing:
-*  If the size of the string is smaller than width / 12.0f, draw the whole string. Otherwise,
-*  draw the last (width / 12.0f) characters of the string. To prevent text escaping our bounds. */
-const std::string TextField::offsetString() const
+size_t TextField::visibleCharacters() const
 {
-	// size is size_t == unsigned long int, therefore casting the result of width to unsigned long int
-	if (m_string.size() < static_cast<unsigned long int>(m_width / 12.0f)) {
-		return m_string;
-	}
-	else {
-		size_t currentStartPoint{ m_string.size() - static_cast<unsigned long int>(m_width / 12.0f) };
-		return m_string.substr(currentStartPoint);
-	}
+	float buttonLeft{ m_button.getPosX() - m_button.getWidth() / 2.0f };
+	return static_cast<size_t>(std::max(buttonLeft - textLeft(), 0.0f) / TEXTFIELD_CHARACTER_WIDTH);
+}
+
+float TextField::textLeft() const
+{
+	return m_pos_x - m_width / 2.175f;
+}
+
+size_t TextField::characterAt(float x) const
+{
+	float offset{ std::max(x - textLeft(), 0.0f) / TEXTFIELD_CHARACTER_WIDTH + 0.5f };
+	return std::min(m_scroll + static_cast<size_t>(offset), m_string.size());
 }
 
 TextField::TextField(const float pos_x, const float pos_y, const float width, const float height, const TextfieldUseage useage) :
@@ -33,6 +40,7 @@ TextField::TextField(const float pos_x, const float pos_y, const float width, co
 
 void TextField::draw()
 {
+	PROFILE_SCOPE("TextField::draw");
 	float highlighted{ 0.2f + m_highlighted * 0.2f };
 	float clicked{ 0.6f * m_clicked };
 
@@ -46,126 +54,290 @@ void TextField::draw()
 
 	m_brush.outline_opacity = 1.0f;
 	SETCOLOUR(m_brush.fill_color, 0.35f, 0.35f, 0.35f);
-	graphics::drawRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
+	queueRect(m_pos_x, m_pos_y, m_width, m_height, m_brush);
 
 	// printing the "purpose" of the respective TextField next to it:
 	SETCOLOUR(m_brush.fill_color, 1.0f, 1.0f, 1.0f);
 	if (m_useage == TextfieldUseage::ACTOR) {
-		graphics::drawText(m_pos_x - m_width * 0.825f, m_pos_y + m_height / 4.0f, m_height / 2.0f, "Actor", m_brush);
+		queueText(m_pos_x - m_width * 0.825f, m_pos_y + m_height / 4.0f, m_height / 2.0f, "Actor", m_brush);
 	}
 	else if (m_useage == TextfieldUseage::DIRECTOR) {
-		graphics::drawText(m_pos_x - m_width * 0.825f, m_pos_y + m_height / 4.0f, m_height / 2.0f, "Director", m_brush);
+		queueText(m_pos_x - m_width * 0.825f, m_pos_y + m_height / 4.0f, m_height / 2.0f, "Director", m_brush);
 	}
 	else if (m_useage == TextfieldUseage::TITLE) {
-		graphics::drawText(m_pos_x - m_width * 0.825f, m_pos_y + m_height /4.0f , m_height / 2.0f, "Title", m_brush);
+		queueText(m_pos_x - m_width * 0.825f, m_pos_y + m_height /4.0f , m_height / 2.0f, "Title", m_brush);
 	}
 
 	// drawing the button
 	m_button.draw();
 
-	SETCOLOUR(m_brush.fill_color, 0.75f, 0.75f, 0.75f);
+	// the selection, behind the text, clipped to the part of the text we draw
+	size_t visibleEnd{ std::min(m_scroll + visibleCharacters(), m_string.size()) };
 	m_brush.outline_opacity = 0.0f;
-	graphics::drawText(m_pos_x - m_width / 2.175f, m_pos_y + m_height / 4, 14.5f, offsetString(), m_brush);
+	if (hasSelection()) {
+		size_t from{ std::max(selectionStart(), m_scroll) };
+		size_t to{ std::min(selectionEnd(), visibleEnd) };
+		if (from < to) {
+			SETCOLOUR(m_brush.fill_color, 0.25f, 0.4f, 0.65f);
+			float left{ textLeft() + (from - m_scroll) * TEXTFIELD_CHARACTER_WIDTH };
+			float width{ (to - from) * TEXTFIELD_CHARACTER_WIDTH };
+			queueRect(left + width / 2.0f, m_pos_y, width, m_height * 0.6f, m_brush);
+		}
+	}
+
+	// the caret. Not blinking, since a blinking caret would have us redraw the whole screen twice a second while idle.
+	if (m_clicked) {
+		SETCOLOUR(m_brush.outline_color, 0.9f, 0.9f, 0.9f);
+		m_brush.outline_opacity = 1.0f;
+		float x{ textLeft() + (m_cursor - m_scroll) * TEXTFIELD_CHARACTER_WIDTH };
+		queueLine(x, m_pos_y - m_height * 0.3f, x, m_pos_y + m_height * 0.3f, m_brush);
+		m_brush.outline_opacity = 0.0f;
+	}
+
+	SETCOLOUR(m_brush.fill_color, 0.75f, 0.75f, 0.75f);
+	queueText(textLeft(), m_pos_y + m_height / 4, 14.5f, std::string_view{ m_string }.substr(m_scroll, visibleEnd - m_scroll), m_brush);
 }
 
 void TextField::update()
 {
-	graphics::MouseState mouse;
-	graphics::getMouseState(mouse);
-	float mouse_x{ graphics::windowToCanvasX(static_cast<float>(mouse.cur_pos_x)) };
-	float mouse_y{ graphics::windowToCanvasY(static_cast<float>(mouse.cur_pos_y)) };
+	PROFILE_SCOPE("TextField::update");
+
+	// the x button isn't a widget of its own as far as FilmUI is concerned, so highlighting it ourselves
+	const InputSnapshot& input{ InputManager::getInstance()->getSnapshot() };
+	m_button.setHighlighted(m_button.contains(input.mouseX, input.mouseY));
+}
+
+void TextField::onEvent(const InputEvent& event)
+{
+	PROFILE_SCOPE("TextField::onEvent");
+	switch (event.type) {
+	// clicking on the x button resets the textfield. Clicking anywhere else on it places the caret (and focuses the
+	// textfield, which FilmUI takes care of), and dragging from there selects.
+	case InputEventType::CLICK:
+		if (m_button.contains(event.x, event.y)) {
+			resetState();
+		}
+		else {
+			moveCursor(characterAt(event.x), event.shift);
+		}
+		break;
+
+	case InputEventType::DRAG:
+		moveCursor(characterAt(event.x), true);
+		break;
 
-	m_button.update();
+	// the key events only reach us while we are focused, and every key typed (or repeated) comes with its character
+	case InputEventType::TEXT:
+		insertText(std::string(1, event.character));
+		break;
 
-	// we switch the "clicked" state to true if we click inside the textfield
-	m_highlighted = contains(mouse_x, mouse_y);
-	if (m_highlighted && mouse.button_left_pressed) {
-		m_clicked = true;
+	case InputEventType::KEY_DOWN:
+	case InputEventType::KEY_REPEAT:
+		handleKey(event);
+		break;
+
+	default:
+		break;
 	}
+}
 
-	if (m_clicked) {
-		// if we have clicked on the textfield and we click anywhere outside it, make "clicked" false
-		if (!m_highlighted && mouse.button_left_pressed) {
-			m_clicked = false;
-		}
-
-		static float delay{ 0.0f };					// used to ensure enough time has passed since the last time we typed a character
-		delay += graphics::getDeltaTime();			// incrementing delay by the time that's passed since our last update function
-
-		// first, checking all the letters from a to z through a for loop.
-		for (int i { graphics::SCANCODE_A }; i <= graphics::SCANCODE_Z; ++i) {
-			// if the currently iterated key has been pressed
-			if (graphics::getKeyState(static_cast<graphics::scancode_t>(i))) {
-
-				// if the previous key pressed is the same and the delay is smaller than 140.0f, ignore and continue the loop
-				if (delay < 125.0f) {
-					continue;
-				}
-				else {
-					delay = 0.0f;
-					// pushing back the ascii value of the letter
-					m_string.push_back(i + 93);
-				}
-			}
+void TextField::handleKey(const InputEvent& event)
+{
+	switch (event.key) {
+	case graphics::SCANCODE_LEFT:
+		// without shift, the left arrow first drops the selection, leaving the caret at its start
+		if (hasSelection() && !event.shift) {
+			moveCursor(selectionStart(), false);
+		}
+		else if (m_cursor > 0) {
+			moveCursor(event.ctrl ? wordLeft(m_cursor) : m_cursor - 1, event.shift);
 		}
+		break;
 
-		// then, checking all numbers from 1 to 9
-		for (int i{ graphics::SCANCODE_1 }; i <= graphics::SCANCODE_9; ++i) {
+	case graphics::SCANCODE_RIGHT:
+		if (hasSelection() && !event.shift) {
+			moveCursor(selectionEnd(), false);
+		}
+		else if (m_cursor < m_string.size()) {
+			moveCursor(event.ctrl ? wordRight(m_cursor) : m_cursor + 1, event.shift);
+		}
+		break;
 
-			// if the currently iterated key has been pressed
-			if (graphics::getKeyState(static_cast<graphics::scancode_t>(i))) {
+	case graphics::SCANCODE_HOME:
+		moveCursor(0, event.shift);
+		break;
 
-				// if the previous key pressed is the same and the delay is smaller than 140.0f, ignore and continue the loop
-				if (delay < 125.0f) {
-					continue;
-				}
-				else {
-					delay = 0.0f;
-					// pushing back the ascii value of the number
-					m_string.push_back(i + 19);
-				}
-			}
+	case graphics::SCANCODE_END:
+		moveCursor(m_string.size(), event.shift);
+		break;
+
+	case graphics::SCANCODE_BACKSPACE:
+		if (hasSelection()) {
+			replaceRange(selectionStart(), selectionEnd(), "");
 		}
+		else if (m_cursor > 0) {
+			replaceRange(event.ctrl ? wordLeft(m_cursor) : m_cursor - 1, m_cursor, "");
+		}
+		break;
 
-		// then, checking for 0
-		if (graphics::getKeyState(graphics::SCANCODE_0)) {
-			if (delay >= 125.0f) {
-				delay = 0.0f;
-				// pushing back the ascii value of the number
-				m_string.push_back(graphics::SCANCODE_0 + 9);
-			}
+	case graphics::SCANCODE_DELETE:
+		if (hasSelection()) {
+			replaceRange(selectionStart(), selectionEnd(), "");
+		}
+		else if (m_cursor < m_string.size()) {
+			replaceRange(m_cursor, event.ctrl ? wordRight(m_cursor) : m_cursor + 1, "");
 		}
+		break;
 
-		// then, checking for backspace
-		if (graphics::getKeyState(graphics::SCANCODE_BACKSPACE)) {
-			if (delay >= 125.0f) {
-				delay = 0.0f;
-				if (m_string.size() >= 1) {
-					m_string.pop_back();
-				}
+	case graphics::SCANCODE_A:
+		if (event.ctrl) {
+			m_anchor = 0;
+			m_cursor = m_string.size();
+			scrollToCursor();
+		}
+		break;
+
+	case graphics::SCANCODE_C:
+	case graphics::SCANCODE_X:
+		if (event.ctrl && hasSelection()) {
+			setClipboardText(m_string.substr(selectionStart(), selectionEnd() - selectionStart()));
+			if (event.key == graphics::SCANCODE_X) {
+				replaceRange(selectionStart(), selectionEnd(), "");
 			}
 		}
+		break;
 
-		// and likewise, checking for space
-		if (graphics::getKeyState(graphics::SCANCODE_SPACE)) {
-			if (delay >= 125.0f) {
-				delay = 0.0f;
-				m_string.push_back(' ');
-			}
+	case graphics::SCANCODE_V:
+		if (event.ctrl) {
+			insertText(getClipboardText());
 		}
+		break;
 
-		// now, checking if we clicked on the x button: if we did, reset the textfield, and reset the x button
-		if (m_button.isClicked()) {
-			resetState();
-			m_button.resetState();
+	default:
+		break;
+	}
+}
+
+size_t TextField::wordLeft(size_t position) const
+{
+	// skipping the spaces right before the caret, then the word before them
+	while (position > 0 && m_string[position - 1] == ' ') {
+		--position;
+	}
+	while (position > 0 && m_string[position - 1] != ' ') {
+		--position;
+	}
+	return position;
+}
+
+size_t TextField::wordRight(size_t position) const
+{
+	while (position < m_string.size() && m_string[position] != ' ') {
+		++position;
+	}
+	while (position < m_string.size() && m_string[position] == ' ') {
+		++position;
+	}
+	return position;
+}
+
+void TextField::moveCursor(size_t position, bool extend)
+{
+	m_cursor = position;
+	if (!extend) {
+		m_anchor = position;
+	}
+	scrollToCursor();
+}
+
+void TextField::replaceRange(size_t from, size_t to, const std::string& text)
+{
+	// never growing past TEXTFIELD_MAX_LENGTH: whatever doesn't fit is cut off the end of the inserted text
+	size_t room{ TEXTFIELD_MAX_LENGTH - (m_string.size() - (to - from)) };
+	size_t length{ std::min(text.size(), room) };
+	m_string.replace(from, to - from, text, 0, length);
+	m_query.assign(m_string);
+	std::transform(m_query.begin(), m_query.end(), m_query.begin(), ::tolower);
+	m_cursor = m_anchor = from + length;
+	scrollToCursor();
+}
+
+void TextField::insertText(const std::string& text)
+{
+	// one pass over the text, however large: line breaks and tabs become spaces, anything else unprintable is dropped
+	std::string cleaned;
+	cleaned.reserve(text.size());
+	for (const char c : text) {
+		if (c == '\n' || c == '\r' || c == '\t') {
+			cleaned.push_back(' ');
+		}
+		else if (c >= ' ' && c <= '~') {
+			cleaned.push_back(c);
 		}
 	}
+	if (cleaned.empty() && !hasSelection()) {
+		return;
+	}
+	replaceRange(selectionStart(), selectionEnd(), cleaned);
+}
+
+void TextField::scrollToCursor()
+{
+	size_t visible{ visibleCharacters() };
+	if (m_cursor < m_scroll) {
+		m_scroll = m_cursor;
+	}
+	else if (m_cursor > m_scroll + visible) {
+		m_scroll = m_cursor - visible;
+	}
+
+	// not leaving empty space at the end when the text has become shorter
+	if (m_string.size() < m_scroll + visible) {
+		m_scroll = m_string.size() > visible ? m_string.size() - visible : 0;
+	}
+}
+
+bool TextField::takeEdit(TextEdit& edit)
+{
+	if (m_string == m_reportedText) {
+		return false;
+	}
+
+	// the change is whatever lies between the longest common prefix and the longest common suffix of the two texts
+	const std::string& previous{ m_reportedText };
+	size_t prefix{ 0 };
+	size_t shorter{ std::min(previous.size(), m_string.size()) };
+	while (prefix < shorter && previous[prefix] == m_string[prefix]) {
+		++prefix;
+	}
+	size_t suffix{ 0 };
+	while (suffix < shorter - prefix && previous[previous.size() - 1 - suffix] == m_string[m_string.size() - 1 - suffix]) {
+		++suffix;
+	}
+
+	edit.position = prefix;
+	edit.removed = previous.size() - prefix - suffix;
+	edit.inserted = m_string.substr(prefix, m_string.size() - prefix - suffix);
+	if (edit.removed == 0 && prefix == previous.size()) {
+		edit.type = TextEditType::APPEND;
+	}
+	else if (edit.inserted.empty()) {
+		edit.type = TextEditType::ERASE;
+	}
+	else {
+		edit.type = TextEditType::REPLACE;
+	}
+
+	m_reportedText = m_string;
+	return true;
 }
 
 void TextField::resetState()
 {
 	Widget::resetState();
 	m_string.clear();
+	m_query.clear();
+	m_cursor = m_anchor = m_scroll = 0;
 }
 
 // a textfield is rectangular, therefore its contains will utilise our "rectangularContains" helper function.
@@ -174,79 +346,17 @@ bool TextField::contains(const float x, const float y) const
 	return rectangularContains(m_pos_x, m_pos_y, m_width, m_height, x, y);
 }
 
-// Textfields will only be allowed to filter if they are not empty.
-bool TextField::canFilter() const
+void TextField::addToPlan(FilterPlan& plan) const
 {
-	return !m_string.empty();
+	switch (m_useage) {
+	case TextfieldUseage::ACTOR:	plan.matchActor(m_query); break;
+	case TextfieldUseage::DIRECTOR:	plan.matchDirector(m_query); break;
+	case TextfieldUseage::TITLE:	plan.matchTitle(m_query); break;
+	default:						parseQuery(m_query, plan); break;
+	}
 }
 
-void TextField::filter(std::unordered_set<class Film*>& currFilms) const
+bool TextField::appendNarrows() const
 {
-	auto iter{ currFilms.begin() };
-	while (iter != currFilms.end()) {
-
-		// if this textfield filters based on an actor's name, remove all the films that don't contain this actor's name in their cast
-		if (m_useage == TextfieldUseage::ACTOR) {
-
-			/* Using the castToString() function we also use to draw a film's cast.
-			 * Then, since the cast is correctly capitalised, using std::transform to
-			 * make the entire string lowercase, so that std::find is accurate. */
-
-			std::string entireCast{ (*iter)->castToString() };
-			std::transform(entireCast.begin(), entireCast.end(), entireCast.begin(), std::tolower);
-			if (entireCast.find(m_string) == std::string::npos) {
-				currFilms.erase(iter++);
-				continue;
-			}
-		}
-		// else, if this textfield filters based on an director's name, remove all the films that don't have this person listed as the director
-		else if (m_useage == TextfieldUseage::DIRECTOR) {
-			std::string director{ (*iter)->getDirector() };
-			std::transform(director.begin(), director.end(), director.begin(), std::tolower);
-			if (director.find(m_string) == std::string::npos) {
-				currFilms.erase(iter++);
-				continue;
-			}
-		}
-		// likewise if this textfield filters based on a film's title
-		else if (m_useage == TextfieldUseage::TITLE) {
-			std::string title{ (*iter)->getTitle() };
-			std::transform(title.begin(), title.end(), title.begin(), std::tolower);
-			if (title.find(m_string) == std::string::npos) {
-				currFilms.erase(iter++);
-				continue;
-			}
-		}
-		// and likewise, if the textfield filters based on everything (the main menu textfield):
-		else {
-			// Since we will only be erasing a film from our list if it fails all 3 conditions, we will use a boolean variable.
-			bool toErase = true;
-			std::string director{ (*iter)->getDirector() };
-			std::transform(director.begin(), director.end(), director.begin(), std::tolower);
-			std::string entireCast{ (*iter)->castToString() };
-			std::transform(entireCast.begin(), entireCast.end(), entireCast.begin(), std::tolower);
-			std::string title{ (*iter)->getTitle() };
-			std::transform(title.begin(), title.end(), title.begin(), std::tolower);
-
-			// first, checking the title. If a title contains the word typed, make toErase false.
-			if (title.find(m_string) != std::string::npos) {
-				toErase = false;
-			}
-
-			// introducing toErase in our last 2 tests: if a film has already passed our first check, no need to check for the following 2
-			if (toErase && director.find(m_string) != std::string::npos) {
-				toErase = false;
-			}
-			if (toErase && entireCast.find(m_string) != std::string::npos) {
-				toErase = false;
-			}
-
-			// if the film passed none of our checks, erase the film from the set.
-			if (toErase) {
-				currFilms.erase(iter++);
-				continue;
-			}
-		}
-		++iter;
-	}
+	return m_useage != TextfieldUseage::GENERAL || isPlainQuery(m_query);
 }
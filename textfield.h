@@ -1,6 +1,8 @@
 #pragma once
 #include "widget.h"
 #include "texturebutton.h"
+#include "filmcatalog.h"
+#include "filterplan.h"
 #include <string>
 #include <algorithm>	// for std::transform
 
@@ -8,9 +10,33 @@
  * above, from the films passed to it to filter. Therefore, making a custom enum regarding a textfield's useage, with those 4 values. */
 enum class TextfieldUseage {ACTOR, DIRECTOR, GENERAL, TITLE};
 
+/* TextEdit: How the text of a textfield has changed since the last time someone asked (see TextField::takeEdit()). Searches
+ * use it to decide whether they can refine their previous results or have to start over: typing at the end of a query can
+ * only ever narrow its results down, anything else can widen them. (Not called DELETE, since windows.h defines that.) */
+enum class TextEditType { APPEND, ERASE, REPLACE };
+
+struct TextEdit {
+	TextEditType type;
+	size_t position;			// where the change starts, in the previous text
+	size_t removed;				// how many characters of the previous text were removed from there
+	std::string inserted;		// what took their place
+};
+
 class TextField : public Widget {
 private:
 	std::string m_string;				// The text every Textbutton will display.
+
+	/* The edit buffer: m_cursor is the caret, and m_anchor the other end of the selection (there is none while they are
+	 * equal), both as indices into m_string. m_scroll is the first character we draw, so the caret is always visible. */
+	size_t m_cursor{ 0 };
+	size_t m_anchor{ 0 };
+	size_t m_scroll{ 0 };
+
+	// m_reportedText: the text as of the last call to takeEdit()
+	std::string m_reportedText;
+
+	// m_query: m_string in lowercase, kept up to date as the text changes, so that filtering doesn't have to make it
+	std::string m_query;
 	class TextureButton m_button;		// each TextField will have a small "x" button to its right, that if clicked, will reset its state.
 
 	// Textfields will have a width and height variable, since they are rectangular:
@@ -19,21 +45,63 @@ private:
 
 	const TextfieldUseage m_useage;		// m_useage: Represents the useage of a textfield.
 
-	/* offsetString: Implementing a custom condition based on the size of the text we're printing:
-	 * If the size of the string is smaller than width / 12.0f, draw the whole string. Otherwise,
-	 * draw the last (width / 12.0f) characters of the string. To prevent text escaping our bounds. */
-	const std::string offsetString() const;
+	// how many characters fit in the textfield, next to the x button
+	size_t visibleCharacters() const;
+
+	// where the text starts, and the character closest to a horizontal position. SGG can't measure text, so both assume
+	// every character is TEXTFIELD_CHARACTER_WIDTH wide.
+	float textLeft() const;
+	size_t characterAt(float x) const;
+
+	bool hasSelection() const								{ return m_cursor != m_anchor; }
+	size_t selectionStart() const							{ return std::min(m_cursor, m_anchor); }
+	size_t selectionEnd() const								{ return std::max(m_cursor, m_anchor); }
+
+	// the start of the word before/after a position, for ctrl + arrows/backspace/delete
+	size_t wordLeft(size_t position) const;
+	size_t wordRight(size_t position) const;
+
+	// moves the caret, extending the selection from where it was if extend is true, dropping it otherwise
+	void moveCursor(size_t position, bool extend);
+
+	// the one place m_string changes: replaces [from, to) with the text, and puts the caret after it
+	void replaceRange(size_t from, size_t to, const std::string& text);
+
+	// replaces the selection (if any) with the text, which is cleaned up first, so pasted text can't contain anything unprintable
+	void insertText(const std::string& text);
+
+	// keeps the caret within the visible part of the text
+	void scrollToCursor();
+
+	// the keys that don't type anything: moving the caret, deleting, and the clipboard shortcuts
+	void handleKey(const InputEvent& event);
 
 public:
 	TextField(const float pos_x, const float pos_y, const float width, const float height, const TextfieldUseage useage);
 
-	void draw() override;
-	void update() override;
-	void resetState() override;
+	void draw();
+	void update();
+	void resetState();
+
+	/* Typing, editing and the x button. Clicking the textfield focuses it and places the caret, dragging selects, and
+	 * while focused: arrows/home/end move the caret (shift selects, ctrl moves by words), backspace/delete erase,
+	 * ctrl + A/C/X/V select all, copy, cut and paste. */
+	void onEvent(const InputEvent& event);
+	void setFocused(bool focused)							{ m_clicked = focused; }
+	bool hasFocus() const									{ return m_clicked; }
 
 	// a textfield is rectangular, therefore its contains will utilise our "rectangularContains" helper function.
-	virtual bool contains(const float x, const float y) const override;
+	bool contains(const float x, const float y) const;
+
+	// getText: Returns the text currently typed in the textfield.
+	const std::string& getText() const { return m_string; }
+
+	// takeEdit: If the text has changed since the last call, describes the change (all the edits since, as one) and returns true
+	bool takeEdit(TextEdit& edit);
+
+	// adds this textfield's text to a search, as the kind of text its useage says (or, for the main menu one, as a query)
+	void addToPlan(FilterPlan& plan) const;
 
-	bool canFilter() const override;
-	virtual void filter(std::unordered_set<class Film*>& currFilms) const override;
+	// whether typing more at the end of the text can only ever narrow down the films it matches
+	bool appendNarrows() const;
 };
\ No newline at end of file
@@ -8,8 +8,7 @@
 
 enum class TextureButtonUseage {DEFAULT, TEXTFIELD_X, OTHER};
 
-// making TextureButton virtual public, because we might construct a class that derives from both TextButton and TextureButton
-class TextureButton : virtual public Button {
+class TextureButton : public Button {
 protected:
 	std::string m_texture;					// The texture a TextureButton will contain. Passed as a fileName on initalisation.
 	const TextureButtonUseage m_useage;		// For each button's unique useage.
@@ -17,9 +16,9 @@ protected:
 
 public:
 	TextureButton(const float pos_x, const float pos_y, const float width, const float height, const std::string& fileName, const TextureButtonUseage useage);
-	virtual ~TextureButton();
+	~TextureButton();
 
-	virtual void draw() override;
+	void draw();
 
-	virtual void update() override;
+	void onEvent(const InputEvent& event);
 };
\ No newline at end of file
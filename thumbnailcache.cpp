@@ -0,0 +1,212 @@
+#include "thumbnailcache.h"
+#include "pngcodec.h"
+#include "taskscheduler.h"
+#include "global.h"
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <charconv>
+#include <system_error>
+
+namespace {
+	const std::string c_thumbnailFolder{ "thumbs" };
+	const std::string c_indexFile{ "index.txt" };
+
+	unsigned long long hashContents(const std::vector<unsigned char>& data)
+	{
+		unsigned long long hash{ 14695981039346656037ull };
+		for (const auto byte : data) {
+			hash ^= byte;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::filesystem::path thumbnailFolder()
+	{
+		return std::filesystem::path{ ASSET_PATH } / c_thumbnailFolder;
+	}
+
+	// the whole of text as a number, or false
+	template <typename Number>
+	bool parseNumber(const std::string& text, Number& number, int base = 10)
+	{
+		const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), number, base) };
+		return !text.empty() && error == std::errc{} && end == text.data() + text.size();
+	}
+}
+
+ThumbnailCache* ThumbnailCache::getInstance()
+{
+	if (!s_instance) {
+		s_instance = new ThumbnailCache();
+	}
+	return s_instance;
+}
+
+void ThumbnailCache::releaseInstance()
+{
+	if (s_instance) {
+		delete s_instance;
+	}
+	s_instance = nullptr;
+}
+
+void ThumbnailCache::nameThumbnails(ThumbnailEntry& entry)
+{
+	char hash[17];
+	std::snprintf(hash, sizeof(hash), "%016llx", entry.hash);
+	entry.thumbnail = c_thumbnailFolder + "/" + hash + "_1x.png";
+	entry.thumbnail2x = c_thumbnailFolder + "/" + hash + "_2x.png";
+}
+
+// index format: one poster per line, "filename<TAB>size<TAB>modification time<TAB>hash", hash in hex
+void ThumbnailCache::load()
+{
+	std::ifstream index{ thumbnailFolder() / c_indexFile };
+	std::string line;
+	while (std::getline(index, line)) {
+		std::stringstream tokenizer(line);
+		std::string poster;
+		std::string size;
+		std::string modified;
+		std::string hash;
+		if (!std::getline(tokenizer, poster, '\t') || !std::getline(tokenizer, size, '\t') ||
+			!std::getline(tokenizer, modified, '\t') || !std::getline(tokenizer, hash, '\t')) {
+			continue;
+		}
+
+		// a line that got cut short or mangled, or a poster that is gone, is left out (and so out of the next save())
+		ThumbnailEntry entry;
+		if (!parseNumber(size, entry.size) || !parseNumber(modified, entry.modified) || !parseNumber(hash, entry.hash, 16) ||
+			!std::filesystem::exists(std::filesystem::path{ ASSET_PATH } / poster)) {
+			continue;
+		}
+		nameThumbnails(entry);
+		m_entries[poster] = entry;
+	}
+}
+
+void ThumbnailCache::save() const
+{
+	std::ofstream index{ thumbnailFolder() / c_indexFile };
+	for (const auto& [poster, entry] : m_entries) {
+		char hash[17];
+		std::snprintf(hash, sizeof(hash), "%016llx", entry.hash);
+		index << poster << '\t' << entry.size << '\t' << entry.modified << '\t' << hash << '\n';
+	}
+}
+
+unsigned int ThumbnailCache::bake()
+{
+	namespace fs = std::filesystem;
+	fs::create_directories(thumbnailFolder());
+
+	// BakeJob: A poster whose size or modification time changed, and what became of it
+	struct BakeJob {
+		fs::path path;
+		std::string poster;
+		const ThumbnailEntry* known{ nullptr };		// what the index had for it, if anything
+		ThumbnailEntry entry;
+		bool changed{ false };						// the contents hash differently, so the entry has to be updated
+		bool baked{ false };						// and new thumbnails were written
+	};
+
+	// first check, on this thread since it only looks at the directory: same size and modification time as last time, and
+	// the thumbnails are still there
+	std::vector<BakeJob> jobs;
+	for (const auto& file : fs::directory_iterator{ ASSET_PATH }) {
+		if (!file.is_regular_file()) {
+			continue;
+		}
+		std::string extension{ file.path().extension().string() };
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (extension != ".png") {
+			continue;
+		}
+
+		BakeJob job;
+		job.path = file.path();
+		job.poster = file.path().filename().string();
+		job.entry.size = file.file_size();
+		job.entry.modified = static_cast<long long>(file.last_write_time().time_since_epoch().count());
+
+		auto iter{ m_entries.find(job.poster) };
+		if (iter != m_entries.end()) {
+			job.known = &iter->second;
+			if (job.known->size == job.entry.size && job.known->modified == job.entry.modified &&
+				fs::exists(fs::path{ ASSET_PATH } / job.known->thumbnail) && fs::exists(fs::path{ ASSET_PATH } / job.known->thumbnail2x)) {
+				continue;
+			}
+		}
+		jobs.push_back(std::move(job));
+	}
+
+	// reading, decoding and encoding the rest on the scheduler's workers, a poster at a time. m_entries is only read until they're all done.
+	TaskScheduler::getInstance()->parallelFor(0, jobs.size(), 1, [&jobs](size_t first, size_t last) {
+		for (size_t i{ first }; i < last; ++i) {
+			BakeJob& job{ jobs[i] };
+			std::ifstream stream{ job.path, std::ios::binary };
+			std::vector<unsigned char> data{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+
+			// second check: the file was touched, but its contents are the same
+			job.entry.hash = hashContents(data);
+			nameThumbnails(job.entry);
+			job.changed = true;
+			if (job.known && job.known->hash == job.entry.hash &&
+				fs::exists(fs::path{ ASSET_PATH } / job.entry.thumbnail) && fs::exists(fs::path{ ASSET_PATH } / job.entry.thumbnail2x)) {
+				continue;
+			}
+
+			Image image;
+			if (!decodePng(data, image)) {
+				job.changed = false;
+				continue;
+			}
+
+			for (const unsigned int scale : { 1u, 2u }) {
+				std::vector<unsigned char> png{ encodePng(downsampleImage(image, POSTER_WIDTH * scale, POSTER_HEIGHT * scale)) };
+				std::ofstream out{ fs::path{ ASSET_PATH } / (scale == 1 ? job.entry.thumbnail : job.entry.thumbnail2x), std::ios::binary };
+				out.write(reinterpret_cast<const char*>(png.data()), png.size());
+			}
+			job.baked = true;
+		}
+	});
+
+	unsigned int baked{ 0 };
+	for (const BakeJob& job : jobs) {
+		if (!job.changed) {
+			continue;
+		}
+
+		// the old thumbnails of a changed poster are of no use anymore
+		if (job.baked && job.known && job.known->hash != job.entry.hash) {
+			std::error_code error;
+			fs::remove(fs::path{ ASSET_PATH } / job.known->thumbnail, error);
+			fs::remove(fs::path{ ASSET_PATH } / job.known->thumbnail2x, error);
+		}
+
+		m_entries[job.poster] = job.entry;
+		if (job.baked) {
+			++baked;
+		}
+	}
+
+	save();
+	return baked;
+}
+
+const std::string& ThumbnailCache::lookup(const std::string& poster) const
+{
+	auto iter{ m_entries.find(poster) };
+	if (iter == m_entries.end()) {
+		return poster;
+	}
+	return m_hiDpi ? iter->second.thumbnail2x : iter->second.thumbnail;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "global.h"
+
+#include <string>
+#include <unordered_map>
+
+/* ThumbnailCache: Our posters are 768x1024 PNGs, but we only ever draw them at POSTER_WIDTH x POSTER_HEIGHT. Baking
+ * downsamples every PNG of the assets folder to that size (and twice that size, for HiDPI windows) and stores the results
+ * in the "thumbs" subfolder, along with an index file. Films then draw the small thumbnail instead of the full poster.
+ *
+ * Baking is incremental: the index remembers the size, modification time and content hash of every source PNG. Files
+ * whose size and modification time haven't changed are skipped without being read, files that have changed on disk but
+ * still hash the same are skipped without being decoded, and only actual changes are baked again. Thumbnails are named
+ * after the content hash, so a changed poster never reuses a stale thumbnail.
+ *
+ * Baking is meant to run offline (FilmGUI --bake-thumbnails). At startup we only read the index; any poster missing
+ * from it is simply drawn full-size. */
+
+class ThumbnailCache {
+private:
+	struct ThumbnailEntry {
+		unsigned long long size{ 0 };		// size of the source PNG in bytes
+		long long modified{ 0 };			// modification time of the source PNG
+		unsigned long long hash{ 0 };		// FNV-1a hash of the contents of the source PNG
+		std::string thumbnail;				// the 1x thumbnail, relative to ASSET_PATH
+		std::string thumbnail2x;			// the 2x thumbnail, relative to ASSET_PATH
+	};
+
+	static inline ThumbnailCache* s_instance{ nullptr };
+
+	// m_entries: source PNG filename (relative to ASSET_PATH) to its baked thumbnails
+	std::unordered_map<std::string, ThumbnailEntry> m_entries;
+
+	// m_hiDpi: whether lookup() returns the 2x thumbnails
+	bool m_hiDpi{ false };
+
+	// fills in the thumbnail paths of an entry from its hash
+	static void nameThumbnails(ThumbnailEntry& entry);
+
+	// writes the index file out from m_entries
+	void save() const;
+
+	ThumbnailCache() = default;
+
+public:
+	static ThumbnailCache* getInstance();
+	static void releaseInstance();
+
+	// Reads the index file, if there is one. Called on startup.
+	void load();
+
+	// Bakes every PNG in ASSET_PATH that is new or has changed since the last bake. Returns how many were baked.
+	unsigned int bake();
+
+	// Returns the thumbnail to draw in place of a poster, or the poster itself if it hasn't been baked
+	const std::string& lookup(const std::string& poster) const;
+
+	void setHiDpi(bool hiDpi)								{ m_hiDpi = hiDpi; }
+};
@@ -1,7 +1,9 @@
 #pragma once
 #include "global.h"
 #include "graphics.h"
+#include "renderqueue.h"
 #include <string_view>
+#include <cmath>
 
 /* util.h: Contains multiple helper functions. */
 
@@ -12,8 +14,8 @@
 inline float canvasWidthOffset(float f) { return CANVAS_WIDTH * f; }
 inline float canvasHeightOffset(float f) { return CANVAS_HEIGHT * f; }
 
-// to set the font
-inline void setFont(std::string_view font) { graphics::setFont(ASSET_PATH + static_cast<std::string>(font)); }
+// to set the font. Goes through the RenderQueue, which only switches SGG's font when a text command actually needs it
+inline void setFont(std::string_view font) { RenderQueue::getInstance()->setFont(ASSET_PATH + static_cast<std::string>(font)); }
 
 // to set the texture of a brush
 inline void setTexture(graphics::Brush& brush, const std::string& fileName) { brush.texture = static_cast<std::string>(ASSET_PATH) + fileName; }
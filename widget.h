@@ -2,13 +2,18 @@
 #include "global.h"
 #include "util.h"
 #include "film.h"
+#include "inputmanager.h"
 #include "graphics.h"
 
 #include <unordered_set>
 
-/* Widget: The parent class of all widgets in our film browser. Even though all the widgets in our project are rectangular so far,
+/* Widget: The state every widget in our film browser has in common. Even though all the widgets in our project are rectangular so far,
  * for futureproof reasons we will not be including width and height here because we might make a non-rectangular widget at some
- * point in the future. */
+ * point in the future.
+ *
+ * Widgets are plain values without any virtual functions: the WidgetSystem keeps every type of widget in an array of its own
+ * and calls each type's draw/update/contains/onEvent/addToPlan directly, in one loop per type. A new type of widget gets an
+ * array (and a loop) of its own there, rather than overriding anything here. */
 
 class Widget {
 protected:
@@ -41,9 +46,6 @@ public:
 		m_clicked { false }
 	{}
 
-	// virtual destructor, in case any child classes have dynamically allocated memory that they will need to free up.
-	virtual ~Widget()												{}
-
 	// Set/Get PosX/PosY: Standard getters/setters.
 
 	float getPosX() const									{ return m_pos_x; }
@@ -51,30 +53,20 @@ public:
 	void setPosX(float pos_x)								{ m_pos_x = pos_x; }
 	void setPosY(float pos_y)								{ m_pos_y = pos_y; }
 
-	// for contains: args mouse_x, mouse_y; to check if our mouse is hovering over the widget.
-	// Each widget will have their own implementation, based on whether it is rectangular, circular or anything else.
-	virtual bool contains(const float x, const float y) const = 0;	
-	
-	/* canFilter: Used to check if a widget (in its current state) can filter films. Used when applying filters, to see
-	 * which widgets should be taken into consideration for filtering. Returns false by default, the widgets that should
-	 * be allowed to filter have their own implementations, overriding this one. */
-	virtual bool canFilter() const							{ return false; }
-
-	/* Called when filtering the films, parameter is the unordered_set of films to be filtered. If the widget is currently 
-	 * filtering (canFilter()==true), it erases all films that do not fit its criteria from the unordered_set parameter. */
-	virtual void filter(std::unordered_set<class Film*>& currFilms) const { if (!canFilter()) return; }
-
 	// Returns whether a widget has been clicked on.
 	bool isClicked() const { return m_clicked; }
+
+	/* Input: the WidgetSystem hit-tests the widgets of the current screen and tells the one under the mouse through
+	 * setHighlighted(). Mouse events are then only handed to that widget (or, while the button is held, the widget it went
+	 * down on), and keyboard events only to the focused textfield, through the onEvent() of their type. */
+	void setHighlighted(bool highlighted)					{ m_highlighted = highlighted; }
 	
 	/* Resets the state of the widget to the original state. Specifically, if the widget has been clicked it resets its
-	 * clicked state to false, and if it has been moved, it resets its coordinates to its original coordinates. */
-	virtual void resetState() {
+	 * clicked state to false, and if it has been moved, it resets its coordinates to its original coordinates. Types with
+	 * more state (e.g. TextField) have a resetState() of their own, which calls this one. */
+	void resetState() {
 		m_clicked = false;
 		if (m_pos_x != m_init_pos_x) m_pos_x = m_init_pos_x;
 		if (m_pos_y != m_init_pos_y) m_pos_y = m_init_pos_y;
 	}
-
-	virtual void draw() = 0;
-	virtual void update() = 0;
-};
\ No newline at end of file
+};
@@ -0,0 +1,410 @@
+#include "widgetsystem.h"
+#include "profiler.h"
+#include "filmutil.h"
+#include "global.h"
+#include "util.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+	bool toFloat(const std::string& token, float& value)
+	{
+		char* end{ nullptr };
+		value = std::strtof(token.c_str(), &end);
+		return !token.empty() && *end == '\0';
+	}
+
+	bool toTextfieldUseage(const std::string& token, TextfieldUseage& useage)
+	{
+		if (token == "general")			useage = TextfieldUseage::GENERAL;
+		else if (token == "actor")		useage = TextfieldUseage::ACTOR;
+		else if (token == "director")	useage = TextfieldUseage::DIRECTOR;
+		else if (token == "title")		useage = TextfieldUseage::TITLE;
+		else return false;
+		return true;
+	}
+
+	bool toTextButtonUseage(const std::string& token, TextButtonUseage& useage)
+	{
+		if (token == "advanced_search")		useage = TextButtonUseage::ADVANCED_SEARCH;
+		else if (token == "apply_filters")	useage = TextButtonUseage::APPLY_FILTERS;
+		else if (token == "clear_filters")	useage = TextButtonUseage::CLEAR_FILTERS;
+		else if (token == "other")			useage = TextButtonUseage::OTHER;
+		else return false;
+		return true;
+	}
+}
+
+bool WidgetSystem::load(const std::string& path, unsigned int minYear, unsigned int maxYear)
+{
+	std::ifstream file{ path };
+	if (!file) {
+		std::cerr << "WidgetSystem: could not open the layout file " << path << '\n';
+		return false;
+	}
+
+	bool ok{ true };
+	std::string line;
+	for (unsigned int lineNumber{ 1 }; std::getline(file, line); ++lineNumber) {
+		std::vector<std::string> tokens{ tokenize(line) };
+		if (tokens.empty()) {
+			continue;
+		}
+
+		// every line starts with "<type> <name> <screens> <x> <y>", x and y being fractions of the canvas width/height
+		const std::string& type{ tokens[0] };
+		float x{ 0.0f };
+		float y{ 0.0f };
+		bool valid{ tokens.size() >= 5 && toFloat(tokens[3], x) && toFloat(tokens[4], y) };
+		x = canvasWidthOffset(x);
+		y = canvasHeightOffset(y);
+
+		// followed by "<width> <height>" for everything but the genre buttons
+		float width{ 0.0f };
+		float height{ 0.0f };
+		if (valid && type != "genrebuttons") {
+			valid = tokens.size() >= 7 && toFloat(tokens[5], width) && toFloat(tokens[6], height);
+		}
+
+		if (valid && type == "textfield" && tokens.size() == 8) {
+			// textfield <name> <screens> <x> <y> <width> <height> <general|actor|director|title>
+			TextfieldUseage useage;
+			if ((valid = toTextfieldUseage(tokens[7], useage))) {
+				m_textFields.emplace_back(x, y, width, height, useage);
+				valid = addWidget(tokens[1], { WidgetType::TEXTFIELD, static_cast<unsigned int>(m_textFields.size() - 1) }, tokens[2]);
+			}
+		}
+		else if (valid && type == "textbutton" && tokens.size() == 9) {
+			// textbutton <name> <screens> <x> <y> <width> <height> <useage> "<text>"
+			TextButtonUseage useage;
+			if ((valid = toTextButtonUseage(tokens[7], useage))) {
+				m_textButtons.emplace_back(x, y, width, height, tokens[8], useage);
+				valid = addWidget(tokens[1], { WidgetType::TEXT_BUTTON, static_cast<unsigned int>(m_textButtons.size() - 1) }, tokens[2]);
+			}
+		}
+		else if (valid && type == "texturebutton" && tokens.size() == 8) {
+			// texturebutton <name> <screens> <x> <y> <width> <height> <texture>
+			m_textureButtons.emplace_back(x, y, width, height, tokens[7], TextureButtonUseage::DEFAULT);
+			valid = addWidget(tokens[1], { WidgetType::TEXTURE_BUTTON, static_cast<unsigned int>(m_textureButtons.size() - 1) }, tokens[2]);
+		}
+		else if (valid && type == "slider" && tokens.size() == 8 && (tokens[7] == "lower" || tokens[7] == "upper")) {
+			// slider <name> <screens> <x> <y> <width> <height> <lower|upper>
+			m_sliders.emplace_back(x, y, width, height, minYear, maxYear, tokens[7] == "lower" ? SliderUseage::LOWER_BOUND : SliderUseage::UPPER_BOUND);
+			valid = addWidget(tokens[1], { WidgetType::SLIDER, static_cast<unsigned int>(m_sliders.size() - 1) }, tokens[2]);
+		}
+		else if (valid && type == "genrebuttons" && tokens.size() == 8) {
+			/* genrebuttons <name> <screens> <x> <y> <right edge> <height> <row step>: one button per genre, named
+			 * "<name>.<genre>", flowing left to right from x and wrapping onto the next row (row step lower, as a fraction
+			 * of the canvas height) before they'd go past the right edge (a fraction of the canvas width) */
+			float limit{ 0.0f };
+			float rowStep{ 0.0f };
+			valid = toFloat(tokens[5], limit) && toFloat(tokens[6], height) && toFloat(tokens[7], rowStep);
+
+			// previousUpperBound: the previous GenreButton's rightmost x coordinate
+			float previousUpperBound{ x };
+			for (const auto genre : genresToArray()) {
+				if (!valid) {
+					break;
+				}
+
+				// if drawing the GenreButton would take us over the right edge, moving on to the next row
+				float currentWidth{ GenreButton::calculateWidth(genre) };
+				if (previousUpperBound + currentWidth >= canvasWidthOffset(limit)) {
+					previousUpperBound = x;
+					y += canvasHeightOffset(rowStep);
+				}
+				m_genreButtons.emplace_back(previousUpperBound + 10.0f + currentWidth * 0.5f, y, height, genre);
+				const GenreButton& genreButton{ m_genreButtons.back() };
+				previousUpperBound = genreButton.getPosX() + genreButton.getWidth() / 2.0f;
+				valid = addWidget(tokens[1] + "." + genreName(genre), { WidgetType::GENRE_BUTTON, static_cast<unsigned int>(m_genreButtons.size() - 1) }, tokens[2]);
+			}
+		}
+		else {
+			valid = false;
+		}
+
+		if (!valid) {
+			std::cerr << "WidgetSystem: " << path << ':' << lineNumber << ": could not read \"" << line << "\"\n";
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+bool WidgetSystem::addWidget(const std::string& name, WidgetId id, const std::string& screens)
+{
+	if (!m_ids.emplace(name, id).second) {
+		return false;
+	}
+
+	std::stringstream tokenizer(screens);
+	std::string screen;
+	while (std::getline(tokenizer, screen, ',')) {
+		ScreenWidgets& widgets{ m_screens[screenIndex(screen)] };
+		switch (id.type) {
+		case WidgetType::TEXT_BUTTON:		widgets.textButtons.push_back(id.index); break;
+		case WidgetType::TEXTURE_BUTTON:	widgets.textureButtons.push_back(id.index); break;
+		case WidgetType::GENRE_BUTTON:		widgets.genreButtons.push_back(id.index); break;
+		case WidgetType::SLIDER:			widgets.sliders.push_back(id.index); break;
+		case WidgetType::TEXTFIELD:			widgets.textFields.push_back(id.index); break;
+		default:							break;
+		}
+	}
+	return true;
+}
+
+unsigned int WidgetSystem::screenIndex(const std::string& name)
+{
+	auto iter{ m_screenIds.find(name) };
+	if (iter != m_screenIds.end()) {
+		return iter->second;
+	}
+	m_screens.emplace_back();
+	return m_screenIds[name] = static_cast<unsigned int>(m_screens.size() - 1);
+}
+
+WidgetId WidgetSystem::find(const std::string& name) const
+{
+	auto iter{ m_ids.find(name) };
+	if (iter == m_ids.end()) {
+		std::cerr << "WidgetSystem: there is no widget called " << name << " in the layout\n";
+		return c_noWidget;
+	}
+	return iter->second;
+}
+
+// screens nobody put a widget on are all the same empty screen
+unsigned int WidgetSystem::findScreen(const std::string& name) const
+{
+	auto iter{ m_screenIds.find(name) };
+	return iter == m_screenIds.end() ? static_cast<unsigned int>(m_screens.size()) : iter->second;
+}
+
+void WidgetSystem::setScreen(unsigned int screen)
+{
+	clearInputTargets();
+	m_screen = screen;
+}
+
+Widget& WidgetSystem::widget(WidgetId id)
+{
+	return const_cast<Widget&>(static_cast<const WidgetSystem*>(this)->widget(id));
+}
+
+const Widget& WidgetSystem::widget(WidgetId id) const
+{
+	switch (id.type) {
+	case WidgetType::TEXT_BUTTON:		return m_textButtons[id.index];
+	case WidgetType::TEXTURE_BUTTON:	return m_textureButtons[id.index];
+	case WidgetType::GENRE_BUTTON:		return m_genreButtons[id.index];
+	case WidgetType::SLIDER:			return m_sliders[id.index];
+	default:							return m_textFields[id.index];
+	}
+}
+
+void WidgetSystem::sendEvent(WidgetId id, const InputEvent& event)
+{
+	switch (id.type) {
+	case WidgetType::TEXT_BUTTON:		m_textButtons[id.index].onEvent(event); break;
+	case WidgetType::TEXTURE_BUTTON:	m_textureButtons[id.index].onEvent(event); break;
+	case WidgetType::GENRE_BUTTON:		m_genreButtons[id.index].onEvent(event); break;
+	case WidgetType::SLIDER:			m_sliders[id.index].onEvent(event); break;
+	case WidgetType::TEXTFIELD:			m_textFields[id.index].onEvent(event); break;
+	default:							break;
+	}
+}
+
+WidgetId WidgetSystem::hitTest(float x, float y) const
+{
+	if (m_screen >= m_screens.size()) {
+		return c_noWidget;
+	}
+	const ScreenWidgets& screen{ m_screens[m_screen] };
+
+	for (const auto index : screen.textButtons) {
+		if (m_textButtons[index].contains(x, y)) return { WidgetType::TEXT_BUTTON, index };
+	}
+	for (const auto index : screen.textureButtons) {
+		if (m_textureButtons[index].contains(x, y)) return { WidgetType::TEXTURE_BUTTON, index };
+	}
+	for (const auto index : screen.genreButtons) {
+		if (m_genreButtons[index].contains(x, y)) return { WidgetType::GENRE_BUTTON, index };
+	}
+	for (const auto index : screen.sliders) {
+		if (m_sliders[index].contains(x, y)) return { WidgetType::SLIDER, index };
+	}
+	for (const auto index : screen.textFields) {
+		if (m_textFields[index].contains(x, y)) return { WidgetType::TEXTFIELD, index };
+	}
+	return c_noWidget;
+}
+
+void WidgetSystem::dispatchInput()
+{
+	PROFILE_SCOPE("WidgetSystem::dispatchInput");
+	const InputSnapshot& input{ InputManager::getInstance()->getSnapshot() };
+
+	// only the widget that was highlighted and the one that is now have to hear about it, however many widgets there are
+	WidgetId hovered{ hitTest(input.mouseX, input.mouseY) };
+	if (hovered != m_hovered) {
+		if (m_hovered.isValid()) {
+			widget(m_hovered).setHighlighted(false);
+		}
+		if (hovered.isValid()) {
+			widget(hovered).setHighlighted(true);
+		}
+		m_hovered = hovered;
+	}
+
+	for (const auto& event : InputManager::getInstance()->getEvents()) {
+		switch (event.type) {
+		case InputEventType::CLICK:
+			// clicking moves the focus: onto the clicked widget if it is a textfield, off the focused one otherwise
+			m_captured = m_hovered;
+			if (m_focused.isValid() && m_focused != m_hovered) {
+				m_textFields[m_focused.index].setFocused(false);
+			}
+			m_focused = m_hovered.type == WidgetType::TEXTFIELD ? m_hovered : c_noWidget;
+			if (m_focused.isValid()) {
+				m_textFields[m_focused.index].setFocused(true);
+			}
+			sendEvent(m_hovered, event);
+
+			// the textfield may have dropped the focus itself on that click (through its x button)
+			if (m_focused.isValid() && !m_textFields[m_focused.index].hasFocus()) {
+				m_focused = c_noWidget;
+			}
+			break;
+
+		case InputEventType::DRAG:
+			sendEvent(m_captured, event);
+			break;
+
+		case InputEventType::RELEASE:
+			sendEvent(m_captured, event);
+			m_captured = c_noWidget;
+			break;
+
+		default:
+			// key and text events
+			sendEvent(m_focused, event);
+			break;
+		}
+	}
+}
+
+void WidgetSystem::clearInputTargets()
+{
+	if (m_focused.isValid()) {
+		m_textFields[m_focused.index].setFocused(false);
+	}
+	if (m_hovered.isValid()) {
+		widget(m_hovered).setHighlighted(false);
+	}
+	m_hovered = c_noWidget;
+	m_captured = c_noWidget;
+	m_focused = c_noWidget;
+}
+
+// textfields are the only widgets with anything to do per frame
+void WidgetSystem::update()
+{
+	PROFILE_SCOPE("WidgetSystem::update");
+	if (m_screen >= m_screens.size()) {
+		return;
+	}
+	for (const auto index : m_screens[m_screen].textFields) {
+		m_textFields[index].update();
+	}
+}
+
+void WidgetSystem::draw()
+{
+	PROFILE_SCOPE("WidgetSystem::draw");
+	if (m_screen >= m_screens.size()) {
+		return;
+	}
+	const ScreenWidgets& screen{ m_screens[m_screen] };
+
+	for (const auto index : screen.sliders) {
+		m_sliders[index].draw();
+	}
+	for (const auto index : screen.genreButtons) {
+		m_genreButtons[index].draw();
+	}
+	for (const auto index : screen.textButtons) {
+		m_textButtons[index].draw();
+	}
+	for (const auto index : screen.textureButtons) {
+		m_textureButtons[index].draw();
+	}
+	for (const auto index : screen.textFields) {
+		m_textFields[index].draw();
+	}
+}
+
+bool WidgetSystem::isClicked(WidgetId id) const
+{
+	return id.isValid() && widget(id).isClicked();
+}
+
+void WidgetSystem::resetState(WidgetId id)
+{
+	if (id.type == WidgetType::TEXTFIELD) {
+		m_textFields[id.index].resetState();
+	}
+	else if (id.isValid()) {
+		widget(id).resetState();
+	}
+}
+
+void WidgetSystem::resetScreen()
+{
+	if (m_screen >= m_screens.size()) {
+		return;
+	}
+	const ScreenWidgets& screen{ m_screens[m_screen] };
+
+	for (const auto index : screen.textButtons) {
+		m_textButtons[index].resetState();
+	}
+	for (const auto index : screen.textureButtons) {
+		m_textureButtons[index].resetState();
+	}
+	for (const auto index : screen.genreButtons) {
+		m_genreButtons[index].resetState();
+	}
+	for (const auto index : screen.sliders) {
+		m_sliders[index].resetState();
+	}
+	for (const auto index : screen.textFields) {
+		m_textFields[index].resetState();
+	}
+}
+
+TextField* WidgetSystem::getTextField(WidgetId id)
+{
+	return id.type == WidgetType::TEXTFIELD ? &m_textFields[id.index] : nullptr;
+}
+
+void WidgetSystem::addToPlan(FilterPlan& plan) const
+{
+	if (m_screen >= m_screens.size()) {
+		return;
+	}
+	const ScreenWidgets& screen{ m_screens[m_screen] };
+
+	for (const auto index : screen.genreButtons) {
+		m_genreButtons[index].addToPlan(plan);
+	}
+	for (const auto index : screen.sliders) {
+		m_sliders[index].addToPlan(plan);
+	}
+	for (const auto index : screen.textFields) {
+		m_textFields[index].addToPlan(plan);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "widget.h"
+#include "textbutton.h"
+#include "texturebutton.h"
+#include "genrebutton.h"
+#include "slider.h"
+#include "textfield.h"
+#include "inputmanager.h"
+#include "filmcatalog.h"
+#include "filmbitmap.h"
+#include "filterplan.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/* WidgetSystem: Owns every widget of our browser. The widgets are described in a layout file (LAYOUT_FILE in the assets
+ * folder), which is read once on startup: every line adds a widget with a name, a position and the screens it belongs to.
+ * Each type of widget is kept by value in an array of its own, so updating, drawing, hit-testing or filtering a screen is
+ * one plain loop per type over contiguous memory, with no virtual calls and no pointer chasing.
+ *
+ * FilmUI never indexes into the arrays itself: it looks the widgets (and screens) it cares about up by name once, and
+ * from then on refers to them through their WidgetId. Adding a widget to a screen is then just a line in the layout file.
+ *
+ * The layout format is documented at the top of the layout file itself. */
+
+// WidgetType: Which of the arrays a widget lives in
+enum class WidgetType : unsigned char { NONE, TEXT_BUTTON, TEXTURE_BUTTON, GENRE_BUTTON, SLIDER, TEXTFIELD };
+
+// WidgetId: A handle to a widget: its type, and its index in the array of that type
+struct WidgetId {
+	WidgetType type{ WidgetType::NONE };
+	unsigned int index{ 0 };
+
+	bool isValid() const									{ return type != WidgetType::NONE; }
+	bool operator==(const WidgetId& other) const			{ return type == other.type && index == other.index; }
+	bool operator!=(const WidgetId& other) const			{ return !(*this == other); }
+};
+
+// returned by find() for names that aren't in the layout. Every function taking a WidgetId quietly ignores it.
+inline constexpr WidgetId c_noWidget{};
+
+class WidgetSystem {
+private:
+	// ScreenWidgets: The widgets of a screen, as indices into each type's array
+	struct ScreenWidgets {
+		std::vector<unsigned int> textButtons;
+		std::vector<unsigned int> textureButtons;
+		std::vector<unsigned int> genreButtons;
+		std::vector<unsigned int> sliders;
+		std::vector<unsigned int> textFields;
+	};
+
+	std::vector<TextButton> m_textButtons;
+	std::vector<TextureButton> m_textureButtons;
+	std::vector<GenreButton> m_genreButtons;
+	std::vector<Slider> m_sliders;
+	std::vector<TextField> m_textFields;
+
+	std::unordered_map<std::string, WidgetId> m_ids;
+	std::unordered_map<std::string, unsigned int> m_screenIds;
+	std::vector<ScreenWidgets> m_screens;
+	unsigned int m_screen{ 0 };
+
+	/* Input routing: m_hovered is the widget under the mouse this frame, m_captured the one the left button went down on
+	 * (it keeps getting the mouse events until the button is released, so a slider can be dragged past its own bounds)
+	 * and m_focused the textfield that gets the keyboard events. All of them are on the current screen. */
+	WidgetId m_hovered;
+	WidgetId m_captured;
+	WidgetId m_focused;
+
+	// the base of any widget, for the state every type has in common
+	Widget& widget(WidgetId id);
+	const Widget& widget(WidgetId id) const;
+
+	// hands an event to a widget, through the onEvent() of its type
+	void sendEvent(WidgetId id, const InputEvent& event);
+
+	// the widget of the current screen under a point, or c_noWidget
+	WidgetId hitTest(float x, float y) const;
+
+	// adds a widget to the name lookup and to the screens in a comma separated list; returns false if the name is taken
+	bool addWidget(const std::string& name, WidgetId id, const std::string& screens);
+
+	// the index of a screen, which is created if this is the first time we've seen it
+	unsigned int screenIndex(const std::string& name);
+
+	// forgets the hovered/captured/focused widgets
+	void clearInputTargets();
+
+public:
+	// Reads the layout file and creates every widget in it. Returns false (having written what went wrong to std::cerr) if
+	// the file is missing or has lines it couldn't make sense of; the lines it could read are still used.
+	bool load(const std::string& path, unsigned int minYear, unsigned int maxYear);
+
+	// Looks a widget/screen up by the name the layout gave it. Meant to be called once, on startup.
+	WidgetId find(const std::string& name) const;
+	unsigned int findScreen(const std::string& name) const;
+
+	// Switches to another screen. The widgets keep their state; call resetScreen() first to clear it.
+	void setScreen(unsigned int screen);
+
+	// Hit-tests the widgets of the current screen once, then hands every event of this frame to the one widget it is meant for
+	void dispatchInput();
+
+	void update();
+	void draw();
+
+	bool isClicked(WidgetId id) const;
+	void resetState(WidgetId id);
+
+	// resets the state of every widget on the current screen
+	void resetScreen();
+
+	TextField* getTextField(WidgetId id);
+
+	// gathers what every widget of the current screen filters on into one FilterPlan, to be searched as a whole
+	void addToPlan(FilterPlan& plan) const;
+};